@@ -0,0 +1,207 @@
+#ifndef _AGGREGATE_TREE_H_
+#define _AGGREGATE_TREE_H_
+
+#include "../def_global.h"
+
+
+
+// Count and XOR of the ids per slot, e.g., per buffer of a LIVE INDEX or per partition of a HINT level, kept up to
+// date on every insert and remove, with a Fenwick tree over the slots. Queries that report a run of slots as a whole
+// take its COUNT and XOR from two prefixes of the tree in O(log n), instead of scanning the entries. A slot has a
+// zero count exactly when it is empty; the aggregates of a merged buffer are moved along with its entries by
+// transfer(). Slots are evicted from the front by evict(), after which insert, getCount and getXor keep taking
+// absolute slot ids, while the rest take positions among the stored slots.
+class AggregateTree
+{
+private:
+    vector<size_t>   counts;
+    vector<RecordId> xors;
+    vector<size_t>   treeCounts;        // Node k (1-based) covers slots (k-lowbit(k), k]
+    vector<RecordId> treeXors;
+    size_t firstSlot;                   // Of the stored slots
+    size_t firstLive;                   // Of the slots not evicted; the ones in between are emptied
+
+    // Unsigned counts wrap around, so a removal adds -1
+    void update(size_t b, size_t count, RecordId x)
+    {
+        for (auto k = b+1; k <= this->counts.size(); k += k & (~k+1))
+        {
+            this->treeCounts[k-1] += count;
+            this->treeXors[k-1] ^= x;
+        }
+    };
+
+
+    void rebuild()
+    {
+        size_t numSlots = this->counts.size();
+
+        this->treeCounts = this->counts;
+        this->treeXors = this->xors;
+        for (auto k = 1; k <= numSlots; k++)
+        {
+            size_t parent = k + (k & (~k+1));
+
+            if (parent <= numSlots)
+            {
+                this->treeCounts[parent-1] += this->treeCounts[k-1];
+                this->treeXors[parent-1] ^= this->treeXors[k-1];
+            }
+        }
+    };
+
+public:
+    AggregateTree()
+    {
+        this->firstSlot = this->firstLive = 0;
+    };
+
+
+    // Adds an empty slot at the end; its node sums up the nodes of its children, all before it
+    void append()
+    {
+        size_t k = this->counts.size()+1, count = 0;
+        RecordId x = 0;
+
+        for (size_t c = 1; c < (k & (~k+1)); c <<= 1)
+        {
+            count += this->treeCounts[k-c-1];
+            x ^= this->treeXors[k-c-1];
+        }
+        this->counts.push_back(0);
+        this->xors.push_back(0);
+        this->treeCounts.push_back(count);
+        this->treeXors.push_back(x);
+    };
+
+
+    // Slots up to b are added if missing, for callers that add them lazily; evicted slots stay empty
+    void insert(size_t b, RecordId id)
+    {
+        if (b < this->firstLive)
+            return;
+        b -= this->firstSlot;
+        while (b >= this->counts.size())
+            this->append();
+
+        this->counts[b]++;
+        this->xors[b] ^= id;
+        this->update(b, 1, id);
+    };
+
+
+    void remove(size_t b, RecordId id)
+    {
+        this->counts[b]--;
+        this->xors[b] ^= id;
+        this->update(b, -1, id);
+    };
+
+
+    // The entries of slot from moved into slot to
+    void transfer(size_t from, size_t to)
+    {
+        size_t count = this->counts[from];
+        RecordId x = this->xors[from];
+
+        this->counts[to] += count;
+        this->xors[to] ^= x;
+        this->counts[from] = 0;
+        this->xors[from] = 0;
+        this->update(to, count, x);
+        this->update(from, -count, x);
+    };
+
+
+    // Slots [from, to) were dropped, after their entries were removed or transferred
+    void erase(size_t from, size_t to)
+    {
+        this->counts.erase(this->counts.begin()+from, this->counts.begin()+to);
+        this->xors.erase(this->xors.begin()+from, this->xors.begin()+to);
+        this->rebuild();
+    };
+
+
+    // Mirrors the sweep of a LIVE INDEX, which drops the empty buffers except for the last one
+    void sweep()
+    {
+        size_t numSlots = this->counts.size(), b = 0;
+
+        for (auto i = 0; i < numSlots; i++)
+        {
+            if ((this->counts[i] == 0) && (i != numSlots-1))
+                continue;
+
+            this->counts[b] = this->counts[i];
+            this->xors[b] = this->xors[i];
+            b++;
+        }
+        this->counts.resize(b);
+        this->xors.resize(b);
+        this->rebuild();
+    };
+
+
+    // Empties the slots before upTo; they are dropped in bulk, once they make up half of the slots stored
+    void evict(size_t upTo)
+    {
+        if (upTo <= this->firstLive)
+            return;
+
+        size_t k = min(upTo-this->firstSlot, this->counts.size());
+
+        for (auto b = this->firstLive-this->firstSlot; b < k; b++)
+        {
+            this->update(b, -this->counts[b], this->xors[b]);
+            this->counts[b] = 0;
+            this->xors[b] = 0;
+        }
+        this->firstLive = upTo;
+
+        if (2*k >= this->counts.size())
+        {
+            this->erase(0, k);
+            this->firstSlot += k;
+        }
+    };
+
+
+    size_t getSize()
+    {
+        return this->counts.size();
+    };
+
+
+    // Of the first numSlots slots; missing and evicted slots are empty
+    size_t getCount(size_t numSlots)
+    {
+        size_t count = 0;
+
+        if (numSlots <= this->firstSlot)
+            return 0;
+        for (auto k = min(numSlots-this->firstSlot, this->counts.size()); k > 0; k -= k & (~k+1))
+            count += this->treeCounts[k-1];
+
+        return count;
+    };
+
+
+    RecordId getXor(size_t numSlots)
+    {
+        RecordId x = 0;
+
+        if (numSlots <= this->firstSlot)
+            return 0;
+        for (auto k = min(numSlots-this->firstSlot, this->counts.size()); k > 0; k -= k & (~k+1))
+            x ^= this->treeXors[k-1];
+
+        return x;
+    };
+
+
+    size_t getMemoryUsage()
+    {
+        return (this->counts.capacity()+this->treeCounts.capacity())*sizeof(size_t) + (this->xors.capacity()+this->treeXors.capacity())*sizeof(RecordId);
+    };
+};
+#endif // _AGGREGATE_TREE_H_
@@ -1,4 +1,5 @@
 #include "buffer.h"
+#include "scan_kernels.h"
 
 
 
@@ -53,6 +54,13 @@ size_t Buffer_Map::getSize()
 }
 
 
+// Approximation: red-black tree node with three links and a color per entry
+size_t Buffer_Map::getMemoryUsage()
+{
+    return this->entries.size()*(sizeof(pair<const RecordId, Timestamp>)+4*sizeof(void*));
+}
+
+
 void Buffer_Map::print(char c)
 {
     cout << "{";
@@ -67,7 +75,27 @@ void Buffer_Map::print(char c)
 // Querying
 size_t Buffer_Map::execute_gOverlaps(RangeQuery Q)
 {
-    size_t result = 0;
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(Q, sink);
+
+    return sink.getResult();
+}
+
+
+size_t Buffer_Map::execute_gOverlaps()
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(sink);
+
+    return sink.getResult();
+}
+
+
+template <class S>
+void Buffer_Map::execute_gOverlaps(RangeQuery Q, S &sink)
+{
     map<RecordId, Timestamp>::iterator iter, iterEnd = this->entries.end();
 
     for (iter = this->entries.begin(); iter != iterEnd; iter++)
@@ -75,22 +103,18 @@ size_t Buffer_Map::execute_gOverlaps(RangeQuery Q)
         if (iter->second > Q.end)
             break;
 
-        result ^= iter->first;
+        sink.add(iter->first);
     }
-
-    return result;
 }
 
 
-size_t Buffer_Map::execute_gOverlaps()
+template <class S>
+void Buffer_Map::execute_gOverlaps(S &sink)
 {
-    size_t result = 0;
     map<RecordId, Timestamp>::iterator iter, iterEnd = this->entries.end();
     
     for (iter = this->entries.begin(); iter != iterEnd; iter++)
-        result ^= iter->first;
-    
-    return result;
+        sink.add(iter->first);
 }
 
 
@@ -99,56 +123,123 @@ size_t Buffer_Map::execute_gOverlaps()
 Buffer_Vector::Buffer_Vector()
 {
     this->minRecordId = std::numeric_limits<Timestamp>::max();
+    this->numEntries = 0;
 }
 
 
 Buffer_Vector::Buffer_Vector(size_t capacity) : Buffer(capacity)
 {
     this->entries.reserve(this->capacity);
+    this->live.reserve((this->capacity+63)/64);
     this->minRecordId = std::numeric_limits<Timestamp>::max();
+    this->numEntries = 0;
+}
+
+
+inline bool Buffer_Vector::isLive(size_t slot)
+{
+    return (this->live[slot/64] >> (slot%64)) & 1;
+}
+
+
+inline size_t Buffer_Vector::getSlot(RecordId id)
+{
+    return id-this->minRecordId;
 }
 
 
 void Buffer_Vector::insert(RecordId id, Timestamp start)
 {
+    size_t slot;
+
+
+    if (this->entries.empty())
+        this->minRecordId = id;
+    slot = this->getSlot(id);
+
+    // Ids skipped become removed slots, taking the previous start to keep the starts sorted
+    if (slot > this->entries.size())
+        this->entries.resize(slot, this->entries.back());
     this->entries.push_back(start);
-    this->minRecordId = min(this->minRecordId, id);
+    this->live.resize((this->entries.size()+63)/64, 0);
+    this->live[slot/64] |= (uint64_t)1 << (slot%64);
+    this->numEntries++;
+}
+
+
+void Buffer_Vector::insert_secAttr(RecordId id, Timestamp start, int secAttr)
+{
+    this->insert(id, start);
+    this->secAttrs.resize(this->entries.size(), 0);
+    this->secAttrs.back() = secAttr;
 }
 
 
+// B holds the ids that follow; its live bitmap is shifted into place a word at a time
 void Buffer_Vector::insert(Buffer_Vector &B)
 {
-    auto csize = this->entries.size();
-    auto bsize = B.entries.size();
+    size_t offset, shift;
 
-    this->entries.resize(csize+bsize);
-    for (auto i = 0; i < bsize; i++)
-        this->entries[i+csize] = B.entries[i];
+
+    if (B.entries.empty())
+        return;
+
+    if (this->entries.empty())
+        this->minRecordId = B.minRecordId;
+    offset = this->getSlot(B.minRecordId);
+    shift  = offset%64;
+
+    if (offset > this->entries.size())
+        this->entries.resize(offset, (this->entries.empty())? B.entries[0]: this->entries.back());
+    this->entries.insert(this->entries.end(), B.entries.begin(), B.entries.end());
+    this->live.resize((this->entries.size()+63)/64, 0);
+    for (auto w = 0; w < B.live.size(); w++)
+    {
+        this->live[offset/64+w] |= B.live[w] << shift;
+        if ((shift > 0) && (B.live[w] >> (64-shift)))
+            this->live[offset/64+w+1] |= B.live[w] >> (64-shift);
+    }
+    this->numEntries += B.numEntries;
+}
+
+
+void Buffer_Vector::insert_secAttr(Buffer_Vector &B)
+{
+    size_t offset = (this->entries.empty())? 0: this->getSlot(B.minRecordId);
+
+    this->insert(B);
+    this->secAttrs.resize(offset, 0);
+    this->secAttrs.insert(this->secAttrs.end(), B.secAttrs.begin(), B.secAttrs.end());
+    this->secAttrs.resize(this->entries.size(), 0);
 }
 
 
 Timestamp Buffer_Vector::remove(RecordId id)
 {
-//    cout << "id = " << id << "\tminRecordId = " << this->minRecordId << endl;
-    RecordId fixed_id = id - this->minRecordId;
-    Timestamp start = this->entries[fixed_id];
-    this->entries[fixed_id] = -1;
-    
-    return start;
+    size_t slot = this->getSlot(id);
+
+    this->live[slot/64] &= ~((uint64_t)1 << (slot%64));
+    this->numEntries--;
+
+    return this->entries[slot];
+}
+
+
+Timestamp Buffer_Vector::remove_secAttr(RecordId id)
+{
+    return this->remove(id);
 }
 
 
 size_t Buffer_Vector::getSize()
 {
-    size_t count = 0;
-    
-    for (auto i = 0; i < this->entries.size(); i++)
-    {
-        if (this->entries[i] != -1)
-            count++;
-    }
-    
-    return count;
+    return this->numEntries;
+}
+
+
+size_t Buffer_Vector::getMemoryUsage()
+{
+    return this->entries.capacity()*sizeof(Timestamp) + this->secAttrs.capacity()*sizeof(int) + this->live.capacity()*sizeof(uint64_t);
 }
 
 
@@ -157,41 +248,115 @@ void Buffer_Vector::print(char c)
     cout << "{";
     for (auto i = 0; i < this->entries.size(); i++)
     {
-        cout << "<" << c << i << "," << this->entries[i] << ">";
+        if (this->isLive(i))
+            cout << "<" << c << (i+this->minRecordId) << "," << this->entries[i] << ">";
     }
     cout << "}" << endl;
 }
 
 
+void Buffer_Vector::destroy()
+{
+    vector<Timestamp>().swap(this->entries);
+    vector<int>().swap(this->secAttrs);
+    vector<uint64_t>().swap(this->live);
+}
+
+
 size_t Buffer_Vector::execute_gOverlaps(RangeQuery Q)
 {
-    size_t result = 0, size = this->entries.size();
+    WorkloadSink sink;
 
-    for (auto i = 0; i < size; i++)
-    {
-        auto &start = this->entries[i];
-        if (start > Q.end)
-            break;
-        
-        if (start != -1)
-            result ^= i+this->minRecordId;
-    }
-    
-    return result;
+    this->execute_gOverlaps(Q, sink);
+
+    return sink.getResult();
 }
 
 
 size_t Buffer_Vector::execute_gOverlaps()
 {
-    size_t result = 0, size = this->entries.size();
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(sink);
+
+    return sink.getResult();
+}
+
+
+// Starts are sorted, so the slots before the cutoff qualify if live
+template <class S>
+void Buffer_Vector::execute_gOverlaps(RangeQuery Q, S &sink)
+{
+    size_t cutoff = upper_bound(this->entries.begin(), this->entries.end(), Q.end)-this->entries.begin();
+
+    scanMarkedRange(this->minRecordId, this->live.data(), cutoff, sink);
+}
+
+
+template <class S>
+void Buffer_Vector::execute_gOverlaps(S &sink)
+{
+    scanMarkedRange(this->minRecordId, this->live.data(), this->entries.size(), sink);
+}
+
+
+template <class S>
+void Buffer_Vector::executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
+{
+    size_t cutoff = upper_bound(this->entries.begin(), this->entries.end(), Q.end)-this->entries.begin();
+
+    for (auto i = 0; i < cutoff; i++)
+        sink.addIf(this->isLive(i) && (this->secAttrs[i] > secondAttrLowerConstraint) && (this->secAttrs[i] < secondAttrUpperConstraint), i+this->minRecordId);
+}
+
+
+template <class S>
+void Buffer_Vector::executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
+{
+    size_t size = this->entries.size();
 
     for (auto i = 0; i < size; i++)
-    {
-        if (this->entries[i] != -1)
-            result ^= i+this->minRecordId;
-    }
-    
-    return result;
+        sink.addIf(this->isLive(i) && (this->secAttrs[i] > secondAttrLowerConstraint) && (this->secAttrs[i] < secondAttrUpperConstraint), i+this->minRecordId);
+}
+
+
+template <class S>
+void Buffer_Vector::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink)
+{
+    size_t cutoff = upper_bound(this->entries.begin(), this->entries.end(), Q.end)-this->entries.begin();
+
+    for (auto i = 0; i < cutoff; i++)
+        sink.addIf(this->isLive(i) && (this->secAttrs[i] > secondAttrLowerConstraint), i+this->minRecordId);
+}
+
+
+template <class S>
+void Buffer_Vector::executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink)
+{
+    size_t size = this->entries.size();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf(this->isLive(i) && (this->secAttrs[i] > secondAttrLowerConstraint), i+this->minRecordId);
+}
+
+
+template <class S>
+void Buffer_Vector::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink)
+{
+    size_t cutoff = upper_bound(this->entries.begin(), this->entries.end(), Q.end)-this->entries.begin();
+
+    for (auto i = 0; i < cutoff; i++)
+        sink.addIf(this->isLive(i) && (this->secAttrs[i] < secondAttrUpperConstraint), i+this->minRecordId);
+}
+
+
+template <class S>
+void Buffer_Vector::executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink)
+{
+    size_t size = this->entries.size();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf(this->isLive(i) && (this->secAttrs[i] < secondAttrUpperConstraint), i+this->minRecordId);
 }
 
 
@@ -230,6 +395,12 @@ size_t Buffer_List::getSize()
 }
 
 
+size_t Buffer_List::getMemoryUsage()
+{
+    return this->entries.size()*(sizeof(pair<RecordId, Timestamp>)+2*sizeof(void*));
+}
+
+
 void Buffer_List::print(char c)
 {
     cout << "{";
@@ -241,9 +412,29 @@ void Buffer_List::print(char c)
 }
 
 
-size_t Buffer_List::execute_gOverlaps(RangeQuery Q){
-    // cout << "mphka3" << endl;
-    size_t result = 0;
+size_t Buffer_List::execute_gOverlaps(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(Q, sink);
+
+    return sink.getResult();
+}
+
+
+size_t Buffer_List::execute_gOverlaps()
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(sink);
+
+    return sink.getResult();
+}
+
+
+template <class S>
+void Buffer_List::execute_gOverlaps(RangeQuery Q, S &sink)
+{
     list<pair<RecordId, Timestamp> >::iterator iter, iterStart, iterEnd;
     iterStart = this->entries.begin();
     iterEnd = this->entries.end();
@@ -252,10 +443,18 @@ size_t Buffer_List::execute_gOverlaps(RangeQuery Q){
         if (iter->second > Q.end)
             break;
         
-        result ^= iter->first;
+        sink.add(iter->first);
     }
-    
-    return result;
+}
+
+
+template <class S>
+void Buffer_List::execute_gOverlaps(S &sink)
+{
+    list<pair<RecordId, Timestamp> >::iterator iter, iterEnd = this->entries.end();
+
+    for (iter = this->entries.begin(); iter != iterEnd; iter++)
+        sink.add(iter->first);
 }
 
 
@@ -341,6 +540,12 @@ size_t Buffer_ICDE16::getSize()
 }
 
 
+size_t Buffer_ICDE16::getMemoryUsage()
+{
+    return this->entries->getMemoryUsage()+this->secAttrs->getMemoryUsage();
+}
+
+
 void Buffer_ICDE16::print(char c)
 {
     cout << "{";
@@ -356,6 +561,7 @@ void Buffer_ICDE16::print(char c)
 void Buffer_ICDE16::destroy()
 {
     delete this->entries;
+    delete this->secAttrs;
 }
 
 
@@ -369,47 +575,49 @@ Buffer_ICDE16::~Buffer_ICDE16()
 
 size_t Buffer_ICDE16::execute_gOverlaps(RangeQuery Q)
 {
-    size_t result = 0;
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(Q, sink);
+
+    return sink.getResult();
+}
+
+size_t Buffer_ICDE16::execute_gOverlaps()
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(sink);
+
+    return sink.getResult();
+}
+
+template <class S>
+void Buffer_ICDE16::execute_gOverlaps(RangeQuery Q, S &sink)
+{
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
-//    auto iter = this->entries.begin(), iterEnd = this->entries.end();
 
     while (iter != iterEnd)
     {
-        if (iter->second <= Q.end){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
-            }
+        sink.addIf(iter->second <= Q.end, iter->first);
         iter++;
     }
-    
-    return result;
 }
 
-size_t Buffer_ICDE16::execute_gOverlaps()
+template <class S>
+void Buffer_ICDE16::execute_gOverlaps(S &sink)
 {
-    size_t result = 0;
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
-//    auto iter = this->entries.begin(), iterEnd = this->entries.end();
 
     while (iter != iterEnd)
     {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+        sink.add(iter->first);
         iter++;
     }
-    
-    return result;
 }
 
-size_t Buffer_ICDE16::executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint)
+template <class S>
+void Buffer_ICDE16::executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
 //    auto iter = this->entries.begin(), iterEnd = this->entries.end();
     auto iterA = this->secAttrs->begin();
@@ -417,44 +625,32 @@ size_t Buffer_ICDE16::executeTimeTravel(RangeQuery Q, int secondAttrLowerConstra
     {
         if (iter->second <= Q.end)
             if((iterA->second) > secondAttrLowerConstraint && (iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= iter->first;
-#endif
+                sink.add(iter->first);
             }
         iter++;
         iterA++;
     }
-    
-    return result;
 }
 
-size_t Buffer_ICDE16::executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint)
+template <class S>
+void Buffer_ICDE16::executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
 //    auto iter = this->entries.begin(), iterEnd = this->entries.end();
     auto iterA = this->secAttrs->begin();
     while (iter != iterEnd)
     {
         if((iterA->second) > secondAttrLowerConstraint && (iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            sink.add(iter->first);
         }
         iter++;
         iterA++;
     }
-    
-    return result;
 }
 
-size_t Buffer_ICDE16::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint)
+template <class S>
+void Buffer_ICDE16::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink)
 {
-    size_t result = 0;
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
 //    auto iter = this->entries.begin(), iterEnd = this->entries.end();
     auto iterA = this->secAttrs->begin();
@@ -462,44 +658,32 @@ size_t Buffer_ICDE16::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttr
     {
         if (iter->second <= Q.end)
             if((iterA->second) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            sink.add(iter->first);
             }
         iter++;
         iterA++;
     }
-    
-    return result;
 }
 
-size_t Buffer_ICDE16::executeTimeTravel_greaterthan(int secondAttrLowerConstraint)
+template <class S>
+void Buffer_ICDE16::executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink)
 {
-    size_t result = 0;
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
 //    auto iter = this->entries.begin(), iterEnd = this->entries.end();
     auto iterA = this->secAttrs->begin();
     while (iter != iterEnd)
     {
         if((iterA->second) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            sink.add(iter->first);
         }
         iter++;
         iterA++;
     }
-    
-    return result;
 }
 
-size_t Buffer_ICDE16::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint)
+template <class S>
+void Buffer_ICDE16::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
 //    auto iter = this->entries.begin(), iterEnd = this->entries.end();
     auto iterA = this->secAttrs->begin();
@@ -507,38 +691,559 @@ size_t Buffer_ICDE16::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUp
     {
         if (iter->second <= Q.end)
             if((iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= iter->first;
-#endif            
+                sink.add(iter->first);
         }
         iter++;
         iterA++;
     }
-    
-    return result;
 }
 
-size_t Buffer_ICDE16::executeTimeTravel_lowerthan(int secondAttrUpperConstraint)
+template <class S>
+void Buffer_ICDE16::executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     auto iter = this->entries->begin(), iterEnd = this->entries->end();
 //    auto iter = this->entries.begin(), iterEnd = this->entries.end();
     auto iterA = this->secAttrs->begin();
     while (iter != iterEnd)
     {
         if((iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            sink.add(iter->first);
         }
         iter++;
         iterA++;
     }
-    
-    return result;
 }
 
+
+
+
+Buffer_Columnar::Buffer_Columnar() : Buffer_Columnar(MAX_ICDE16_CAPACITY)
+{
+}
+
+
+Buffer_Columnar::Buffer_Columnar(size_t capacity) : Buffer(capacity)
+{
+    this->positions = new UnorderedHashIndex<RecordId>(this->capacity);
+    this->ids       = slab_malloc<RecordId>(this->capacity);
+    this->starts    = slab_malloc<Timestamp>(this->capacity);
+    this->secAttrs  = slab_malloc<int>(this->capacity);
+}
+
+
+void Buffer_Columnar::insert(RecordId id, Timestamp start)
+{
+    size_t pos = this->positions->insert(id);
+
+    this->ids[pos]    = id;
+    this->starts[pos] = start;
+}
+
+
+void Buffer_Columnar::insert_secAttr(RecordId id, Timestamp start, int secAttr)
+{
+    size_t pos = this->positions->insert(id);
+
+    this->ids[pos]      = id;
+    this->starts[pos]   = start;
+    this->secAttrs[pos] = secAttr;
+}
+
+
+void Buffer_Columnar::insert(Buffer_Columnar &B)
+{
+    size_t size = B.getSize();
+
+    for (auto i = 0; i < size; i++)
+        this->insert(B.ids[i], B.starts[i]);
+}
+
+
+void Buffer_Columnar::insert_secAttr(Buffer_Columnar &B)
+{
+    size_t size = B.getSize();
+
+    for (auto i = 0; i < size; i++)
+        this->insert_secAttr(B.ids[i], B.starts[i], B.secAttrs[i]);
+}
+
+
+// Mirrors the hash index, which moved its last key into the freed position pos
+inline void Buffer_Columnar::removeAt(size_t pos)
+{
+    size_t last = this->positions->size();
+
+    if (pos != last)
+    {
+        this->ids[pos]      = this->ids[last];
+        this->starts[pos]   = this->starts[last];
+        this->secAttrs[pos] = this->secAttrs[last];
+    }
+}
+
+
+Timestamp Buffer_Columnar::remove(RecordId id)
+{
+    size_t pos = this->positions->erase(id);
+    Timestamp start = this->starts[pos];
+
+    this->removeAt(pos);
+
+    return start;
+}
+
+
+Timestamp Buffer_Columnar::remove_secAttr(RecordId id)
+{
+    return this->remove(id);
+}
+
+
+size_t Buffer_Columnar::getSize()
+{
+    return this->positions->size();
+}
+
+
+size_t Buffer_Columnar::getMemoryUsage()
+{
+    return this->positions->getMemoryUsage() + this->capacity*(sizeof(RecordId)+sizeof(Timestamp)+sizeof(int));
+}
+
+
+void Buffer_Columnar::print(char c)
+{
+    size_t size = this->getSize();
+
+    cout << "{";
+    for (auto i = 0; i < size; i++)
+        cout << "<" << c << this->ids[i] << "," << this->starts[i] << ">";
+    cout << "}" << endl;
+}
+
+
+void Buffer_Columnar::destroy()
+{
+    delete this->positions;
+    slab_free(this->ids, this->capacity);
+    slab_free(this->starts, this->capacity);
+    slab_free(this->secAttrs, this->capacity);
+}
+
+
+size_t Buffer_Columnar::execute_gOverlaps(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(Q, sink);
+
+    return sink.getResult();
+}
+
+
+size_t Buffer_Columnar::execute_gOverlaps()
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(sink);
+
+    return sink.getResult();
+}
+
+
+template <class S>
+void Buffer_Columnar::execute_gOverlaps(RangeQuery Q, S &sink)
+{
+    scanLessEqual(this->starts, this->ids, this->getSize(), Q.end, sink);
+}
+
+
+template <class S>
+void Buffer_Columnar::execute_gOverlaps(S &sink)
+{
+    sink.addAll(this->ids, this->ids+this->getSize());
+}
+
+
+template <class S>
+void Buffer_Columnar::executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
+{
+    size_t size = this->getSize();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf((this->starts[i] <= Q.end) && (this->secAttrs[i] > secondAttrLowerConstraint) && (this->secAttrs[i] < secondAttrUpperConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Columnar::executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
+{
+    size_t size = this->getSize();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf((this->secAttrs[i] > secondAttrLowerConstraint) && (this->secAttrs[i] < secondAttrUpperConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Columnar::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink)
+{
+    size_t size = this->getSize();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf((this->starts[i] <= Q.end) && (this->secAttrs[i] > secondAttrLowerConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Columnar::executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink)
+{
+    size_t size = this->getSize();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf(this->secAttrs[i] > secondAttrLowerConstraint, this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Columnar::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink)
+{
+    size_t size = this->getSize();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf((this->starts[i] <= Q.end) && (this->secAttrs[i] < secondAttrUpperConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Columnar::executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink)
+{
+    size_t size = this->getSize();
+
+    for (auto i = 0; i < size; i++)
+        sink.addIf(this->secAttrs[i] < secondAttrUpperConstraint, this->ids[i]);
+}
+
+
+Buffer_Ordered::Buffer_Ordered() : Buffer_Ordered(MAX_ICDE16_CAPACITY)
+{
+}
+
+
+Buffer_Ordered::Buffer_Ordered(size_t capacity) : Buffer(capacity)
+{
+    this->slots      = new UnorderedHashMap<RecordId, size_t>(this->capacity);
+    this->ids        = slab_malloc<RecordId>(this->capacity);
+    this->starts     = slab_malloc<Timestamp>(this->capacity);
+    this->secAttrs   = slab_malloc<int>(this->capacity);
+    this->tombstones = slab_calloc<uint64_t>((this->capacity+63)/64);
+    this->numSlots   = 0;
+    this->numEntries = 0;
+    this->ordered    = true;
+}
+
+
+inline bool Buffer_Ordered::isRemoved(size_t slot)
+{
+    return (this->tombstones[slot/64] >> (slot%64)) & 1;
+}
+
+
+// Slots after the cutoff hold starts after end; without order, all slots have to be checked
+inline size_t Buffer_Ordered::getCutoff(Timestamp end)
+{
+    if (!this->ordered)
+        return this->numSlots;
+
+    return upper_bound(this->starts, this->starts+this->numSlots, end)-this->starts;
+}
+
+
+// Squeezes out the removed entries, keeping the order of the rest
+void Buffer_Ordered::compact()
+{
+    size_t k = 0;
+
+
+    for (auto i = 0; i < this->numSlots; i++)
+    {
+        if (this->isRemoved(i))
+            continue;
+
+        this->ids[k]      = this->ids[i];
+        this->starts[k]   = this->starts[i];
+        this->secAttrs[k] = this->secAttrs[i];
+        k++;
+    }
+    memset(this->tombstones, 0, (this->numSlots+63)/64*sizeof(uint64_t));
+    this->numSlots = k;
+
+    this->ordered = true;
+    for (auto i = 1; i < this->numSlots; i++)
+    {
+        if (this->starts[i] < this->starts[i-1])
+        {
+            this->ordered = false;
+            break;
+        }
+    }
+
+    delete this->slots;
+    this->slots = new UnorderedHashMap<RecordId, size_t>(this->capacity);
+    for (auto i = 0; i < this->numSlots; i++)
+        this->slots->insert(this->ids[i], i);
+}
+
+
+void Buffer_Ordered::insert(RecordId id, Timestamp start)
+{
+    if (this->numSlots == this->capacity)
+        this->compact();
+
+    if ((this->numSlots > 0) && (start < this->starts[this->numSlots-1]))
+        this->ordered = false;
+    this->ids[this->numSlots]    = id;
+    this->starts[this->numSlots] = start;
+    this->slots->insert(id, this->numSlots);
+    this->numSlots++;
+    this->numEntries++;
+}
+
+
+void Buffer_Ordered::insert_secAttr(RecordId id, Timestamp start, int secAttr)
+{
+    if (this->numSlots == this->capacity)
+        this->compact();
+
+    this->secAttrs[this->numSlots] = secAttr;
+    this->insert(id, start);
+}
+
+
+void Buffer_Ordered::insert(Buffer_Ordered &B)
+{
+    for (auto i = 0; i < B.numSlots; i++)
+    {
+        if (!B.isRemoved(i))
+            this->insert(B.ids[i], B.starts[i]);
+    }
+}
+
+
+void Buffer_Ordered::insert_secAttr(Buffer_Ordered &B)
+{
+    for (auto i = 0; i < B.numSlots; i++)
+    {
+        if (!B.isRemoved(i))
+            this->insert_secAttr(B.ids[i], B.starts[i], B.secAttrs[i]);
+    }
+}
+
+
+Timestamp Buffer_Ordered::remove(RecordId id)
+{
+    size_t slot = (*this->slots)[id];
+    Timestamp start = this->starts[slot];
+
+
+    this->slots->erase(id);
+    this->tombstones[slot/64] |= (uint64_t)1 << (slot%64);
+    this->numEntries--;
+
+    if (2*(this->numSlots-this->numEntries) > this->numSlots)
+        this->compact();
+
+    return start;
+}
+
+
+Timestamp Buffer_Ordered::remove_secAttr(RecordId id)
+{
+    return this->remove(id);
+}
+
+
+size_t Buffer_Ordered::getSize()
+{
+    return this->numEntries;
+}
+
+
+size_t Buffer_Ordered::getMemoryUsage()
+{
+    return this->slots->getMemoryUsage() + this->capacity*(sizeof(RecordId)+sizeof(Timestamp)+sizeof(int)) + (this->capacity+63)/64*sizeof(uint64_t);
+}
+
+
+void Buffer_Ordered::print(char c)
+{
+    cout << "{";
+    for (auto i = 0; i < this->numSlots; i++)
+    {
+        if (!this->isRemoved(i))
+            cout << "<" << c << this->ids[i] << "," << this->starts[i] << ">";
+    }
+    cout << "}" << endl;
+}
+
+
+void Buffer_Ordered::destroy()
+{
+    delete this->slots;
+    slab_free(this->ids, this->capacity);
+    slab_free(this->starts, this->capacity);
+    slab_free(this->secAttrs, this->capacity);
+    slab_free(this->tombstones, (this->capacity+63)/64);
+}
+
+
+// Reports the entries in the first numSlots slots
+template <class S>
+void Buffer_Ordered::scan(size_t numSlots, S &sink)
+{
+    if (this->numEntries == this->numSlots)
+        sink.addAll(this->ids, this->ids+numSlots);
+    else
+        scanUnmarked(this->ids, this->tombstones, numSlots, sink);
+}
+
+
+size_t Buffer_Ordered::execute_gOverlaps(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(Q, sink);
+
+    return sink.getResult();
+}
+
+
+size_t Buffer_Ordered::execute_gOverlaps()
+{
+    WorkloadSink sink;
+
+    this->execute_gOverlaps(sink);
+
+    return sink.getResult();
+}
+
+
+template <class S>
+void Buffer_Ordered::execute_gOverlaps(RangeQuery Q, S &sink)
+{
+    if (this->ordered)
+    {
+        this->scan(this->getCutoff(Q.end), sink);
+        return;
+    }
+
+    for (auto i = 0; i < this->numSlots; i++)
+        sink.addIf((!this->isRemoved(i)) && (this->starts[i] <= Q.end), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Ordered::execute_gOverlaps(S &sink)
+{
+    this->scan(this->numSlots, sink);
+}
+
+
+template <class S>
+void Buffer_Ordered::executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
+{
+    size_t cutoff = this->getCutoff(Q.end);
+
+    for (auto i = 0; i < cutoff; i++)
+        sink.addIf((!this->isRemoved(i)) && (this->starts[i] <= Q.end) && (this->secAttrs[i] > secondAttrLowerConstraint) && (this->secAttrs[i] < secondAttrUpperConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Ordered::executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
+{
+    for (auto i = 0; i < this->numSlots; i++)
+        sink.addIf((!this->isRemoved(i)) && (this->secAttrs[i] > secondAttrLowerConstraint) && (this->secAttrs[i] < secondAttrUpperConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Ordered::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink)
+{
+    size_t cutoff = this->getCutoff(Q.end);
+
+    for (auto i = 0; i < cutoff; i++)
+        sink.addIf((!this->isRemoved(i)) && (this->starts[i] <= Q.end) && (this->secAttrs[i] > secondAttrLowerConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Ordered::executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink)
+{
+    for (auto i = 0; i < this->numSlots; i++)
+        sink.addIf((!this->isRemoved(i)) && (this->secAttrs[i] > secondAttrLowerConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Ordered::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink)
+{
+    size_t cutoff = this->getCutoff(Q.end);
+
+    for (auto i = 0; i < cutoff; i++)
+        sink.addIf((!this->isRemoved(i)) && (this->starts[i] <= Q.end) && (this->secAttrs[i] < secondAttrUpperConstraint), this->ids[i]);
+}
+
+
+template <class S>
+void Buffer_Ordered::executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink)
+{
+    for (auto i = 0; i < this->numSlots; i++)
+        sink.addIf((!this->isRemoved(i)) && (this->secAttrs[i] < secondAttrUpperConstraint), this->ids[i]);
+}
+
+
+// Instantiations for the result sinks
+#define INSTANTIATE_BUFFER_SINK(B, S) \
+    template void B::execute_gOverlaps<S>(RangeQuery Q, S &sink); \
+    template void B::execute_gOverlaps<S>(S &sink);
+
+INSTANTIATE_BUFFER_SINK(Buffer_Map, CountSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Map, XorSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Map, IdSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Vector, CountSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Vector, XorSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Vector, IdSink)
+INSTANTIATE_BUFFER_SINK(Buffer_List, CountSink)
+INSTANTIATE_BUFFER_SINK(Buffer_List, XorSink)
+INSTANTIATE_BUFFER_SINK(Buffer_List, IdSink)
+INSTANTIATE_BUFFER_SINK(Buffer_ICDE16, CountSink)
+INSTANTIATE_BUFFER_SINK(Buffer_ICDE16, XorSink)
+INSTANTIATE_BUFFER_SINK(Buffer_ICDE16, IdSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Columnar, CountSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Columnar, XorSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Columnar, IdSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Ordered, CountSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Ordered, XorSink)
+INSTANTIATE_BUFFER_SINK(Buffer_Ordered, IdSink)
+
+#define INSTANTIATE_BUFFER_SECATTR_SINK(B, S) \
+    template void B::executeTimeTravel<S>(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink); \
+    template void B::executeTimeTravel<S>(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink); \
+    template void B::executeTimeTravel_greaterthan<S>(RangeQuery Q, int secondAttrLowerConstraint, S &sink); \
+    template void B::executeTimeTravel_greaterthan<S>(int secondAttrLowerConstraint, S &sink); \
+    template void B::executeTimeTravel_lowerthan<S>(RangeQuery Q, int secondAttrUpperConstraint, S &sink); \
+    template void B::executeTimeTravel_lowerthan<S>(int secondAttrUpperConstraint, S &sink);
+
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Vector, CountSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Vector, XorSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Vector, IdSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_ICDE16, CountSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_ICDE16, XorSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_ICDE16, IdSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Columnar, CountSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Columnar, XorSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Columnar, IdSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Ordered, CountSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Ordered, XorSink)
+INSTANTIATE_BUFFER_SECATTR_SINK(Buffer_Ordered, IdSink)
@@ -25,6 +25,7 @@ public:
     virtual Timestamp getMaxStart() {};
     virtual RecordId getMaxRecordId() {};
     virtual size_t getSize() {};
+    virtual size_t getMemoryUsage() { return 0; };
     virtual void print(char c) {};
     virtual void destroy() {};
 
@@ -32,14 +33,15 @@ public:
     virtual size_t execute_gOverlaps(RangeQuery Q) { return 0; };
     virtual size_t execute_gOverlaps() { return 0; };
 
-    virtual size_t executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint){ return 0; };
-    virtual size_t executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint){ return 0; };
+    // On the secondary attribute; reports nothing, unless the buffer keeps the attribute and hides these
+    template <class S> void executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink) {};
+    template <class S> void executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink) {};
     
-    virtual size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint){ return 0; };
-    virtual size_t executeTimeTravel_greaterthan(int secondAttrLowerConstraint){ return 0; };
+    template <class S> void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink) {};
+    template <class S> void executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink) {};
     
-    virtual size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint){ return 0; };
-    virtual size_t executeTimeTravel_lowerthan(int secondAttrUpperConstraint){ return 0; };
+    template <class S> void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink) {};
+    template <class S> void executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink) {};
 };
 
 
@@ -59,36 +61,60 @@ public:
     Timestamp remove_secAttr(RecordId id){};
     Timestamp remove(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
 
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
     size_t execute_gOverlaps();
+    template <class S> void execute_gOverlaps(RangeQuery Q, S &sink);
+    template <class S> void execute_gOverlaps(S &sink);
 };
 
 
 
+// Dense id range: slot i holds record minRecordId+i, so ids are not stored; a live bitmap marks the slots not removed,
+// gaps in the ids included. Starts stay in the slots of removed entries, keeping them sorted for the cutoff of queries.
 class Buffer_Vector : public Buffer
 {
 private:
     vector<Timestamp> entries;
+    vector<int>       secAttrs;         // Only for secondary-attribute inserts, aligned with entries
+    vector<uint64_t>  live;
     RecordId minRecordId;
+    size_t numEntries;
+
+    inline bool isLive(size_t slot);
+    inline size_t getSlot(RecordId id);
 
 public:
     Buffer_Vector();
     Buffer_Vector(size_t capacity);
     void insert(RecordId id, Timestamp start);
     void insert(Buffer_Vector &);
-    void insert_secAttr(RecordId id, Timestamp start, int secAttr){};
-    void insert_secAttr(Buffer_Vector &){};
-    Timestamp remove_secAttr(RecordId id){};
+    void insert_secAttr(RecordId id, Timestamp start, int secAttr);
+    void insert_secAttr(Buffer_Vector &);
+    Timestamp remove_secAttr(RecordId id);
     Timestamp remove(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
+    void destroy();
 
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
     size_t execute_gOverlaps();
+    template <class S> void execute_gOverlaps(RangeQuery Q, S &sink);
+    template <class S> void execute_gOverlaps(S &sink);
+
+    template <class S> void executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+
+    template <class S> void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink);
+    template <class S> void executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink);
+
+    template <class S> void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink);
 };
 
 
@@ -100,18 +126,21 @@ private:
 
 public:
     Buffer_List() {};
-    Buffer_List(size_t capacity) {};
+    Buffer_List(size_t capacity) : Buffer(capacity) {};
     void insert(RecordId id, Timestamp start);
 //    bool operator< (pair<RecordId, Timestamp> lhs, pair<RecordId, Timestamp> rhs);
     void insert_secAttr(RecordId id, Timestamp start, int secAttr){};
     Timestamp remove_secAttr(RecordId id){};
     Timestamp remove(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
 
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
-    size_t execute_gOverlaps() { return 0; };
+    size_t execute_gOverlaps();
+    template <class S> void execute_gOverlaps(RangeQuery Q, S &sink);
+    template <class S> void execute_gOverlaps(S &sink);
 };
 
 
@@ -133,6 +162,7 @@ public:
     Timestamp remove(RecordId id);
     Timestamp remove_secAttr(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
     void destroy();
     ~Buffer_ICDE16();
@@ -140,15 +170,113 @@ public:
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
     size_t execute_gOverlaps();
+    template <class S> void execute_gOverlaps(RangeQuery Q, S &sink);
+    template <class S> void execute_gOverlaps(S &sink);
 
-    size_t executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint);
-    size_t executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint);
+    template <class S> void executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
 
-    size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint);
-    size_t executeTimeTravel_greaterthan(int secondAttrLowerConstraint);
+    template <class S> void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink);
+    template <class S> void executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink);
     
-    size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint);
-    size_t executeTimeTravel_lowerthan(int secondAttrUpperConstraint);
+    template <class S> void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink);
+
+};
+
+
+
+// Same hashing scheme as Buffer_ICDE16, but the payload is stored column-wise; the hash index maps ids to positions
+class Buffer_Columnar : public Buffer
+{
+private:
+    UnorderedHashIndex<RecordId> *positions;
+    RecordId  *ids;
+    Timestamp *starts;
+    int       *secAttrs;
+
+    inline void removeAt(size_t pos);
+
+public:
+    Buffer_Columnar();
+    Buffer_Columnar(size_t capacity);
+    void insert(RecordId id, Timestamp start);
+    void insert_secAttr(RecordId id, Timestamp start, int secAttr);
+    void insert(Buffer_Columnar &);
+    void insert_secAttr(Buffer_Columnar &);
+    Timestamp remove(RecordId id);
+    Timestamp remove_secAttr(RecordId id);
+    size_t getSize();
+    size_t getMemoryUsage();
+    void print(char c);
+    void destroy();
+
+    // Querying
+    size_t execute_gOverlaps(RangeQuery Q);
+    size_t execute_gOverlaps();
+    template <class S> void execute_gOverlaps(RangeQuery Q, S &sink);
+    template <class S> void execute_gOverlaps(S &sink);
+
+    template <class S> void executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+
+    template <class S> void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink);
+    template <class S> void executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink);
+
+    template <class S> void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink);
+};
+
+
+
+// Column-wise payload kept in insertion order, i.e., sorted on start for a LIVE INDEX; removed entries are marked in
+// a tombstone bitmap instead of being swapped with the last one, and squeezed out once they are the majority or the
+// slots run out. Queries binary-search the last start before the end of the query, and report the entries up to it
+// without comparisons. The hash map locates the slot of an id.
+class Buffer_Ordered : public Buffer
+{
+private:
+    UnorderedHashMap<RecordId, size_t> *slots;
+    RecordId  *ids;
+    Timestamp *starts;
+    int       *secAttrs;
+    uint64_t  *tombstones;
+    size_t    numSlots;                 // Slots in use, including the removed entries
+    size_t    numEntries;
+    bool      ordered;                  // Starts are non-decreasing over the slots
+
+    inline bool isRemoved(size_t slot);
+    inline size_t getCutoff(Timestamp end);
+    void compact();
+    template <class S> void scan(size_t numSlots, S &sink);
+
+public:
+    Buffer_Ordered();
+    Buffer_Ordered(size_t capacity);
+    void insert(RecordId id, Timestamp start);
+    void insert_secAttr(RecordId id, Timestamp start, int secAttr);
+    void insert(Buffer_Ordered &);
+    void insert_secAttr(Buffer_Ordered &);
+    Timestamp remove(RecordId id);
+    Timestamp remove_secAttr(RecordId id);
+    size_t getSize();
+    size_t getMemoryUsage();
+    void print(char c);
+    void destroy();
+
+    // Querying
+    size_t execute_gOverlaps(RangeQuery Q);
+    size_t execute_gOverlaps();
+    template <class S> void execute_gOverlaps(RangeQuery Q, S &sink);
+    template <class S> void execute_gOverlaps(S &sink);
+
+    template <class S> void executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+
+    template <class S> void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink);
+    template <class S> void executeTimeTravel_greaterthan(int secondAttrLowerConstraint, S &sink);
 
+    template <class S> void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel_lowerthan(int secondAttrUpperConstraint, S &sink);
 };
 #endif // _BUFFER_H_
@@ -0,0 +1,90 @@
+#ifndef _BUFFER_DIRECTORY_H_
+#define _BUFFER_DIRECTORY_H_
+
+#include "../def_global.h"
+#include <deque>
+
+#define BUFFER_DIRECTORY_BLOCK_SIZE 256
+
+
+
+// Dense directory over the ids of a LIVE INDEX, whose buffers hold increasing id ranges: entry k is the position
+// of the last buffer with a first id not after (firstBlock+k)*blockSize. An id is located by starting from the
+// entry of its block and skipping the buffers that start inside the block, instead of binary-searching the first
+// ids. Blocks before the first buffer are dropped on rebuild(), so the directory spans the live ids only.
+class BufferDirectory
+{
+private:
+    size_t blockSize;
+    size_t firstBlock;
+    deque<size_t> blocks;
+
+public:
+    BufferDirectory(size_t blockSize)
+    {
+        this->blockSize = max(blockSize, (size_t)1);
+        this->firstBlock = 0;
+    };
+
+
+    // Called before adding buffer bid, i.e., the last one, with first id firstId; blocks after firstId are not
+    // stored until the next buffer is added, as they belong to the last buffer.
+    void append(size_t bid, RecordId firstId)
+    {
+        size_t prevBid = (bid > 0)? bid-1: 0;
+
+        while ((this->firstBlock+this->blocks.size())*this->blockSize < (size_t)firstId)
+            this->blocks.push_back(prevBid);
+    };
+
+
+    size_t locate(RecordId id, const vector<RecordId> &offsets_ids)
+    {
+        size_t k = id/this->blockSize;
+        size_t bid;
+
+        if (k < this->firstBlock)
+            bid = 0;
+        else if (k-this->firstBlock < this->blocks.size())
+            bid = this->blocks[k-this->firstBlock];
+        else
+            bid = offsets_ids.size()-1;
+
+        while ((bid+1 < offsets_ids.size()) && (offsets_ids[bid+1] <= id))
+            bid++;
+
+        return bid;
+    };
+
+
+    // Buffers [from, to) were dropped; their ids are gone or merged into buffer from-1, and later buffers shift.
+    void erase(size_t from, size_t to)
+    {
+        size_t numErased = to-from;
+        size_t dropped = (from > 0)? from-1: 0;
+
+        for (auto k = lower_bound(this->blocks.begin(), this->blocks.end(), from)-this->blocks.begin(); k < this->blocks.size(); k++)
+        {
+            if (this->blocks[k] >= to)
+                this->blocks[k] -= numErased;
+            else
+                this->blocks[k] = dropped;
+        }
+    };
+
+
+    void rebuild(const vector<RecordId> &offsets_ids)
+    {
+        this->blocks.clear();
+        this->firstBlock = (offsets_ids.empty())? 0: offsets_ids[0]/this->blockSize;
+        for (auto b = 0; b < offsets_ids.size(); b++)
+            this->append(b, offsets_ids[b]);
+    };
+
+
+    size_t getMemoryUsage()
+    {
+        return this->blocks.size()*sizeof(size_t);
+    };
+};
+#endif // _BUFFER_DIRECTORY_H_
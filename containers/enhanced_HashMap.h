@@ -1,11 +1,15 @@
 #pragma once
 
 #include "Util.h"
+#include "slab.h"
 
 
 
-template<typename K, typename V>
-class UnorderedHashMap
+// Chained hash index over 0-based positions: maps every key to its position in payload arrays kept by the caller,
+// e.g., the values of UnorderedHashMap. Positions stay dense; erase() moves the last key into the freed position,
+// and the caller has to move its payload the same way.
+template<typename K>
+class UnorderedHashIndex
 {
 private:
 	typedef int Ref;
@@ -17,57 +21,47 @@ private:
 		K key;
 	};
 
-	typedef const V* ConstIterator;
-
 	const size_t tableSize;
 	const size_t hashMask;
 	Ref* const table;
 	Ref* const tableBase;
 
 	Node* const nodes;
-	V*    const values;
 	Node* tail;
-	V*    valuesTail;
 	Node* bound;
 	Node* const nodesBase;
-	V*    const valuesBase;
 
 public:
-	UnorderedHashMap(size_t capacity) noexcept
+	UnorderedHashIndex(size_t capacity) noexcept
 	:
 		tableSize(next_power_of_two(capacity)),
 		hashMask(tableSize - 1),
-		table(array_calloc<Ref>(tableSize)),
+		table(slab_calloc<Ref>(tableSize)),
 		tableBase(table + tableSize),
 
-		nodes (array_malloc<Node>(capacity)),
-		values(array_malloc<V>(capacity)),
+		nodes(slab_malloc<Node>(capacity)),
 		tail(nodes),
-		valuesTail(values),
 		bound(nodes + capacity),
-		nodesBase(nodes - 1), // To use 1-based indexing
-		valuesBase(values - 1) // To use 1-based indexing
+		nodesBase(nodes - 1) // To use 1-based indexing
 	{
-		assert(table && nodes && values);
+		assert(table && nodes);
 	}
 
 
-	~UnorderedHashMap() noexcept
+	~UnorderedHashIndex() noexcept
 	{
-		std::free(table);
-		std::free(nodes);
-		std::free(values);
+		slab_free(table, tableSize);
+		slab_free(nodes, bound-nodes);
 	}
 
 
-	void insert(K key, const V& value) noexcept
+	// Returns the position of the new key, always the current size.
+	size_t insert(K key) noexcept
 	{
 		Ref* slot = table + position(key);
 		Ref slotRef = Ref(slot - tableBase);
 
 		Node* node = tail;
-//        if (!(tail < bound))
-//            printf("problem on r%d\n", key);
 		assert(tail < bound);
 		tail++;
 
@@ -80,13 +74,12 @@ public:
 			nodesBase[node->next].prev = nodeRef;
 		*slot = nodeRef;
 
-		*valuesTail = value;
-		valuesTail++;
+		return node - nodes;
 	}
 
 
-
-	void erase(K key) noexcept
+	// Returns the position of the erased key; if it is below the new size, the last key was moved there.
+	size_t erase(K key) noexcept
 	{
 		Ref* slot = table + position(key);
 		Ref slotRef = Ref(slot - tableBase);
@@ -101,17 +94,13 @@ public:
 			node = nodesBase + *slot;
 		}
 
-		V* currentValue = valuesBase + *slot;
-
 		*slot = node->next;
 		if (node->next)
 			nodesBase[node->next].prev = slotRef;
 
 		tail--;
-		valuesTail--;
 		if (node != tail)
 		{
-			*currentValue = *valuesTail;
 			node->prev  = tail->prev;
 			node->next  = tail->next;
 			node->key   = tail->key;
@@ -120,36 +109,25 @@ public:
 			if (node->next)
 				nodesBase[node->next].prev = nodeRef;
 
-            Ref yo = node->prev;
-			if (yo < 0)
-				tableBase[yo] = nodeRef;
+			if (node->prev < 0)
+				tableBase[node->prev] = nodeRef;
 			else
-				nodesBase[yo].next = nodeRef;
+				nodesBase[node->prev].next = nodeRef;
 		}
-	}
-
 
-    V operator[] (K key) noexcept
-    {
-        Ref* slot = table + position(key);
-        Ref slotRef = Ref(slot - tableBase);
-        
-        Node* node = nodesBase + *slot;
-        
-        
-        while (node->key != key) // Will contain the key, may skip checks for null
-        {
-            slotRef = *slot;
-            slot = &node->next;
-            node = nodesBase + *slot;
-        }
-        
-        return (*(valuesBase + *slot));
-    }
+		return node - nodes;
+	}
 
 
+	size_t operator[] (K key) const noexcept
+	{
+		Node* node = nodesBase + table[position(key)];
 
+		while (node->key != key) // Will contain the key, may skip checks for null
+			node = nodesBase + node->next;
 
+		return node - nodes;
+	}
 
 
 	inline size_t position(K key) const noexcept
@@ -158,6 +136,80 @@ public:
 	}
 
 
+	size_t size() const noexcept
+	{
+		return tail - nodes;
+	}
+
+
+	size_t capacity() const noexcept
+	{
+		return bound - nodes;
+	}
+
+
+	size_t getMemoryUsage() const noexcept
+	{
+		return tableSize*sizeof(Ref) + (bound-nodes)*sizeof(Node);
+	}
+
+
+
+	UnorderedHashIndex& operator=(const UnorderedHashIndex&) = delete;
+	UnorderedHashIndex(const UnorderedHashIndex&) = delete;
+
+};
+
+
+
+
+// The values are kept dense in insertion order, at the positions of their keys in the index.
+template<typename K, typename V>
+class UnorderedHashMap
+{
+private:
+	typedef const V* ConstIterator;
+
+	UnorderedHashIndex<K> index;
+	V* const values;
+
+public:
+	UnorderedHashMap(size_t capacity) noexcept
+	:
+		index(capacity),
+		values(slab_malloc<V>(capacity))
+	{
+		assert(values);
+	}
+
+
+	~UnorderedHashMap() noexcept
+	{
+		slab_free(values, index.capacity());
+	}
+
+
+	void insert(K key, const V& value) noexcept
+	{
+		values[index.insert(key)] = value;
+	}
+
+
+	void erase(K key) noexcept
+	{
+		size_t pos = index.erase(key);
+
+		if (pos < index.size())
+			values[pos] = values[index.size()];
+	}
+
+
+    V operator[] (K key) noexcept
+    {
+        return values[index[key]];
+    }
+
+
 	ConstIterator begin() const noexcept
 	{
 		return values;
@@ -166,13 +218,19 @@ public:
 
 	ConstIterator end() const noexcept
 	{
-		return valuesTail;
+		return values + index.size();
 	}
 
 
 	size_t size() const noexcept
 	{
-		return end() - begin();
+		return index.size();
+	}
+
+
+	size_t getMemoryUsage() const noexcept
+	{
+		return index.getMemoryUsage() + index.capacity()*sizeof(V);
 	}
 
 
@@ -181,4 +239,3 @@ public:
 	UnorderedHashMap(const UnorderedHashMap&) = delete;
 
 };
-
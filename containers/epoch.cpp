@@ -0,0 +1,147 @@
+#include "epoch.h"
+
+
+
+atomic<size_t>      EpochManager::numThreads(0);
+thread_local size_t EpochManager::localSlot = EPOCH_MAX_THREADS;
+
+
+EpochManager::EpochManager()
+{
+    this->globalEpoch = 0;
+    this->numReclaimed = 0;
+    for (auto i = 0; i < EPOCH_MAX_THREADS; i++)
+        this->slots[i].epoch = EPOCH_INACTIVE;
+}
+
+
+// Slots are assigned per thread, once per process, and shared by all managers.
+size_t EpochManager::getSlot()
+{
+    if (localSlot == EPOCH_MAX_THREADS)
+    {
+        localSlot = numThreads++;
+        if (localSlot >= EPOCH_MAX_THREADS)
+        {
+            cerr << endl << "Error - more than " << EPOCH_MAX_THREADS << " threads read an epoch-protected structure" << endl << endl;
+            ::exit(1);
+        }
+    }
+
+    return localSlot;
+}
+
+
+// Critical sections do not nest. The fence orders the announcement before the loads of the section, e.g., of the
+// pointer to a structure, even if they only acquire; otherwise the writer could retire and free the object loaded
+// without seeing the announcement.
+void EpochManager::enter()
+{
+    this->slots[getSlot()].epoch.store(this->globalEpoch.load());
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+
+void EpochManager::exit()
+{
+    this->slots[getSlot()].epoch.store(EPOCH_INACTIVE, memory_order_release);
+}
+
+
+// The object must already be unreachable for new readers.
+void EpochManager::retire(void *ptr, void (*deleter)(void*))
+{
+    this->retired.push_back({ptr, deleter, this->globalEpoch.fetch_add(1)});
+    if (this->retired.size() >= EPOCH_RECLAIM_THRESHOLD)
+        this->reclaim();
+}
+
+
+// Frees the objects retired before the oldest epoch announced by an active reader.
+void EpochManager::reclaim()
+{
+    uint64_t minEpoch = this->globalEpoch.load();
+    size_t numKept = 0;
+
+
+    for (auto i = 0; i < EPOCH_MAX_THREADS; i++)
+        minEpoch = min(minEpoch, this->slots[i].epoch.load());
+
+    for (auto &r : this->retired)
+    {
+        if (r.epoch < minEpoch)
+        {
+            r.deleter(r.ptr);
+            this->numReclaimed++;
+        }
+        else
+            this->retired[numKept++] = r;
+    }
+    this->retired.resize(numKept);
+}
+
+
+size_t EpochManager::getNumRetired()
+{
+    return this->retired.size();
+}
+
+
+size_t EpochManager::getNumReclaimed()
+{
+    return this->numReclaimed;
+}
+
+
+// No reader may be active anymore.
+EpochManager::~EpochManager()
+{
+    for (auto &r : this->retired)
+        r.deleter(r.ptr);
+}
+
+
+
+SnapshotRegistry::SnapshotRegistry()
+{
+    for (auto i = 0; i < EPOCH_MAX_THREADS; i++)
+        this->slots[i].position = EPOCH_INACTIVE;
+}
+
+
+// Pins the current value of position. The value is announced before it is used and re-read afterwards, so a writer
+// that advances the position later also sees the pin when it looks for the oldest one; as in EpochManager::enter(),
+// the fence keeps the re-read and the reads of the pinned version after the announcement.
+uint64_t SnapshotRegistry::pin(const atomic<uint64_t> &position)
+{
+    Slot &slot = this->slots[EpochManager::getSlot()];
+    uint64_t snapshot = position.load();
+
+
+    while (true)
+    {
+        slot.position.store(snapshot);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        uint64_t current = position.load();
+        if (current == snapshot)
+            return snapshot;
+        snapshot = current;
+    }
+}
+
+
+void SnapshotRegistry::unpin()
+{
+    this->slots[EpochManager::getSlot()].position.store(EPOCH_INACTIVE, memory_order_release);
+}
+
+
+// The given position if no snapshot is pinned.
+uint64_t SnapshotRegistry::getOldestPinned(uint64_t position)
+{
+    for (auto i = 0; i < EPOCH_MAX_THREADS; i++)
+        position = min(position, this->slots[i].position.load());
+
+    return position;
+}
@@ -0,0 +1,98 @@
+#ifndef _EPOCH_H_
+#define _EPOCH_H_
+
+#include "../def_global.h"
+#include <atomic>
+
+#define EPOCH_MAX_THREADS 128
+#define EPOCH_RECLAIM_THRESHOLD 64
+#define EPOCH_INACTIVE ((uint64_t)-1)
+
+
+
+// Epoch-based reclamation for structures with lock-free readers and a single writer. A reader announces the
+// global epoch while inside a critical section (EpochGuard); the writer unlinks an object, then retires it
+// stamped with the epoch it bumps, and frees it once every active reader announced a later epoch, i.e., once
+// no reader can still hold a pointer to it.
+class EpochManager
+{
+private:
+    struct alignas(64) Slot
+    {
+        atomic<uint64_t> epoch;
+    };
+
+    struct Retired
+    {
+        void *ptr;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    atomic<uint64_t> globalEpoch;
+    Slot slots[EPOCH_MAX_THREADS];
+    vector<Retired> retired;            // Owned by the writer
+    size_t numReclaimed;
+
+    static atomic<size_t> numThreads;
+    static thread_local size_t localSlot;
+
+    void retire(void *ptr, void (*deleter)(void*));
+
+public:
+    static size_t getSlot();
+
+    EpochManager();
+    void enter();
+    void exit();
+    template <class T> void retire(T *ptr)
+    {
+        this->retire(ptr, [](void *p) { delete (T*)p; });
+    };
+    void reclaim();
+    size_t getNumRetired();
+    size_t getNumReclaimed();
+    ~EpochManager();
+};
+
+
+
+// Stream positions pinned by readers of a versioned structure; the writer may discard a version only if it was
+// superseded at or before the oldest pinned position.
+class SnapshotRegistry
+{
+private:
+    struct alignas(64) Slot
+    {
+        atomic<uint64_t> position;
+    };
+
+    Slot slots[EPOCH_MAX_THREADS];
+
+public:
+    SnapshotRegistry();
+    uint64_t pin(const atomic<uint64_t> &position);
+    void unpin();
+    uint64_t getOldestPinned(uint64_t position);
+};
+
+
+
+// Scoped critical section of a reader
+class EpochGuard
+{
+private:
+    EpochManager *manager;
+
+public:
+    EpochGuard(EpochManager *manager)
+    {
+        this->manager = manager;
+        this->manager->enter();
+    };
+    ~EpochGuard()
+    {
+        this->manager->exit();
+    };
+};
+#endif // _EPOCH_H_
@@ -0,0 +1,571 @@
+#ifndef _PARTITION_STORE_H_
+#define _PARTITION_STORE_H_
+
+#include "../def_global.h"
+#include "scan_kernels.h"
+#include "segment.h"
+#include <map>
+#include <memory>
+
+#define PARTITION_STORE_MIN_TAIL    1024        // Entries appended before the first compaction
+#define PARTITION_STORE_TAIL_RATIO  2           // Compact when the appended entries reach 1/ratio of the flat ones
+#define PARTITION_STORE_MIN_SEGMENT 16384       // Entries sealed at once, so that the files and mappings stay few
+
+
+
+// A contiguous run of entries of a PartitionStore; starts and ends are NULL when the store does not keep them
+struct PartitionRun
+{
+    const RecordId  *ids;
+    const Timestamp *starts, *ends;
+    size_t          size;
+};
+
+
+// The partitions of one HINT level for one class (originals or replicas, in or aft), with the ids and the endpoints
+// that queries compare stored column-wise. The compacted partitions are packed one after the other into flat
+// columns, partition p occupying [offsets[p], offsets[p+1]); new entries go to a growable tail per partition and
+// are merged into the flat columns once the tails hold enough of them, so that the copying amortizes. Only the
+// tails of the last partitions are merged, rebuilding the flat columns from the first of them on; as records
+// arrive roughly by end, these hold most of the tail entries.
+// A partition is therefore read as up to two runs, and consecutive partitions share a single flat run. Partitions
+// are added as entries reach them and evicted from the front; partition ids stay absolute, the stored ones
+// starting at firstPartition, and the ones evicted or past the last are empty.
+// Instead of being evicted, the partitions before firstPartition can be sealed into a cold tier: their flat part is
+// written to a segment file and read back through mmap, while the few entries that still reach them, i.e., pieces
+// of long records, go to sparse tails in memory that are never merged. A store either evicts or seals, not both.
+// As in the sorted HINT^m variants, the flat part of a partition is sorted, on the ends if kept, otherwise on the
+// starts; the scans on the sort key cut it with a binary search and compare only the unsorted tail. Records arrive
+// roughly by end, so the tails of the partitions sorted on the ends mostly just extend their flat part.
+class PartitionStore
+{
+private:
+    bool keepStarts, keepEnds;
+    vector<size_t>    offsets;
+    vector<RecordId>  ids;
+    vector<Timestamp> starts, ends;
+    vector<vector<RecordId> >  tailIds;
+    vector<vector<Timestamp> > tailStarts, tailEnds;
+    size_t numTailEntries;
+    size_t firstPartition;          // Of the stored partitions
+    size_t firstLive;               // Of the partitions not evicted; the ones in between await reclaiming
+
+    struct Tail
+    {
+        vector<RecordId>  ids;
+        vector<Timestamp> starts, ends;
+    };
+    vector<shared_ptr<Segment> > segments;  // The flat parts of the sealed partitions, in partition order
+    map<size_t, Tail> sealedTails;          // Of the sealed partitions reached after sealing
+
+    struct Entry
+    {
+        Timestamp key;
+        RecordId  id;
+        Timestamp other;            // The start, if both endpoints are kept
+    };
+
+
+    // Copies the flat part of partition p followed by its tail into the new columns
+    void append(size_t p, vector<RecordId> &newIds, vector<Timestamp> &newStarts, vector<Timestamp> &newEnds)
+    {
+        size_t from = this->offsets[p], to = this->offsets[p+1];
+
+        newIds.insert(newIds.end(), this->ids.begin()+from, this->ids.begin()+to);
+        newIds.insert(newIds.end(), this->tailIds[p].begin(), this->tailIds[p].end());
+        if (this->keepStarts)
+        {
+            newStarts.insert(newStarts.end(), this->starts.begin()+from, this->starts.begin()+to);
+            newStarts.insert(newStarts.end(), this->tailStarts[p].begin(), this->tailStarts[p].end());
+        }
+        if (this->keepEnds)
+        {
+            newEnds.insert(newEnds.end(), this->ends.begin()+from, this->ends.begin()+to);
+            newEnds.insert(newEnds.end(), this->tailEnds[p].begin(), this->tailEnds[p].end());
+        }
+    };
+
+
+    // Sorts the tail of partition p on the key and merges it with the flat part of p into the new columns; a tail
+    // that already follows the flat part in order, the common case when streaming, is appended as is
+    void merge(size_t p, vector<RecordId> &newIds, vector<Timestamp> &newStarts, vector<Timestamp> &newEnds)
+    {
+        size_t i = this->offsets[p], iEnd = this->offsets[p+1];
+        vector<Timestamp> &keys = (this->keepEnds)? this->ends: this->starts;
+        vector<Timestamp> &newKeys = (this->keepEnds)? newEnds: newStarts;
+        vector<Timestamp> &tailKeys = (this->keepEnds)? this->tailEnds[p]: this->tailStarts[p];
+        bool keepOther = (this->keepStarts && this->keepEnds);
+
+
+        if (((i == iEnd) || (keys[iEnd-1] <= tailKeys.front())) && (is_sorted(tailKeys.begin(), tailKeys.end())))
+        {
+            this->append(p, newIds, newStarts, newEnds);
+            return;
+        }
+
+        vector<Entry> tail(this->tailIds[p].size());
+        auto j = tail.begin();
+
+        for (auto k = 0; k < tail.size(); k++)
+            tail[k] = Entry{tailKeys[k], this->tailIds[p][k], (keepOther)? this->tailStarts[p][k]: 0};
+        sort(tail.begin(), tail.end(), [](const Entry &x, const Entry &y) { return x.key < y.key; });
+
+        while ((i < iEnd) || (j != tail.end()))
+        {
+            if ((j == tail.end()) || ((i < iEnd) && (keys[i] <= j->key)))
+            {
+                newIds.push_back(this->ids[i]);
+                newKeys.push_back(keys[i]);
+                if (keepOther)
+                    newStarts.push_back(this->starts[i]);
+                i++;
+            }
+            else
+            {
+                newIds.push_back(j->id);
+                newKeys.push_back(j->key);
+                if (keepOther)
+                    newStarts.push_back(j->other);
+                j++;
+            }
+        }
+    };
+
+
+    // Copies partition p, merging its tail into its flat part, into the new columns
+    void appendMerged(size_t p, vector<RecordId> &newIds, vector<Timestamp> &newStarts, vector<Timestamp> &newEnds)
+    {
+        if ((!this->tailIds[p].empty()) && (this->keepStarts || this->keepEnds))
+            this->merge(p, newIds, newStarts, newEnds);
+        else
+            this->append(p, newIds, newStarts, newEnds);
+    };
+
+
+    void releaseTail(size_t p)
+    {
+        vector<RecordId>().swap(this->tailIds[p]);
+        if (this->keepStarts)
+            vector<Timestamp>().swap(this->tailStarts[p]);
+        if (this->keepEnds)
+            vector<Timestamp>().swap(this->tailEnds[p]);
+    };
+
+
+    // Merges the tails of the partitions from on into the flat columns and releases them; the flat columns before
+    // partition from stay in place.
+    void compact(size_t from)
+    {
+        size_t numPartitions = this->tailIds.size(), first = this->offsets[from];
+        vector<size_t>    newOffsets(numPartitions-from, 0);
+        vector<RecordId>  newIds;
+        vector<Timestamp> newStarts, newEnds;
+
+
+        for (auto p = from; p < numPartitions; p++)
+        {
+            this->appendMerged(p, newIds, newStarts, newEnds);
+            this->numTailEntries -= this->tailIds[p].size();
+            this->releaseTail(p);
+            newOffsets[p-from] = first+newIds.size();
+        }
+
+        copy(newOffsets.begin(), newOffsets.end(), this->offsets.begin()+from+1);
+
+        this->ids.resize(first);
+        this->ids.insert(this->ids.end(), newIds.begin(), newIds.end());
+        if (this->keepStarts)
+        {
+            this->starts.resize(first);
+            this->starts.insert(this->starts.end(), newStarts.begin(), newStarts.end());
+        }
+        if (this->keepEnds)
+        {
+            this->ends.resize(first);
+            this->ends.insert(this->ends.end(), newEnds.begin(), newEnds.end());
+        }
+    };
+
+
+    // Maps partition id p to its position among the stored partitions, if stored and not evicted
+    inline bool locate(size_t &p)
+    {
+        if ((p < this->firstLive) || (p < this->firstPartition))
+            return false;
+        p -= this->firstPartition;
+
+        return (p < this->tailIds.size());
+    };
+
+
+    inline PartitionRun slice(const RecordId *ids, const Timestamp *starts, const Timestamp *ends, size_t first, size_t last)
+    {
+        return PartitionRun{ids+first, (this->keepStarts)? starts+first: NULL, (this->keepEnds)? ends+first: NULL, last-first};
+    };
+
+
+    // The flat part of partition p, from the flat columns or from its segment if sealed
+    inline PartitionRun getFlat(size_t p)
+    {
+        size_t f = p;
+
+        if (this->locate(f))
+            return this->slice(this->ids.data(), this->starts.data(), this->ends.data(), this->offsets[f], this->offsets[f+1]);
+        if ((p < this->firstLive) || (p >= this->firstPartition))
+            return PartitionRun{NULL, NULL, NULL, 0};
+
+        auto iter = upper_bound(this->segments.begin(), this->segments.end(), p, [](size_t p, const shared_ptr<Segment> &s) { return p < s->firstPartition; });
+
+        if ((iter == this->segments.begin()) || (p >= (*(iter-1))->firstPartition+(*(iter-1))->numPartitions))
+            return PartitionRun{NULL, NULL, NULL, 0};
+
+        Segment &s = **(iter-1);
+
+        p -= s.firstPartition;
+
+        return this->slice(s.ids, s.starts, s.ends, s.offsets[p], s.offsets[p+1]);
+    };
+
+
+    // The tail of partition p
+    inline PartitionRun getTail(size_t p)
+    {
+        size_t t = p;
+
+        if (this->locate(t))
+            return PartitionRun{this->tailIds[t].data(), (this->keepStarts)? this->tailStarts[t].data(): NULL, (this->keepEnds)? this->tailEnds[t].data(): NULL, this->tailIds[t].size()};
+        if (p >= this->firstLive)
+        {
+            auto iter = this->sealedTails.find(p);
+
+            if (iter != this->sealedTails.end())
+                return PartitionRun{iter->second.ids.data(), iter->second.starts.data(), iter->second.ends.data(), iter->second.ids.size()};
+        }
+
+        return PartitionRun{NULL, NULL, NULL, 0};
+    };
+
+
+    // Drops the first k partitions of the flat columns and their tails
+    void drop(size_t k)
+    {
+        vector<size_t>    newOffsets(this->offsets.begin()+k, this->offsets.end());
+        vector<RecordId>  newIds(this->ids.begin()+this->offsets[k], this->ids.end());
+        vector<Timestamp> newStarts, newEnds;
+
+        if (this->keepStarts)
+            newStarts.assign(this->starts.begin()+this->offsets[k], this->starts.end());
+        if (this->keepEnds)
+            newEnds.assign(this->ends.begin()+this->offsets[k], this->ends.end());
+        for (auto &o : newOffsets)
+            o -= this->offsets[k];
+
+        this->offsets.swap(newOffsets);
+        this->ids.swap(newIds);
+        this->starts.swap(newStarts);
+        this->ends.swap(newEnds);
+        this->tailIds.erase(this->tailIds.begin(), this->tailIds.begin()+k);
+        if (this->keepStarts)
+            this->tailStarts.erase(this->tailStarts.begin(), this->tailStarts.begin()+k);
+        if (this->keepEnds)
+            this->tailEnds.erase(this->tailEnds.begin(), this->tailEnds.begin()+k);
+        this->firstPartition += k;
+    };
+
+public:
+    PartitionStore(bool keepStarts = false, bool keepEnds = false)
+    {
+        this->keepStarts = keepStarts;
+        this->keepEnds = keepEnds;
+        this->offsets.push_back(0);
+        this->numTailEntries = 0;
+        this->firstPartition = this->firstLive = 0;
+    };
+
+
+    size_t getNumPartitions()
+    {
+        return this->firstPartition+this->tailIds.size();
+    };
+
+
+    // Adds empty partitions at the end, up to numPartitions; the vectors grow geometrically
+    void resize(size_t numPartitions)
+    {
+        if (numPartitions <= this->firstPartition+this->tailIds.size())
+            return;
+        numPartitions -= this->firstPartition;
+
+        this->offsets.resize(numPartitions+1, this->offsets.back());
+        this->tailIds.resize(numPartitions);
+        if (this->keepStarts)
+            this->tailStarts.resize(numPartitions);
+        if (this->keepEnds)
+            this->tailEnds.resize(numPartitions);
+    };
+
+
+    // Entries of evicted partitions are discarded
+    void push_back(size_t p, RecordId id, Timestamp start, Timestamp end)
+    {
+        if (p < this->firstLive)
+            return;
+        if (p < this->firstPartition)
+        {
+            Tail &tail = this->sealedTails[p];
+
+            tail.ids.push_back(id);
+            if (this->keepStarts)
+                tail.starts.push_back(start);
+            if (this->keepEnds)
+                tail.ends.push_back(end);
+            return;
+        }
+        if (p >= this->firstPartition+this->tailIds.size())
+            this->resize(p+1);
+        p -= this->firstPartition;
+
+        this->tailIds[p].push_back(id);
+        if (this->keepStarts)
+            this->tailStarts[p].push_back(start);
+        if (this->keepEnds)
+            this->tailEnds[p].push_back(end);
+        this->numTailEntries++;
+
+        // The tails kept, the ones before from, hold at most half of the entries that trigger a compaction. So the
+        // compaction merges at least the other half, i.e., 1/(2*ratio) of the flat entries, which bounds the copying
+        // of the flat suffix, and the next one is at least as many appended entries away.
+        size_t threshold = max((size_t)PARTITION_STORE_MIN_TAIL, this->ids.size()/PARTITION_STORE_TAIL_RATIO);
+
+        if (this->numTailEntries >= threshold)
+        {
+            size_t from = 0, numKept = 0;
+
+            while (2*(numKept+this->tailIds[from].size()) <= threshold)
+                numKept += this->tailIds[from++].size();
+            this->compact(from);
+        }
+    };
+
+
+    // Merges all tails into the flat columns and releases them
+    void compact()
+    {
+        if (this->numTailEntries > 0)
+            this->compact(0);
+    };
+
+
+    size_t size(size_t p)
+    {
+        return this->getFlat(p).size+this->getTail(p).size;
+    };
+
+
+    bool empty(size_t p)
+    {
+        return (this->size(p) == 0);
+    };
+
+
+    // Calls f on the runs of partitions from..to: the flat one they share, then their non-empty tails; the sealed
+    // partitions among them are read first, one flat run per segment
+    template <class F>
+    inline void forEachRun(size_t from, size_t to, F f)
+    {
+        if ((to < this->firstLive) || (from >= this->firstPartition+this->tailIds.size()))
+            return;
+        from = max(from, this->firstLive);
+
+        if (from < this->firstPartition)
+        {
+            this->forEachSealedRun(from, min(to, this->firstPartition-1), f);
+            if ((to < this->firstPartition) || (this->tailIds.empty()))
+                return;
+            from = this->firstPartition;
+        }
+        from -= this->firstPartition;
+        to = min(to-this->firstPartition, this->tailIds.size()-1);
+
+        size_t first = this->offsets[from], last = this->offsets[to+1];
+
+        if (first < last)
+            f(PartitionRun{this->ids.data()+first, (this->keepStarts)? this->starts.data()+first: NULL, (this->keepEnds)? this->ends.data()+first: NULL, last-first});
+
+        for (auto p = from; p <= to; p++)
+        {
+            if (!this->tailIds[p].empty())
+                f(PartitionRun{this->tailIds[p].data(), (this->keepStarts)? this->tailStarts[p].data(): NULL, (this->keepEnds)? this->tailEnds[p].data(): NULL, this->tailIds[p].size()});
+        }
+    };
+
+
+    template <class F>
+    inline void forEachSealedRun(size_t from, size_t to, F f)
+    {
+        auto iter = upper_bound(this->segments.begin(), this->segments.end(), from, [](size_t p, const shared_ptr<Segment> &s) { return p < s->firstPartition; });
+
+        if (iter != this->segments.begin())
+            iter--;
+        for (; (iter != this->segments.end()) && ((*iter)->firstPartition <= to); iter++)
+        {
+            Segment &s = **iter;
+            size_t first = max(from, s.firstPartition)-s.firstPartition, last = min(to+1, s.firstPartition+s.numPartitions)-s.firstPartition;
+
+            if ((first < last) && (s.offsets[first] < s.offsets[last]))
+                f(this->slice(s.ids, s.starts, s.ends, s.offsets[first], s.offsets[last]));
+        }
+
+        for (auto t = this->sealedTails.lower_bound(from); (t != this->sealedTails.end()) && (t->first <= to); t++)
+            f(PartitionRun{t->second.ids.data(), t->second.starts.data(), t->second.ends.data(), t->second.ids.size()});
+    };
+
+
+    // All entries of partitions from..to are results
+    template <class S>
+    inline void addAll(size_t from, size_t to, S &sink)
+    {
+        this->forEachRun(from, to, [&sink](const PartitionRun &run) { sink.addAll(run.ids, run.ids+run.size); });
+    };
+
+
+    // Entries of partition p that start not after bound; requires the starts, sorted on if the ends are not kept
+    template <class S>
+    inline void scanLessEqual(size_t p, Timestamp bound, S &sink)
+    {
+        PartitionRun flat = this->getFlat(p), tail = this->getTail(p);
+
+        if (this->keepEnds)
+            ::scanLessEqual(flat.starts, flat.ids, flat.size, bound, sink);
+        else
+            sink.addAll(flat.ids, flat.ids+(upper_bound(flat.starts, flat.starts+flat.size, bound)-flat.starts));
+        ::scanLessEqual(tail.starts, tail.ids, tail.size, bound, sink);
+    };
+
+
+    // Entries of partition p that end not before bound; requires the ends
+    template <class S>
+    inline void scanGreaterEqual(size_t p, Timestamp bound, S &sink)
+    {
+        PartitionRun flat = this->getFlat(p), tail = this->getTail(p);
+
+        sink.addAll(flat.ids+(lower_bound(flat.ends, flat.ends+flat.size, bound)-flat.ends), flat.ids+flat.size);
+        ::scanGreaterEqual(tail.ends, tail.ids, tail.size, bound, sink);
+    };
+
+
+    // Entries of partition p that overlap [qstart, qend]; requires both endpoints
+    template <class S>
+    inline void scanOverlap(size_t p, Timestamp qstart, Timestamp qend, S &sink)
+    {
+        PartitionRun flat = this->getFlat(p), tail = this->getTail(p);
+        size_t first = lower_bound(flat.ends, flat.ends+flat.size, qstart)-flat.ends;
+
+        ::scanLessEqual(flat.starts+first, flat.ids+first, flat.size-first, qend, sink);
+        ::scanOverlap(tail.starts, tail.ends, tail.ids, tail.size, qstart, qend, sink);
+    };
+
+
+    // Evicts the partitions before upTo, returning the number of entries evicted. The memory is reclaimed in bulk,
+    // once the evicted partitions hold half of the entries stored or make up half of the partitions, so that the
+    // copying amortizes.
+    size_t evict(size_t upTo)
+    {
+        size_t numPartitions = this->tailIds.size(), numEvicted = 0, numTailDropped = 0, k;
+
+
+        if (upTo <= this->firstLive)
+            return 0;
+
+        k = min(upTo-this->firstPartition, numPartitions);
+        for (size_t p = this->firstLive-this->firstPartition; p < k; p++)
+            numEvicted += this->offsets[p+1]-this->offsets[p]+this->tailIds[p].size();
+        this->firstLive = upTo;
+
+        for (size_t p = 0; p < k; p++)
+            numTailDropped += this->tailIds[p].size();
+        if ((2*(this->offsets[k]+numTailDropped) < this->ids.size()+this->numTailEntries) && (2*k < numPartitions))
+            return numEvicted;
+
+        this->drop(k);
+        this->numTailEntries -= numTailDropped;
+
+        return numEvicted;
+    };
+
+
+    // Seals the partitions before upTo into a segment in directory. As with evict(), they are sealed in bulk, once
+    // they hold half of the entries in memory or make up half of the partitions there, and at least
+    // PARTITION_STORE_MIN_SEGMENT entries. Only the sealed partitions are merged with their tails, into the segment.
+    // Returns false if the segment cannot be written; the partitions then stay in memory, as they are.
+    bool seal(size_t upTo, const char *directory)
+    {
+        size_t numPartitions = this->tailIds.size(), numSealed, numTailSealed = 0, k;
+        vector<size_t>    sealedOffsets;
+        vector<RecordId>  sealedIds;
+        vector<Timestamp> sealedStarts, sealedEnds;
+
+
+        if (upTo <= this->firstPartition)
+            return true;
+
+        k = min(upTo-this->firstPartition, numPartitions);
+        for (size_t p = 0; p < k; p++)
+            numTailSealed += this->tailIds[p].size();
+        numSealed = this->offsets[k]+numTailSealed;
+        if ((numSealed < PARTITION_STORE_MIN_SEGMENT) || ((2*numSealed < this->ids.size()+this->numTailEntries) && (2*k < numPartitions)))
+            return true;
+
+        sealedOffsets.push_back(0);
+        sealedIds.reserve(numSealed);
+        if (this->keepStarts)
+            sealedStarts.reserve(numSealed);
+        if (this->keepEnds)
+            sealedEnds.reserve(numSealed);
+        for (size_t p = 0; p < k; p++)
+        {
+            this->appendMerged(p, sealedIds, sealedStarts, sealedEnds);
+            sealedOffsets.push_back(sealedIds.size());
+        }
+
+        auto segment = make_shared<Segment>(directory, this->firstPartition, k, sealedOffsets.data(), sealedIds.data(), (this->keepStarts)? sealedStarts.data(): NULL, (this->keepEnds)? sealedEnds.data(): NULL);
+
+        if (!segment->isOpen())
+            return false;
+        this->segments.push_back(segment);
+        this->drop(k);
+        this->numTailEntries -= numTailSealed;
+
+        return true;
+    };
+
+
+    size_t getMemoryUsage()
+    {
+        size_t bytes = this->offsets.capacity()*sizeof(size_t) + this->ids.capacity()*sizeof(RecordId) + (this->starts.capacity()+this->ends.capacity())*sizeof(Timestamp)
+                     + this->tailIds.capacity()*sizeof(vector<RecordId>) + (this->tailStarts.capacity()+this->tailEnds.capacity())*sizeof(vector<Timestamp>);
+
+        for (auto &t : this->tailIds)
+            bytes += t.capacity()*sizeof(RecordId);
+        for (auto &t : this->tailStarts)
+            bytes += t.capacity()*sizeof(Timestamp);
+        for (auto &t : this->tailEnds)
+            bytes += t.capacity()*sizeof(Timestamp);
+        for (auto &t : this->sealedTails)
+            bytes += sizeof(t) + t.second.ids.capacity()*sizeof(RecordId) + (t.second.starts.capacity()+t.second.ends.capacity())*sizeof(Timestamp);
+
+        return bytes;
+    };
+
+
+    size_t getSegmentSize()
+    {
+        size_t bytes = 0;
+
+        for (auto &s : this->segments)
+            bytes += s->getFileSize();
+
+        return bytes;
+    };
+};
+#endif // _PARTITION_STORE_H_
@@ -0,0 +1,505 @@
+#ifndef _SCAN_KERNELS_H_
+#define _SCAN_KERNELS_H_
+
+#include "../def_global.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_KERNELS_X86
+#define SCAN_TARGET_AVX2   __attribute__((target("avx2")))
+#define SCAN_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+#define SCAN_LEVEL_SCALAR 0
+#define SCAN_LEVEL_AVX2   1
+#define SCAN_LEVEL_AVX512 2
+
+
+
+// Scan kernels over the columnar partitions (separate start/end/id arrays) of HINT_M_Dynamic; each kernel
+// reports ids[i] to the sink for every i that satisfies its predicate:
+//   scanLessEqual   : keys[i] <= bound
+//   scanGreaterEqual: keys[i] >= bound
+//   scanOverlap     : starts[i] <= qend && qstart <= ends[i]
+//   scanUnmarked    : bit i of marks is clear, e.g., not removed from a buffer with tombstones
+//   scanMarkedRange : bit i of marks is set, for the dense ids firstId+i, e.g., live in a buffer with a live bitmap
+// The count and XOR sinks get AVX-512/AVX2 implementations on x86, compiled for their instruction set whatever the
+// flags of the build and selected at runtime by the CPU; the generic template serves the remaining sinks, the tails
+// and the CPUs without AVX2. Timestamp and RecordId are 32-bit, i.e., 16 or 8 lanes per vector.
+
+
+template <class S>
+inline void scanLessEqual(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound, S &sink)
+{
+    for (size_t i = 0; i < n; i++)
+        sink.addIf(keys[i] <= bound, ids[i]);
+}
+
+
+template <class S>
+inline void scanGreaterEqual(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound, S &sink)
+{
+    for (size_t i = 0; i < n; i++)
+        sink.addIf(keys[i] >= bound, ids[i]);
+}
+
+
+template <class S>
+inline void scanOverlap(const Timestamp *starts, const Timestamp *ends, const RecordId *ids, size_t n, Timestamp qstart, Timestamp qend, S &sink)
+{
+    for (size_t i = 0; i < n; i++)
+        sink.addIf((starts[i] <= qend) && (qstart <= ends[i]), ids[i]);
+}
+
+
+// Bits of marks word w, for the slots below n
+inline uint64_t unmarkedBits(const uint64_t *marks, size_t n, size_t w)
+{
+    uint64_t bits = ~marks[w];
+
+    if ((w+1)*64 > n)
+        bits &= ((uint64_t)1 << (n-w*64))-1;
+
+    return bits;
+}
+
+
+// A word at a time: full words are reported as a run, the rest bit by bit
+template <class S>
+inline void scanUnmarked(const RecordId *ids, const uint64_t *marks, size_t n, S &sink)
+{
+    for (size_t w = 0; w*64 < n; w++)
+    {
+        uint64_t bits = unmarkedBits(marks, n, w);
+
+        if (bits == ~(uint64_t)0)
+            sink.addAll(ids+w*64, ids+w*64+64);
+        else
+        {
+            for (; bits; bits &= bits-1)
+                sink.add(ids[w*64+__builtin_ctzll(bits)]);
+        }
+    }
+}
+
+
+inline void scanUnmarked(const RecordId *ids, const uint64_t *marks, size_t n, CountSink &sink)
+{
+    for (size_t w = 0; w*64 < n; w++)
+        sink.result += __builtin_popcountll(unmarkedBits(marks, n, w));
+}
+
+
+// Branch-free: every id is masked by its bit, so the loop over a word vectorizes
+inline void scanUnmarked(const RecordId *ids, const uint64_t *marks, size_t n, XorSink &sink)
+{
+    RecordId acc = 0;
+
+    for (size_t w = 0; w*64 < n; w++)
+    {
+        uint64_t bits = unmarkedBits(marks, n, w);
+        const RecordId *wids = ids+w*64;
+        size_t m = min(n-w*64, (size_t)64);
+
+        for (size_t j = 0; j < m; j++)
+            acc ^= wids[j] & -(RecordId)((bits >> j) & 1);
+    }
+    sink.add(acc);
+}
+
+
+// Bits of marks word w, for the slots below n
+inline uint64_t markedBits(const uint64_t *marks, size_t n, size_t w)
+{
+    uint64_t bits = marks[w];
+
+    if ((w+1)*64 > n)
+        bits &= ((uint64_t)1 << (n-w*64))-1;
+
+    return bits;
+}
+
+
+template <class S>
+inline void scanMarkedRange(RecordId firstId, const uint64_t *marks, size_t n, S &sink)
+{
+    for (size_t w = 0; w*64 < n; w++)
+    {
+        RecordId base = firstId+w*64;
+
+        for (uint64_t bits = markedBits(marks, n, w); bits; bits &= bits-1)
+            sink.add(base+__builtin_ctzll(bits));
+    }
+}
+
+
+inline void scanMarkedRange(RecordId firstId, const uint64_t *marks, size_t n, CountSink &sink)
+{
+    for (size_t w = 0; w*64 < n; w++)
+        sink.result += __builtin_popcountll(markedBits(marks, n, w));
+}
+
+
+// XOR of the ids in [0, id)
+inline RecordId xorPrefix(RecordId id)
+{
+    switch (id%4)
+    {
+        case 0: return 0;
+        case 1: return id-1;
+        case 2: return 1;
+        default: return id;
+    }
+}
+
+
+// Full words take the XOR of their id range in closed form, sparse ones go bit by bit, the rest are masked without
+// branches
+inline void scanMarkedRange(RecordId firstId, const uint64_t *marks, size_t n, XorSink &sink)
+{
+    RecordId acc = 0;
+
+    for (size_t w = 0; w*64 < n; w++)
+    {
+        uint64_t bits = markedBits(marks, n, w);
+        RecordId base = firstId+w*64;
+        size_t m = min(n-w*64, (size_t)64);
+
+        if (bits == ~(uint64_t)0)
+            acc ^= xorPrefix(base+64)^xorPrefix(base);
+        else if (__builtin_popcountll(bits) < 16)
+        {
+            for (; bits; bits &= bits-1)
+                acc ^= base+__builtin_ctzll(bits);
+        }
+        else
+        {
+            for (size_t j = 0; j < m; j++)
+                acc ^= (base+(RecordId)j) & -(RecordId)((bits >> j) & 1);
+        }
+    }
+    sink.add(acc);
+}
+
+
+
+#ifdef SCAN_KERNELS_X86
+// AVX-512: every kernel covers the first n entries, n a multiple of 16, and returns the count or the XOR of the ids
+// that satisfy its predicate
+
+// XOR of all lanes; sign-extending the 32-bit XOR equals XOR'ing the sign-extended ids as XorSink::add() does
+SCAN_TARGET_AVX512 inline RecordId reduceXorAVX512(__m512i acc)
+{
+    __m256i x = _mm256_xor_si256(_mm512_castsi512_si256(acc), _mm512_extracti64x4_epi64(acc, 1));
+    __m128i y = _mm_xor_si128(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+
+    y = _mm_xor_si128(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2)));
+    y = _mm_xor_si128(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(y);
+}
+
+
+SCAN_TARGET_AVX512 inline size_t countLessEqualAVX512(const Timestamp *keys, size_t n, Timestamp bound)
+{
+    __m512i vbound = _mm512_set1_epi32(bound);
+    size_t result = 0;
+
+    for (size_t i = 0; i < n; i += 16)
+        result += __builtin_popcount(_mm512_cmple_epi32_mask(_mm512_loadu_si512(keys+i), vbound));
+
+    return result;
+}
+
+
+SCAN_TARGET_AVX512 inline RecordId xorLessEqualAVX512(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound)
+{
+    __m512i vbound = _mm512_set1_epi32(bound), acc = _mm512_setzero_si512();
+
+    for (size_t i = 0; i < n; i += 16)
+        acc = _mm512_mask_xor_epi32(acc, _mm512_cmple_epi32_mask(_mm512_loadu_si512(keys+i), vbound), acc, _mm512_loadu_si512(ids+i));
+
+    return reduceXorAVX512(acc);
+}
+
+
+SCAN_TARGET_AVX512 inline size_t countGreaterEqualAVX512(const Timestamp *keys, size_t n, Timestamp bound)
+{
+    __m512i vbound = _mm512_set1_epi32(bound);
+    size_t result = 0;
+
+    for (size_t i = 0; i < n; i += 16)
+        result += __builtin_popcount(_mm512_cmpge_epi32_mask(_mm512_loadu_si512(keys+i), vbound));
+
+    return result;
+}
+
+
+SCAN_TARGET_AVX512 inline RecordId xorGreaterEqualAVX512(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound)
+{
+    __m512i vbound = _mm512_set1_epi32(bound), acc = _mm512_setzero_si512();
+
+    for (size_t i = 0; i < n; i += 16)
+        acc = _mm512_mask_xor_epi32(acc, _mm512_cmpge_epi32_mask(_mm512_loadu_si512(keys+i), vbound), acc, _mm512_loadu_si512(ids+i));
+
+    return reduceXorAVX512(acc);
+}
+
+
+SCAN_TARGET_AVX512 inline size_t countOverlapAVX512(const Timestamp *starts, const Timestamp *ends, size_t n, Timestamp qstart, Timestamp qend)
+{
+    __m512i vqstart = _mm512_set1_epi32(qstart), vqend = _mm512_set1_epi32(qend);
+    size_t result = 0;
+
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __mmask16 m = _mm512_cmple_epi32_mask(_mm512_loadu_si512(starts+i), vqend);
+        result += __builtin_popcount(_mm512_mask_cmpge_epi32_mask(m, _mm512_loadu_si512(ends+i), vqstart));
+    }
+
+    return result;
+}
+
+
+SCAN_TARGET_AVX512 inline RecordId xorOverlapAVX512(const Timestamp *starts, const Timestamp *ends, const RecordId *ids, size_t n, Timestamp qstart, Timestamp qend)
+{
+    __m512i vqstart = _mm512_set1_epi32(qstart), vqend = _mm512_set1_epi32(qend), acc = _mm512_setzero_si512();
+
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __mmask16 m = _mm512_cmple_epi32_mask(_mm512_loadu_si512(starts+i), vqend);
+        m = _mm512_mask_cmpge_epi32_mask(m, _mm512_loadu_si512(ends+i), vqstart);
+        acc = _mm512_mask_xor_epi32(acc, m, acc, _mm512_loadu_si512(ids+i));
+    }
+
+    return reduceXorAVX512(acc);
+}
+
+
+
+// AVX2: same, n a multiple of 8
+SCAN_TARGET_AVX2 inline RecordId reduceXorAVX2(__m256i acc)
+{
+    __m128i y = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+
+    y = _mm_xor_si128(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2)));
+    y = _mm_xor_si128(y, _mm_shuffle_epi32(y, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(y);
+}
+
+
+// AVX2 has only a signed greater-than; all masks below are built from it (lanes set to all ones when true)
+SCAN_TARGET_AVX2 inline __m256i maskLessEqual(__m256i keys, __m256i vbound)
+{
+    return _mm256_andnot_si256(_mm256_cmpgt_epi32(keys, vbound), _mm256_set1_epi32(-1));
+}
+
+
+SCAN_TARGET_AVX2 inline __m256i maskGreaterEqual(__m256i keys, __m256i vbound)
+{
+    return _mm256_andnot_si256(_mm256_cmpgt_epi32(vbound, keys), _mm256_set1_epi32(-1));
+}
+
+
+SCAN_TARGET_AVX2 inline size_t countMask(__m256i mask)
+{
+    return __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+}
+
+
+SCAN_TARGET_AVX2 inline size_t countLessEqualAVX2(const Timestamp *keys, size_t n, Timestamp bound)
+{
+    __m256i vbound = _mm256_set1_epi32(bound);
+    size_t result = 0;
+
+    for (size_t i = 0; i < n; i += 8)
+        result += 8-countMask(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(keys+i)), vbound));
+
+    return result;
+}
+
+
+SCAN_TARGET_AVX2 inline RecordId xorLessEqualAVX2(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound)
+{
+    __m256i vbound = _mm256_set1_epi32(bound), acc = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256i gt = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(keys+i)), vbound);
+        acc = _mm256_xor_si256(acc, _mm256_andnot_si256(gt, _mm256_loadu_si256((const __m256i*)(ids+i))));
+    }
+
+    return reduceXorAVX2(acc);
+}
+
+
+SCAN_TARGET_AVX2 inline size_t countGreaterEqualAVX2(const Timestamp *keys, size_t n, Timestamp bound)
+{
+    __m256i vbound = _mm256_set1_epi32(bound);
+    size_t result = 0;
+
+    for (size_t i = 0; i < n; i += 8)
+        result += 8-countMask(_mm256_cmpgt_epi32(vbound, _mm256_loadu_si256((const __m256i*)(keys+i))));
+
+    return result;
+}
+
+
+SCAN_TARGET_AVX2 inline RecordId xorGreaterEqualAVX2(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound)
+{
+    __m256i vbound = _mm256_set1_epi32(bound), acc = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256i lt = _mm256_cmpgt_epi32(vbound, _mm256_loadu_si256((const __m256i*)(keys+i)));
+        acc = _mm256_xor_si256(acc, _mm256_andnot_si256(lt, _mm256_loadu_si256((const __m256i*)(ids+i))));
+    }
+
+    return reduceXorAVX2(acc);
+}
+
+
+SCAN_TARGET_AVX2 inline size_t countOverlapAVX2(const Timestamp *starts, const Timestamp *ends, size_t n, Timestamp qstart, Timestamp qend)
+{
+    __m256i vqstart = _mm256_set1_epi32(qstart), vqend = _mm256_set1_epi32(qend);
+    size_t result = 0;
+
+    for (size_t i = 0; i < n; i += 8)
+        result += countMask(_mm256_and_si256(maskLessEqual(_mm256_loadu_si256((const __m256i*)(starts+i)), vqend), maskGreaterEqual(_mm256_loadu_si256((const __m256i*)(ends+i)), vqstart)));
+
+    return result;
+}
+
+
+SCAN_TARGET_AVX2 inline RecordId xorOverlapAVX2(const Timestamp *starts, const Timestamp *ends, const RecordId *ids, size_t n, Timestamp qstart, Timestamp qend)
+{
+    __m256i vqstart = _mm256_set1_epi32(qstart), vqend = _mm256_set1_epi32(qend), acc = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256i m = _mm256_and_si256(maskLessEqual(_mm256_loadu_si256((const __m256i*)(starts+i)), vqend), maskGreaterEqual(_mm256_loadu_si256((const __m256i*)(ends+i)), vqstart));
+        acc = _mm256_xor_si256(acc, _mm256_and_si256(m, _mm256_loadu_si256((const __m256i*)(ids+i))));
+    }
+
+    return reduceXorAVX2(acc);
+}
+#endif
+
+
+
+// The kernels the CPU supports, detected once
+inline int getScanLevel()
+{
+#if defined(__AVX512F__)
+    return SCAN_LEVEL_AVX512;
+#elif defined(SCAN_KERNELS_X86)
+    static const int level = (__builtin_cpu_init(), __builtin_cpu_supports("avx512f"))? SCAN_LEVEL_AVX512: (__builtin_cpu_supports("avx2"))? SCAN_LEVEL_AVX2: SCAN_LEVEL_SCALAR;
+
+    return level;
+#else
+    return SCAN_LEVEL_SCALAR;
+#endif
+}
+
+
+// Entries covered by the SIMD kernels of the CPU, i.e., n rounded down to a multiple of their lanes
+inline size_t getScanPrefix(int level, size_t n)
+{
+    switch (level)
+    {
+        case SCAN_LEVEL_AVX512: return n & ~(size_t)15;
+        case SCAN_LEVEL_AVX2:   return n & ~(size_t)7;
+        default:                return 0;
+    }
+}
+
+
+inline void scanLessEqual(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound, CountSink &sink)
+{
+    int level = getScanLevel();
+    size_t i = getScanPrefix(level, n);
+
+#ifdef SCAN_KERNELS_X86
+    if (level == SCAN_LEVEL_AVX512)
+        sink.result += countLessEqualAVX512(keys, i, bound);
+    else if (level == SCAN_LEVEL_AVX2)
+        sink.result += countLessEqualAVX2(keys, i, bound);
+#endif
+    scanLessEqual<CountSink>(keys+i, ids+i, n-i, bound, sink);
+}
+
+
+inline void scanLessEqual(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound, XorSink &sink)
+{
+    int level = getScanLevel();
+    size_t i = getScanPrefix(level, n);
+
+#ifdef SCAN_KERNELS_X86
+    if (level == SCAN_LEVEL_AVX512)
+        sink.add(xorLessEqualAVX512(keys, ids, i, bound));
+    else if (level == SCAN_LEVEL_AVX2)
+        sink.add(xorLessEqualAVX2(keys, ids, i, bound));
+#endif
+    scanLessEqual<XorSink>(keys+i, ids+i, n-i, bound, sink);
+}
+
+
+inline void scanGreaterEqual(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound, CountSink &sink)
+{
+    int level = getScanLevel();
+    size_t i = getScanPrefix(level, n);
+
+#ifdef SCAN_KERNELS_X86
+    if (level == SCAN_LEVEL_AVX512)
+        sink.result += countGreaterEqualAVX512(keys, i, bound);
+    else if (level == SCAN_LEVEL_AVX2)
+        sink.result += countGreaterEqualAVX2(keys, i, bound);
+#endif
+    scanGreaterEqual<CountSink>(keys+i, ids+i, n-i, bound, sink);
+}
+
+
+inline void scanGreaterEqual(const Timestamp *keys, const RecordId *ids, size_t n, Timestamp bound, XorSink &sink)
+{
+    int level = getScanLevel();
+    size_t i = getScanPrefix(level, n);
+
+#ifdef SCAN_KERNELS_X86
+    if (level == SCAN_LEVEL_AVX512)
+        sink.add(xorGreaterEqualAVX512(keys, ids, i, bound));
+    else if (level == SCAN_LEVEL_AVX2)
+        sink.add(xorGreaterEqualAVX2(keys, ids, i, bound));
+#endif
+    scanGreaterEqual<XorSink>(keys+i, ids+i, n-i, bound, sink);
+}
+
+
+inline void scanOverlap(const Timestamp *starts, const Timestamp *ends, const RecordId *ids, size_t n, Timestamp qstart, Timestamp qend, CountSink &sink)
+{
+    int level = getScanLevel();
+    size_t i = getScanPrefix(level, n);
+
+#ifdef SCAN_KERNELS_X86
+    if (level == SCAN_LEVEL_AVX512)
+        sink.result += countOverlapAVX512(starts, ends, i, qstart, qend);
+    else if (level == SCAN_LEVEL_AVX2)
+        sink.result += countOverlapAVX2(starts, ends, i, qstart, qend);
+#endif
+    scanOverlap<CountSink>(starts+i, ends+i, ids+i, n-i, qstart, qend, sink);
+}
+
+
+inline void scanOverlap(const Timestamp *starts, const Timestamp *ends, const RecordId *ids, size_t n, Timestamp qstart, Timestamp qend, XorSink &sink)
+{
+    int level = getScanLevel();
+    size_t i = getScanPrefix(level, n);
+
+#ifdef SCAN_KERNELS_X86
+    if (level == SCAN_LEVEL_AVX512)
+        sink.add(xorOverlapAVX512(starts, ends, ids, i, qstart, qend));
+    else if (level == SCAN_LEVEL_AVX2)
+        sink.add(xorOverlapAVX2(starts, ends, ids, i, qstart, qend));
+#endif
+    scanOverlap<XorSink>(starts+i, ends+i, ids+i, n-i, qstart, qend, sink);
+}
+#endif // _SCAN_KERNELS_H_
@@ -0,0 +1,104 @@
+#include "segment.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+
+
+// Writes the whole buffer, resuming after partial writes
+static bool writeAll(int fd, const void *data, size_t bytes)
+{
+    const char *p = (const char*)data;
+
+    while (bytes > 0)
+    {
+        ssize_t n = write(fd, p, bytes);
+
+        if (n <= 0)
+            return false;
+        p += n;
+        bytes -= n;
+    }
+
+    return true;
+}
+
+
+// The ids and the endpoints point to the first entry of the partitions, i.e., to position offsets[0] of the columns
+Segment::Segment(const char *directory, size_t firstPartition, size_t numPartitions, const size_t *offsets, const RecordId *ids, const Timestamp *starts, const Timestamp *ends)
+{
+    string filename = string(directory) + "/" + SEGMENT_FILE_TEMPLATE;
+    size_t numEntries = offsets[numPartitions]-offsets[0];
+    vector<size_t> rebased(offsets, offsets+numPartitions+1);
+    bool written;
+    int fd;
+
+
+    this->mapping     = NULL;
+    this->mappingSize = 0;
+    this->firstPartition = firstPartition;
+    this->numPartitions  = numPartitions;
+    this->offsets = NULL;
+    this->ids     = NULL;
+    this->starts  = this->ends = NULL;
+
+    fd = mkstemp(&filename[0]);
+    if (fd < 0)
+        return;
+
+    for (auto &o : rebased)
+        o -= offsets[0];
+    written = writeAll(fd, rebased.data(), rebased.size()*sizeof(size_t)) && writeAll(fd, ids, numEntries*sizeof(RecordId));
+    if ((written) && (starts != NULL))
+        written = writeAll(fd, starts, numEntries*sizeof(Timestamp));
+    if ((written) && (ends != NULL))
+        written = writeAll(fd, ends, numEntries*sizeof(Timestamp));
+    unlink(filename.c_str());
+    if (!written)
+    {
+        ::close(fd);
+        return;
+    }
+
+    this->mappingSize = rebased.size()*sizeof(size_t) + numEntries*(sizeof(RecordId) + ((starts != NULL) + (ends != NULL))*sizeof(Timestamp));
+    this->mapping = mmap(NULL, this->mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (this->mapping == MAP_FAILED)
+    {
+        this->mapping = NULL;
+        this->mappingSize = 0;
+        return;
+    }
+
+    char *column = (char*)this->mapping;
+
+    this->offsets = (const size_t*)column;
+    column += rebased.size()*sizeof(size_t);
+    this->ids = (const RecordId*)column;
+    column += numEntries*sizeof(RecordId);
+    if (starts != NULL)
+    {
+        this->starts = (const Timestamp*)column;
+        column += numEntries*sizeof(Timestamp);
+    }
+    if (ends != NULL)
+        this->ends = (const Timestamp*)column;
+}
+
+
+bool Segment::isOpen()
+{
+    return (this->mapping != NULL);
+}
+
+
+size_t Segment::getFileSize()
+{
+    return this->mappingSize;
+}
+
+
+Segment::~Segment()
+{
+    if (this->mapping != NULL)
+        munmap(this->mapping, this->mappingSize);
+}
@@ -0,0 +1,31 @@
+#ifndef _SEGMENT_H_
+#define _SEGMENT_H_
+
+#include "../def_global.h"
+
+#define SEGMENT_FILE_TEMPLATE   "lit_segment_XXXXXX"
+
+
+
+// A run of sealed, consecutive partitions of a PartitionStore, written to a file in the cold storage directory and
+// served back read-only through mmap, so that the page cache decides what stays resident. The file holds the
+// offsets, rebased to 0, then the ids and the kept endpoints, column after column; it is unlinked as soon as it is
+// mapped, so that it goes away with the segment, also if the process dies.
+class Segment
+{
+private:
+    void *mapping;
+    size_t mappingSize;
+
+public:
+    size_t firstPartition, numPartitions;
+    const size_t    *offsets;       // numPartitions+1 of them
+    const RecordId  *ids;
+    const Timestamp *starts, *ends; // NULL if not kept
+
+    Segment(const char *directory, size_t firstPartition, size_t numPartitions, const size_t *offsets, const RecordId *ids, const Timestamp *starts, const Timestamp *ends);
+    bool isOpen();
+    size_t getFileSize();
+    ~Segment();
+};
+#endif // _SEGMENT_H_
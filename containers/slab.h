@@ -0,0 +1,164 @@
+#ifndef _SLAB_H_
+#define _SLAB_H_
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <mutex>
+#include <map>
+#include <vector>
+
+#define SLAB_CHUNK_SIZE (4 << 20)       // Bytes allocated at once per block size, or a single larger block
+
+
+
+// Fixed-size block allocator: blocks are carved from chunks of SLAB_CHUNK_SIZE bytes and a released block is kept
+// on a free list for the next request, i.e., a structure that is repeatedly created and destroyed with the same
+// size (e.g., the buffers of a LIVE INDEX) reuses its memory instead of going through malloc every time. One
+// allocator per block size, shared by all threads. Neither the chunks nor the allocators are ever freed, so the
+// blocks released to the allocator of a size no longer requested, e.g., after the tuner changed the capacity of
+// the buffers, stay reserved until the process exits.
+class SlabAllocator
+{
+private:
+    size_t blockSize, blocksPerChunk;
+    std::vector<char*> chunks;
+    std::vector<void*> freeBlocks;
+    char *nextBlock, *chunkEnd;
+    size_t numInUse, numRecycled;
+    std::mutex lock;
+
+    SlabAllocator(size_t blockSize)
+    {
+        this->blockSize      = (blockSize+63) & ~(size_t)63;     // Keeps the blocks cache-line aligned
+        this->blocksPerChunk = std::max((size_t)1, (size_t)SLAB_CHUNK_SIZE/this->blockSize);
+        this->nextBlock = this->chunkEnd = NULL;
+        this->numInUse = this->numRecycled = 0;
+    };
+
+    struct Registry
+    {
+        std::mutex lock;
+        std::map<size_t, SlabAllocator*> allocators;
+    };
+
+    static Registry& getRegistry()
+    {
+        static Registry registry;
+
+        return registry;
+    };
+
+public:
+    static SlabAllocator* get(size_t blockSize)
+    {
+        Registry &registry = getRegistry();
+        std::lock_guard<std::mutex> guard(registry.lock);
+        auto iter = registry.allocators.find(blockSize);
+
+        if (iter == registry.allocators.end())
+            iter = registry.allocators.emplace(blockSize, new SlabAllocator(blockSize)).first;
+
+        return iter->second;
+    };
+
+    void* allocate()
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        void *block;
+
+        if (!this->freeBlocks.empty())
+        {
+            block = this->freeBlocks.back();
+            this->freeBlocks.pop_back();
+            this->numInUse++;
+            this->numRecycled++;
+
+            return block;
+        }
+
+        if (this->nextBlock == this->chunkEnd)
+        {
+            void *chunk;
+
+            // Callers cannot recover, e.g., the hash maps clear their blocks right away
+            if (posix_memalign(&chunk, 64, this->blocksPerChunk*this->blockSize) != 0)
+            {
+                std::cerr << std::endl << "Error - cannot allocate a chunk of " << this->blocksPerChunk*this->blockSize << " bytes for blocks of " << this->blockSize << " bytes" << std::endl << std::endl;
+                std::exit(1);
+            }
+            this->nextBlock = static_cast<char*>(chunk);
+            this->chunkEnd  = this->nextBlock + this->blocksPerChunk*this->blockSize;
+            this->chunks.push_back(this->nextBlock);
+        }
+        block = this->nextBlock;
+        this->nextBlock += this->blockSize;
+        this->numInUse++;
+
+        return block;
+    };
+
+    void release(void *block)
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        this->freeBlocks.push_back(block);
+        this->numInUse--;
+    };
+
+    size_t getNumInUse()
+    {
+        return this->numInUse;
+    };
+
+    size_t getNumRecycled()
+    {
+        return this->numRecycled;
+    };
+
+    // Reserved from the system, whether in use or not
+    size_t getMemoryUsage()
+    {
+        return this->chunks.size()*this->blocksPerChunk*this->blockSize;
+    };
+
+    static size_t getTotalMemoryUsage()
+    {
+        Registry &registry = getRegistry();
+        std::lock_guard<std::mutex> guard(registry.lock);
+        size_t bytes = 0;
+
+        for (auto &entry : registry.allocators)
+            bytes += entry.second->getMemoryUsage();
+
+        return bytes;
+    };
+};
+
+
+
+template<typename T>
+T* slab_malloc(size_t size) noexcept
+{
+	return static_cast<T*>(SlabAllocator::get(size*sizeof(T))->allocate());
+}
+
+
+template<typename T>
+T* slab_calloc(size_t size) noexcept
+{
+	T *block = slab_malloc<T>(size);
+
+	std::memset(block, 0, size*sizeof(T));
+	return block;
+}
+
+
+// size must be the one the block was allocated with
+template<typename T>
+void slab_free(T *block, size_t size) noexcept
+{
+	SlabAllocator::get(size*sizeof(T))->release(block);
+}
+#endif // _SLAB_H_
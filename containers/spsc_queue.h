@@ -0,0 +1,97 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include "../def_global.h"
+#include "Util.h"
+#include <atomic>
+#include <thread>
+
+#define CACHE_LINE_SIZE 64
+
+
+
+// Bounded lock-free ring buffer for one producer and one consumer thread; the capacity is rounded up to a power
+// of two. The two indices live on separate cache lines, and each side caches the index of the other side so
+// that it reads the shared one only when the queue looks full (producer) or empty (consumer).
+template <class T>
+class SPSCQueue
+{
+private:
+    vector<T> slots;
+    size_t mask;
+
+    alignas(CACHE_LINE_SIZE) atomic<size_t> head;   // Next slot to pop; written by the consumer
+    size_t cachedTail;
+    alignas(CACHE_LINE_SIZE) atomic<size_t> tail;   // Next slot to push; written by the producer
+    size_t cachedHead;
+
+public:
+    SPSCQueue(size_t capacity) : slots(next_power_of_two(max(capacity, (size_t)2))), head(0), tail(0)
+    {
+        this->mask = this->slots.size()-1;
+        this->cachedTail = 0;
+        this->cachedHead = 0;
+    };
+
+
+    bool tryPush(const T &item)
+    {
+        size_t t = this->tail.load(memory_order_relaxed);
+
+        if (t-this->cachedHead == this->slots.size())
+        {
+            this->cachedHead = this->head.load(memory_order_acquire);
+            if (t-this->cachedHead == this->slots.size())
+                return false;
+        }
+        this->slots[t & this->mask] = item;
+        this->tail.store(t+1, memory_order_release);
+
+        return true;
+    };
+
+
+    // Spins while the queue is full
+    void push(const T &item)
+    {
+        while (!this->tryPush(item))
+            this_thread::yield();
+    };
+
+
+    bool pop(T &item)
+    {
+        size_t h = this->head.load(memory_order_relaxed);
+
+        if (h == this->cachedTail)
+        {
+            this->cachedTail = this->tail.load(memory_order_acquire);
+            if (h == this->cachedTail)
+                return false;
+        }
+        item = this->slots[h & this->mask];
+        this->head.store(h+1, memory_order_release);
+
+        return true;
+    };
+
+
+    // Exact only when called by the consumer, or by the producer while the consumer is idle
+    bool empty()
+    {
+        return (this->head.load(memory_order_acquire) == this->tail.load(memory_order_acquire));
+    };
+
+
+    size_t getCapacity()
+    {
+        return this->slots.size();
+    };
+
+
+    size_t getMemoryUsage()
+    {
+        return sizeof(SPSCQueue<T>) + this->slots.capacity()*sizeof(T);
+    };
+};
+#endif // _SPSC_QUEUE_H_
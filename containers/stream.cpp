@@ -0,0 +1,239 @@
+#include "stream.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+
+Stream::Stream(const char *filename)
+{
+    this->entries    = NULL;
+    this->entriesEnd = NULL;
+    this->iterEntry  = NULL;
+    this->mapping    = NULL;
+    this->mappingSize = 0;
+    this->binary     = false;
+    this->opened     = false;
+
+    if (this->mapBinary(filename))
+    {
+        this->binary = true;
+        this->opened = true;
+    }
+    else
+    {
+        this->fText.open(filename);
+        this->opened = (bool)this->fText;
+    }
+}
+
+
+// Maps the file if it starts with the binary stream header; returns false otherwise so that the caller falls back to text.
+bool Stream::mapBinary(const char *filename)
+{
+    struct stat st;
+    StreamHeader *header;
+    int fd = open(filename, O_RDONLY);
+
+
+    if (fd < 0)
+        return false;
+
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(StreamHeader)))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    this->mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (this->mapping == MAP_FAILED)
+    {
+        this->mapping = NULL;
+        return false;
+    }
+    this->mappingSize = st.st_size;
+
+    header = (StreamHeader*)this->mapping;
+    if ((memcmp(header->magic, STREAM_BINARY_MAGIC, STREAM_BINARY_MAGIC_LEN) != 0) || (header->numEntries > (this->mappingSize-sizeof(StreamHeader))/sizeof(StreamEntry)))
+    {
+        munmap(this->mapping, this->mappingSize);
+        this->mapping = NULL;
+        this->mappingSize = 0;
+        return false;
+    }
+    madvise(this->mapping, this->mappingSize, MADV_SEQUENTIAL);
+
+    this->entries    = (const StreamEntry*)((char*)this->mapping + sizeof(StreamHeader));
+    this->entriesEnd = this->entries + header->numEntries;
+    this->iterEntry  = this->entries;
+
+    return true;
+}
+
+
+bool Stream::isOpen()
+{
+    return this->opened;
+}
+
+
+bool Stream::isBinary()
+{
+    return this->binary;
+}
+
+
+bool Stream::next(char &operation, Timestamp &first, Timestamp &second, double &third, double &fourth)
+{
+    if (this->binary)
+    {
+        if (this->iterEntry == this->entriesEnd)
+            return false;
+
+        operation = this->iterEntry->operation;
+        first     = this->iterEntry->first;
+        second    = this->iterEntry->second;
+        third     = this->iterEntry->third;
+        fourth    = this->iterEntry->fourth;
+        this->iterEntry++;
+
+        return true;
+    }
+    else
+        return (bool)(this->fText >> operation >> first >> second >> third >> fourth);
+}
+
+
+void Stream::rewind()
+{
+    if (this->binary)
+        this->iterEntry = this->entries;
+    else
+    {
+        this->fText.clear();
+        this->fText.seekg(0);
+    }
+}
+
+
+void Stream::close()
+{
+    if (this->mapping != NULL)
+    {
+        munmap(this->mapping, this->mappingSize);
+        this->mapping = NULL;
+        this->mappingSize = 0;
+        this->entries = this->entriesEnd = this->iterEntry = NULL;
+    }
+    if (this->fText.is_open())
+        this->fText.close();
+    this->opened = false;
+}
+
+
+Stream::~Stream()
+{
+    this->close();
+}
+
+
+const StreamEntry* Stream::begin()
+{
+    return this->entries;
+}
+
+
+const StreamEntry* Stream::end()
+{
+    return this->entriesEnd;
+}
+
+
+size_t Stream::size()
+{
+    return this->entriesEnd-this->entries;
+}
+
+
+size_t Stream::load(vector<StreamEntry> &stream)
+{
+    StreamEntry e;
+    size_t numEntries = 0;
+
+
+    if (this->binary)
+    {
+        stream.insert(stream.end(), this->iterEntry, this->entriesEnd);
+        numEntries = this->entriesEnd-this->iterEntry;
+        this->iterEntry = this->entriesEnd;
+
+        return numEntries;
+    }
+
+    memset(&e, 0, sizeof(StreamEntry));
+    while (this->next(e.operation, e.first, e.second, e.third, e.fourth))
+    {
+        stream.push_back(e);
+        numEntries++;
+    }
+
+    return numEntries;
+}
+
+
+// Converts a text .mix stream into the binary format: a StreamHeader followed by fixed-width StreamEntry records.
+bool Stream::convert(const char *textFilename, const char *binaryFilename, size_t &numEntries)
+{
+    ifstream fIn(textFilename);
+    FILE *fOut;
+    StreamHeader header;
+    StreamEntry e;
+    char operation;
+    Timestamp first, second;
+    double third, fourth;
+
+
+    numEntries = 0;
+    if (!fIn)
+        return false;
+
+    fOut = fopen(binaryFilename, "wb");
+    if (fOut == NULL)
+        return false;
+
+    // Header is rewritten once the number of entries is known.
+    memset(&header, 0, sizeof(StreamHeader));
+    memcpy(header.magic, STREAM_BINARY_MAGIC, STREAM_BINARY_MAGIC_LEN);
+    if (fwrite(&header, sizeof(StreamHeader), 1, fOut) != 1)
+    {
+        fclose(fOut);
+        return false;
+    }
+
+    memset(&e, 0, sizeof(StreamEntry));
+    while (fIn >> operation >> first >> second >> third >> fourth)
+    {
+        e.operation = operation;
+        e.first     = first;
+        e.second    = second;
+        e.third     = third;
+        e.fourth    = fourth;
+        if (fwrite(&e, sizeof(StreamEntry), 1, fOut) != 1)
+        {
+            fclose(fOut);
+            return false;
+        }
+        numEntries++;
+    }
+
+    // A stale count would make readers stop early or read past the entries, so every step must succeed
+    header.numEntries = numEntries;
+    if ((fseek(fOut, 0, SEEK_SET) != 0) || (fwrite(&header, sizeof(StreamHeader), 1, fOut) != 1))
+    {
+        fclose(fOut);
+        return false;
+    }
+
+    return (fclose(fOut) == 0);
+}
@@ -0,0 +1,67 @@
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include "../def_global.h"
+#include <cstdint>
+
+#define STREAM_BINARY_MAGIC     "LITSTRM1"
+#define STREAM_BINARY_MAGIC_LEN 8
+
+
+
+// One update/query operation; fixed-width image of a line "<op> <first> <second> <third> <fourth>" in a .mix file
+struct StreamEntry
+{
+    char      operation;
+    char      padding[3];
+    Timestamp first;
+    Timestamp second;
+    int       reserved;
+    double    third;
+    double    fourth;
+};
+
+struct StreamHeader
+{
+    char     magic[STREAM_BINARY_MAGIC_LEN];
+    uint64_t numEntries;
+};
+
+
+
+// Reads a stream either from a binary file (memory-mapped, zero-copy) or, as a fallback, from a text .mix file
+class Stream
+{
+private:
+    ifstream fText;
+    const StreamEntry *entries;
+    const StreamEntry *entriesEnd;
+    const StreamEntry *iterEntry;
+    void *mapping;
+    size_t mappingSize;
+    bool binary;
+    bool opened;
+
+    bool mapBinary(const char *filename);
+
+public:
+    Stream(const char *filename);
+    bool isOpen();
+    bool isBinary();
+    bool next(char &operation, Timestamp &first, Timestamp &second, double &third, double &fourth);
+    void rewind();
+    void close();
+    ~Stream();
+
+    // Direct access to the mapped entries; valid only for binary streams
+    const StreamEntry* begin();
+    const StreamEntry* end();
+    size_t size();
+
+    // Copies the remaining operations into memory, e.g., to replay the same stream several times
+    size_t load(vector<StreamEntry> &stream);
+
+    // Conversion
+    static bool convert(const char *textFilename, const char *binaryFilename, size_t &numEntries);
+};
+#endif // _STREAM_H_
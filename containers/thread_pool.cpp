@@ -0,0 +1,183 @@
+#include "thread_pool.h"
+
+
+
+thread_local ThreadPool* ThreadPool::localPool  = NULL;
+thread_local size_t      ThreadPool::localQueue = 0;
+
+
+ThreadPool::ThreadPool(size_t numThreads)
+{
+    this->stopping = false;
+    this->numPending = 0;
+    this->nextQueue = 0;
+    for (auto i = 0; i < numThreads; i++)
+        this->queues.push_back(new WorkQueue());
+    for (auto i = 0; i < numThreads; i++)
+        this->workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+
+// Newest task of deque q
+bool ThreadPool::popTask(size_t q, function<void()> &task)
+{
+    lock_guard<mutex> guard(this->queues[q]->lock);
+
+    if (this->queues[q]->tasks.empty())
+        return false;
+    task = move(this->queues[q]->tasks.back());
+    this->queues[q]->tasks.pop_back();
+    this->numPending--;
+
+    return true;
+}
+
+
+// Oldest task of any deque other than q, visited round-robin starting after q
+bool ThreadPool::stealTask(size_t q, function<void()> &task)
+{
+    auto numQueues = this->queues.size();
+
+    for (auto i = 1; i <= numQueues; i++)
+    {
+        WorkQueue *victim = this->queues[(q+i) % numQueues];
+        lock_guard<mutex> guard(victim->lock);
+
+        if (!victim->tasks.empty())
+        {
+            task = move(victim->tasks.front());
+            victim->tasks.pop_front();
+            this->numPending--;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void ThreadPool::run(size_t q)
+{
+    function<void()> task;
+
+    localPool  = this;
+    localQueue = q;
+    while (true)
+    {
+        if (this->popTask(q, task) || this->stealTask(q, task))
+        {
+            task();
+            continue;
+        }
+
+        unique_lock<mutex> guard(this->lock);
+
+        this->wakeup.wait(guard, [this] { return (this->stopping || this->numPending > 0); });
+        if (this->stopping && this->numPending == 0)
+            return;
+    }
+}
+
+
+void ThreadPool::push(function<void()> task)
+{
+    size_t q = (localPool == this)? localQueue: (this->nextQueue++ % this->queues.size());
+
+    {
+        lock_guard<mutex> guard(this->queues[q]->lock);
+        this->queues[q]->tasks.push_back(move(task));
+        this->numPending++;
+    }
+
+    // Taking the lock orders the push before the predicate check of a worker going to sleep
+    {
+        lock_guard<mutex> guard(this->lock);
+    }
+    this->wakeup.notify_one();
+}
+
+
+// Queues the task; the returned future is ready once it has been executed.
+future<void> ThreadPool::submit(function<void()> task)
+{
+    auto packaged = make_shared<packaged_task<void()> >(move(task));
+    future<void> done = packaged->get_future();
+
+    this->push([packaged] { (*packaged)(); });
+
+    return done;
+}
+
+
+// Executes one pending task on the calling thread; returns false if there was none.
+bool ThreadPool::runPendingTask()
+{
+    function<void()> task;
+    size_t q = (localPool == this)? localQueue: 0;
+
+    if (((localPool == this) && this->popTask(q, task)) || this->stealTask(q, task))
+    {
+        task();
+        return true;
+    }
+
+    return false;
+}
+
+
+size_t ThreadPool::getNumThreads()
+{
+    return this->workers.size();
+}
+
+
+// Pending tasks are still executed before the workers exit.
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(this->lock);
+        this->stopping = true;
+    }
+    this->wakeup.notify_all();
+
+    for (auto &w : this->workers)
+        w.join();
+    for (auto q : this->queues)
+        delete q;
+}
+
+
+
+TaskGroup::TaskGroup(ThreadPool *pool)
+{
+    this->pool = pool;
+    this->numRunning = 0;
+}
+
+
+void TaskGroup::run(function<void()> task)
+{
+    this->numRunning++;
+    this->pool->push([this, task]
+    {
+        task();
+        this->numRunning--;
+    });
+}
+
+
+void TaskGroup::wait()
+{
+    while (this->numRunning > 0)
+    {
+        if (!this->pool->runPendingTask())
+            this_thread::yield();
+    }
+}
+
+
+TaskGroup::~TaskGroup()
+{
+    this->wait();
+}
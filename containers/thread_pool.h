@@ -0,0 +1,68 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include "../def_global.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <deque>
+#include <atomic>
+
+
+
+// Fixed set of persistent worker threads, created once per run so that dispatching a query part costs a queue
+// push and a wakeup, not a thread creation. Work stealing: every worker owns a deque; tasks pushed by a worker
+// go to its own deque and are taken back LIFO, other tasks are spread round-robin, and a worker with an empty
+// deque steals the oldest task of another.
+class ThreadPool
+{
+private:
+    struct WorkQueue
+    {
+        mutex lock;
+        deque<function<void()> > tasks;
+    };
+
+    vector<thread> workers;
+    vector<WorkQueue*> queues;
+    atomic<size_t> numPending;
+    atomic<size_t> nextQueue;
+    mutex lock;
+    condition_variable wakeup;
+    bool stopping;
+
+    static thread_local ThreadPool *localPool;
+    static thread_local size_t localQueue;
+
+    bool popTask(size_t q, function<void()> &task);
+    bool stealTask(size_t q, function<void()> &task);
+    void run(size_t q);
+
+public:
+    ThreadPool(size_t numThreads);
+    void push(function<void()> task);
+    future<void> submit(function<void()> task);
+    bool runPendingTask();
+    size_t getNumThreads();
+    ~ThreadPool();
+};
+
+
+
+// Tasks awaited together; the waiting thread executes pending tasks of the pool instead of blocking, so groups
+// may be opened from inside a pool task.
+class TaskGroup
+{
+private:
+    ThreadPool *pool;
+    atomic<size_t> numRunning;
+
+public:
+    TaskGroup(ThreadPool *pool);
+    void run(function<void()> task);
+    void wait();
+    ~TaskGroup();
+};
+#endif // _THREAD_POOL_H_
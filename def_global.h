@@ -20,9 +20,14 @@
 using namespace std;
 
 
-// Comment out the following for XOR workload
+// Comment out the following for XOR workload; sets the default workload, which can be overriden at runtime
 // #define WORKLOAD_COUNT
 
+// Workloads, i.e., what a query reports: the number of qualifying records, the XOR of their ids or the ids themselves
+#define WORKLOAD_MODE_COUNT 0
+#define WORKLOAD_MODE_XOR   1
+#define WORKLOAD_MODE_IDS   2
+
 // Basic predicates of Allen's algebra
 #define PREDICATE_EQUALS     1
 #define PREDICATE_STARTS     2
@@ -85,6 +90,7 @@ struct RunSettings
 	bool         isAutoTuned;
 	unsigned int numRuns;
     unsigned int typeOptimizations;
+    unsigned int typeWorkload;
 	
 	void init()
 	{
@@ -94,6 +100,11 @@ struct RunSettings
 		isAutoTuned       = false;
 		numRuns           = 1;
         typeOptimizations = 0;
+#ifdef WORKLOAD_COUNT
+        typeWorkload      = WORKLOAD_MODE_COUNT;
+#else
+        typeWorkload      = WORKLOAD_MODE_XOR;
+#endif
 	};
 };
 
@@ -132,6 +143,163 @@ struct RangeQuery
 };
 
 
+// Result sinks: collect the records that qualify a query. Query methods are templated on the sink, so that
+// every workload gets its own loop; e.g., counting never reads the ids and never branches on a comparison.
+struct CountSink
+{
+    size_t result;
+
+    CountSink()
+    {
+        result = 0;
+    };
+    inline void add(RecordId id)
+    {
+        result++;
+    };
+    inline void addIf(bool qualifies, RecordId id)
+    {
+        result += qualifies;
+    };
+    template <class Iterator> inline void addAll(Iterator first, Iterator last)
+    {
+        result += last-first;
+    };
+    inline void merge(const CountSink &S)
+    {
+        result += S.result;
+    };
+    inline void clear()
+    {
+        result = 0;
+    };
+    inline size_t getResult() const
+    {
+        return result;
+    };
+};
+
+struct XorSink
+{
+    size_t result;
+
+    XorSink()
+    {
+        result = 0;
+    };
+    inline void add(RecordId id)
+    {
+        result ^= id;
+    };
+    inline void addIf(bool qualifies, RecordId id)
+    {
+        result ^= (id & -(RecordId)qualifies);
+    };
+    template <class Iterator> inline void addAll(Iterator first, Iterator last)
+    {
+        for (; first != last; first++)
+            result ^= (*first);
+    };
+    inline void merge(const XorSink &S)
+    {
+        result ^= S.result;
+    };
+    inline void clear()
+    {
+        result = 0;
+    };
+    inline size_t getResult() const
+    {
+        return result;
+    };
+};
+
+struct IdSink
+{
+    vector<RecordId> &ids;      // Preallocated by the caller; qualifying ids are appended
+
+    IdSink(vector<RecordId> &ids) : ids(ids)
+    {
+    };
+    inline void add(RecordId id)
+    {
+        ids.push_back(id);
+    };
+    inline void addIf(bool qualifies, RecordId id)
+    {
+        if (qualifies)
+            ids.push_back(id);
+    };
+    template <class Iterator> inline void addAll(Iterator first, Iterator last)
+    {
+        ids.insert(ids.end(), first, last);
+    };
+    inline void merge(const IdSink &S)
+    {
+        if (&S.ids != &ids)
+            ids.insert(ids.end(), S.ids.begin(), S.ids.end());
+    };
+    inline void clear()
+    {
+        ids.clear();
+    };
+    inline size_t getResult() const
+    {
+        return ids.size();
+    };
+};
+
+// One sink per task of a parallel query, merged into the query's sink at the end; id sinks get a vector each
+template <class S>
+struct PartialSinks
+{
+    vector<S> sinks;
+
+    PartialSinks(size_t numSinks) : sinks(numSinks)
+    {
+    };
+    inline S& operator[] (size_t i)
+    {
+        return sinks[i];
+    };
+    inline void mergeInto(S &sink)
+    {
+        for (auto &s : sinks)
+            sink.merge(s);
+    };
+};
+
+template <>
+struct PartialSinks<IdSink>
+{
+    vector<vector<RecordId> > ids;
+    vector<IdSink> sinks;
+
+    PartialSinks(size_t numSinks) : ids(numSinks)
+    {
+        sinks.reserve(numSinks);
+        for (auto &v : ids)
+            sinks.emplace_back(v);
+    };
+    inline IdSink& operator[] (size_t i)
+    {
+        return sinks[i];
+    };
+    inline void mergeInto(IdSink &sink)
+    {
+        for (auto &s : sinks)
+            sink.merge(s);
+    };
+};
+
+// Sink behind the legacy size_t query methods
+#ifdef WORKLOAD_COUNT
+typedef CountSink WorkloadSink;
+#else
+typedef XorSink WorkloadSink;
+#endif
+
+
 class Timer
 {
 private:
@@ -169,5 +337,7 @@ string toUpperCase(char *buf);
 bool checkPredicate(string strPredicate, RunSettings &settings);
 bool checkAttributeConstraint(string typeSecondAttributeConstraint, RunSettings &settings);
 bool checkOptimizations(string strOptimizations, RunSettings &settings);
+bool checkWorkload(string strWorkload, RunSettings &settings);
+string getWorkloadName(unsigned int typeWorkload);
 void process_mem_usage(double& vm_usage, double& resident_set);
 #endif // _GLOBAL_DEF_H_
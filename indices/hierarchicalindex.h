@@ -34,6 +34,7 @@ public:
     HierarchicalIndex(const Relation &R, const unsigned int numBits, const unsigned int maxBits);
     virtual void print(const char c) {};
     virtual void getStats() {};
+    virtual size_t getMemoryUsage() { return 0; };
     virtual ~HierarchicalIndex() {};
     
 
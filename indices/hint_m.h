@@ -5,10 +5,16 @@
 #include "../containers/relation.h"
 #include "../containers/offsets.h"
 #include "../containers/offsets_templates.cpp"
+#include "../containers/aggregate_tree.h"
+#include "../containers/partition_store.h"
 #include "../indices/hierarchicalindex.h"
 #include <boost/dynamic_bitset.hpp>
 #include "../indices/live_index.h"
 
+#define HINT_PARALLEL_THRESHOLD 100000  // Estimated number of results from which HINT_M_Dynamic scans in parallel
+#define HINT_TASKS_PER_THREAD   4       // Tasks per thread the fully covered partitions are split into
+
+class ThreadPool;
 
 
 // Base HINT^m, no optimizations activated
@@ -538,11 +544,13 @@ public:
     HINT_M_Dynamic_Naive(Timestamp leafPartitionExtent);
     HINT_M_Dynamic_Naive(const Relation &R, const unsigned int numBits, const unsigned int maxBits);
     void getStats();
+    size_t getMemoryUsage();
     void print(char c);
     ~HINT_M_Dynamic_Naive() {};
     
     // Querying
     size_t execute_pureTimeTravel(RangeQuery Q);
+    template <class S> void execute_pureTimeTravel(RangeQuery Q, S &sink);
     
     // Updating
     void insert(const Record &r);
@@ -555,38 +563,53 @@ public:
 class HINT_M_Dynamic : public HierarchicalIndex
 {
 private:
-    vector<vector<RelationId> > pOrgsInIds;
-    vector<vector<RelationId> > pOrgsAftIds;
-    vector<vector<RelationId> > pRepsInIds;
-    vector<vector<RelationId> > pRepsAftIds;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pRepsInTimestamps;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pOrgsInTimestamps;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pOrgsAftTimestamps;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pRepsAftTimestamps;
+    // Per level, the partitions packed into flat columns, to be scanned with SIMD
+    vector<PartitionStore> pOrgsIn, pOrgsAft;
+    vector<PartitionStore> pRepsIn, pRepsAft;
+    vector<AggregateTree> pOrgsAggregates;  // Per level, count and XOR of the originals (In and Aft) of each partition
 
-    RecordId      **pOrgsIn_sizes, **pOrgsAft_sizes;
-    size_t        **pRepsIn_sizes, **pRepsAft_sizes;
+    ThreadPool *pool;               // If set, queries estimated to report at least parallelThreshold records are scanned in parallel
+    size_t parallelThreshold;
+    const char *coldDirectory;      // If set, expired partitions are sealed into segment files there instead of evicted
+    bool coldFailed;                // A segment file could not be written; the partitions not sealed by then stay in memory
     
     
     // Construction
+    void addLevels();
     inline void updatePartitions(const Record &r);
+
+    // Querying
+    template <class S> inline void scanLevel(int l, Timestamp a, Timestamp b, bool foundzero, bool foundone, RangeQuery Q, S &sink);
+    template <class S> inline void scanPartitions(int l, Timestamp from, Timestamp to, S &sink);
+    inline void scanPartitions(int l, Timestamp from, Timestamp to, CountSink &sink);
+    inline void scanPartitions(int l, Timestamp from, Timestamp to, XorSink &sink);
+    template <class S> inline void scanRoot(bool foundzero, bool foundone, RangeQuery Q, S &sink);
+    template <class S> void executeParallel_pureTimeTravel(RangeQuery Q, S &sink);
     
 public:
     // Construction
     Timestamp gstart, gend;
+    Timestamp hotStart;             // Partitions before it are sealed, with cold storage
     Timestamp leafPartitionExtent;
 
     HINT_M_Dynamic(Timestamp leafPartitionExtent);
     HINT_M_Dynamic(const Relation &R, const unsigned int numBits, const unsigned int maxBits);
+    void setParallelism(ThreadPool *pool, size_t parallelThreshold);
+    void setColdStorage(const char *directory);
+    void compact();
     void getStats();
+    size_t getMemoryUsage();
+    size_t getSegmentSize();
     void print(char c);
     ~HINT_M_Dynamic() {};
     
     // Querying
     size_t execute_pureTimeTravel(RangeQuery Q);
+    template <class S> void execute_pureTimeTravel(RangeQuery Q, S &sink);
     
     // Updating
     void insert(const Record &r);
+    void expire(Timestamp horizon);
 };
 
 class HINT_M_Dynamic_Second_Attr : public HierarchicalIndex
@@ -620,6 +643,7 @@ public:
     HINT_M_Dynamic_Second_Attr(Timestamp leafPartitionExtent);
     HINT_M_Dynamic_Second_Attr(const Relation &R, const unsigned int numBits, const unsigned int maxBits);
     void getStats();
+    size_t getMemoryUsage();
     void print(char c);
     ~HINT_M_Dynamic_Second_Attr() {};
     
@@ -628,6 +652,10 @@ public:
     size_t execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint);
     size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrUpperConstraint);
     size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrLowerConstraint);
+    template <class S> void execute_pureTimeTravel(RangeQuery Q, S &sink);
+    template <class S> void execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink);
+    template <class S> void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink);
 
     // Updating
     void insert(const Record &r);
@@ -679,6 +707,22 @@ public:
     void insert(const Record &r);
 };
 
+// Bytes held by a partitioned (level x partition) container, counting reserved capacity
+template <class T>
+inline size_t getPartitionsMemoryUsage(const vector<vector<T> > &partitions)
+{
+    size_t bytes = partitions.capacity()*sizeof(vector<T>);
+
+    for (auto &level : partitions)
+    {
+        bytes += level.capacity()*sizeof(T);
+        for (auto &p : level)
+            bytes += p.capacity()*sizeof(typename T::value_type);
+    }
+
+    return bytes;
+}
+
 inline bool CompareIdTimestampPairsById(const pair<RecordId, Timestamp> &lhs, const pair<RecordId, Timestamp> &rhs)
 {
     return (lhs.first < rhs.first);
@@ -1,4 +1,6 @@
 #include "hint_m.h"
+#include "../containers/scan_kernels.h"
+#include "../containers/thread_pool.h"
 
 
 
@@ -86,16 +88,14 @@ inline void HINT_M_Dynamic::updatePartitions(const Record &r)
                 if ((a == b) && (!lastfound))
                 {
 //                    this->pRepsInTmp[level][a][this->pRepsIn_sizes[level][a]] = Record(r.id, r.start, r.end);
-                    this->pRepsInIds[level][a].emplace_back(r.id);
-                    this->pRepsInTimestamps[level][a].emplace_back(r.start, r.end);
+                    this->pRepsIn[level].push_back(a, r.id, r.start, r.end);
 //                    this->pRepsIn_sizes[level][a]++;
                     lastfound = 1;
                 }
                 else
                 {
 //                    this->pRepsAftTmp[level][a][this->pRepsAft_sizes[level][a]] = Record(r.id, r.start, r.end);
-                    this->pRepsAftIds[level][a].emplace_back(r.id);
-                    this->pRepsAftTimestamps[level][a].emplace_back(r.start, r.end);
+                    this->pRepsAft[level].push_back(a, r.id, r.start, r.end);
 //                    this->pRepsAft_sizes[level][a]++;
                 }
             }
@@ -104,15 +104,15 @@ inline void HINT_M_Dynamic::updatePartitions(const Record &r)
                 if ((a == b) && (!lastfound))
                 {
 //                    this->pOrgsInTmp[level][a][this->pOrgsIn_sizes[level][a]] = Record(r.id, r.start, r.end);
-                    this->pOrgsInIds[level][a].emplace_back(r.id);
-                    this->pOrgsInTimestamps[level][a].emplace_back(r.start, r.end);
+                    this->pOrgsIn[level].push_back(a, r.id, r.start, r.end);
+                    this->pOrgsAggregates[level].insert(a, r.id);
 //                    this->pOrgsIn_sizes[level][a]++;
                 }
                 else
                 {
 //                    this->pOrgsAftTmp[level][a][this->pOrgsAft_sizes[level][a]] = Record(r.id, r.start, r.end);
-                    this->pOrgsAftIds[level][a].emplace_back(r.id);
-                    this->pOrgsAftTimestamps[level][a].emplace_back(r.start, r.end);
+                    this->pOrgsAft[level].push_back(a, r.id, r.start, r.end);
+                    this->pOrgsAggregates[level].insert(a, r.id);
 //                    this->pOrgsAft_sizes[level][a]++;
                 }
                 firstfound = 1;
@@ -128,15 +128,15 @@ inline void HINT_M_Dynamic::updatePartitions(const Record &r)
                 if (!lastfound)
                 {
 //                    this->pOrgsInTmp[level][prevb][this->pOrgsIn_sizes[level][prevb]] = Record(r.id, r.start, r.end);
-                    this->pOrgsInIds[level][prevb].emplace_back(r.id);
-                    this->pOrgsInTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    this->pOrgsIn[level].push_back(prevb, r.id, r.start, r.end);
+                    this->pOrgsAggregates[level].insert(prevb, r.id);
 //                    this->pOrgsIn_sizes[level][prevb]++;
                 }
                 else
                 {
 //                    this->pOrgsAftTmp[level][prevb][this->pOrgsAft_sizes[level][prevb]] = Record(r.id, r.start, r.end);
-                    this->pOrgsAftIds[level][prevb].emplace_back(r.id);
-                    this->pOrgsAftTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    this->pOrgsAft[level].push_back(prevb, r.id, r.start, r.end);
+                    this->pOrgsAggregates[level].insert(prevb, r.id);
 //                    this->pOrgsAft_sizes[level][prevb]++;
                 }
             }
@@ -145,16 +145,14 @@ inline void HINT_M_Dynamic::updatePartitions(const Record &r)
                 if (!lastfound)
                 {
 //                    this->pRepsInTmp[level][prevb][this->pRepsIn_sizes[level][prevb]] = Record(r.id, r.start, r.end);
-                    this->pRepsInIds[level][prevb].emplace_back(r.id);
-                    this->pRepsInTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    this->pRepsIn[level].push_back(prevb, r.id, r.start, r.end);
 //                    this->pRepsIn_sizes[level][prevb]++;
                     lastfound = 1;
                 }
                 else
                 {
 //                    this->pRepsAftTmp[level][prevb][this->pRepsAft_sizes[level][prevb]] = Record(r.id, r.start, r.end);
-                    this->pRepsAftIds[level][prevb].emplace_back(r.id);
-                    this->pRepsAftTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    this->pRepsAft[level].push_back(prevb, r.id, r.start, r.end);
 //                    this->pRepsAft_sizes[level][prevb]++;
                 }
             }
@@ -166,116 +164,64 @@ inline void HINT_M_Dynamic::updatePartitions(const Record &r)
 }
 
 
+// Adds the levels up to the current height, leaving the existing ones untouched; the partitions of a level are
+// added as records reach them, so a level costs nothing until it is used.
+void HINT_M_Dynamic::addLevels()
+{
+    // Only the endpoints compared by queries are kept
+    this->pOrgsIn.resize(this->height, PartitionStore(true, true));
+    this->pOrgsAft.resize(this->height, PartitionStore(true, false));
+    this->pRepsIn.resize(this->height, PartitionStore(false, true));
+    this->pRepsAft.resize(this->height, PartitionStore(false, false));
+    this->pOrgsAggregates.resize(this->height);
+}
+
+
+void HINT_M_Dynamic::compact()
+{
+    for (auto l = 0; l < this->height; l++)
+    {
+        this->pOrgsIn[l].compact();
+        this->pOrgsAft[l].compact();
+        this->pRepsIn[l].compact();
+        this->pRepsAft[l].compact();
+    }
+}
+
+
 // Creates a HINT^m containing one empty partition, no hierarchy
 HINT_M_Dynamic::HINT_M_Dynamic(Timestamp leafPartitionExtent)
 {
     this->leafPartitionExtent = leafPartitionExtent;
-    this->gstart = 0;
+    this->pool = NULL;
+    this->parallelThreshold = HINT_PARALLEL_THRESHOLD;
+    this->coldDirectory = NULL;
+    this->coldFailed = false;
+    this->gstart = this->hotStart = 0;
     this->gend   = this->leafPartitionExtent;
     this->maxBits = int(log2(this->gend-this->gstart)+1);
     
-    // Size for RecordId, vector<pair<Timestamp, Timestamp > > unset.
-    this->pOrgsInIds.resize(this->height);
-    this->pOrgsInIds[0].resize(1);
-    this->pOrgsInTimestamps.resize(this->height);
-    this->pOrgsInTimestamps[0].resize(1);
-
-    this->pOrgsAftIds.resize(this->height);
-    this->pOrgsAftIds[0].resize(1);
-    this->pOrgsAftTimestamps.resize(this->height);
-    this->pOrgsAftTimestamps[0].resize(1);
-
-    this->pRepsInIds.resize(this->height);
-    this->pRepsInIds[0].resize(1);
-    this->pRepsInTimestamps.resize(this->height);
-    this->pRepsInTimestamps[0].resize(1);
-
-    this->pRepsAftIds.resize(this->height);
-    this->pRepsAftIds[0].resize(1);
-    this->pRepsAftTimestamps.resize(this->height);
-    this->pRepsAftTimestamps[0].resize(1);
+    this->addLevels();
 }
 
 
 // Creates a HINT^m for input R.
 HINT_M_Dynamic::HINT_M_Dynamic(const Relation &R, const unsigned int numBits, const unsigned int maxBits) : HierarchicalIndex(R, numBits, maxBits)
 {
-    this->gstart = R.gstart;
+    this->pool = NULL;
+    this->parallelThreshold = HINT_PARALLEL_THRESHOLD;
+    this->coldDirectory = NULL;
+    this->coldFailed = false;
+    this->gstart = this->hotStart = R.gstart;
     this->gend = R.gend;
     this->leafPartitionExtent = ceil((R.gend-R.gstart)/(float)pow(2, this->numBits));
     
 
-    // Step 1: one pass to count the contents inside each partition.
-    this->pOrgsIn_sizes  = (RecordId **)malloc(this->height*sizeof(RecordId *));
-    this->pOrgsAft_sizes = (RecordId **)malloc(this->height*sizeof(RecordId *));
-    this->pRepsIn_sizes  = (size_t **)malloc(this->height*sizeof(size_t *));
-    this->pRepsAft_sizes = (size_t **)malloc(this->height*sizeof(size_t *));
-    
-    for (auto l = 0; l < this->height; l++)
-    {
-        auto cnt = (int)(pow(2, this->numBits-l));
-        
-        //calloc allocates memory and sets each counter to 0
-        this->pOrgsIn_sizes[l]  = (RecordId *)calloc(cnt, sizeof(RecordId));
-        this->pOrgsAft_sizes[l] = (RecordId *)calloc(cnt, sizeof(RecordId));
-        this->pRepsIn_sizes[l]  = (size_t *)calloc(cnt, sizeof(size_t));
-        this->pRepsAft_sizes[l] = (size_t *)calloc(cnt, sizeof(size_t));
-    }
-    
-    for (const Record &r : R)
-        this->updateCounters(r);
-    
-    // Step 2: allocate necessary memory.
-    this->pOrgsInIds.resize(this->height);
-    this->pOrgsAftIds.resize(this->height);
-    this->pRepsInIds.resize(this->height);
-    this->pRepsAftIds.resize(this->height);
-    this->pOrgsInTimestamps.resize(this->height);
-    this->pOrgsAftTimestamps.resize(this->height);
-    this->pRepsInTimestamps.resize(this->height);
-    this->pRepsAftTimestamps.resize(this->height);
-    for (auto l = 0; l < this->height; l++)
-    {
-        auto cnt = (int)(pow(2, this->numBits-l));
-        
-        this->pOrgsInIds[l].resize(cnt);
-        this->pOrgsAftIds[l].resize(cnt);
-        this->pRepsInIds[l].resize(cnt);
-        this->pRepsAftIds[l].resize(cnt);
-        this->pOrgsInTimestamps[l].resize(cnt);
-        this->pOrgsAftTimestamps[l].resize(cnt);
-        this->pRepsInTimestamps[l].resize(cnt);
-        this->pRepsAftTimestamps[l].resize(cnt);
-
-        for (auto pId = 0; pId < cnt; pId++)
-        {
-            this->pOrgsInIds[l][pId].reserve(this->pOrgsIn_sizes[l][pId]);
-            this->pOrgsAftIds[l][pId].reserve(this->pOrgsAft_sizes[l][pId]);
-            this->pRepsInIds[l][pId].reserve(this->pRepsIn_sizes[l][pId]);
-            this->pRepsAftIds[l][pId].reserve(this->pRepsAft_sizes[l][pId]);
-            this->pOrgsInTimestamps[l][pId].reserve(this->pOrgsIn_sizes[l][pId]);
-            this->pOrgsAftTimestamps[l][pId].reserve(this->pOrgsAft_sizes[l][pId]);
-            this->pRepsInTimestamps[l][pId].reserve(this->pRepsIn_sizes[l][pId]);
-            this->pRepsAftTimestamps[l][pId].reserve(this->pRepsAft_sizes[l][pId]);
-        }
-    }
-    
-    // Step 3: fill partitions.
+    // Partitions are filled through their tails and packed into the flat layout at the end
+    this->addLevels();
     for (const Record &r : R)
         this->updatePartitions(r);
-    
-    // Free auxiliary memory.
-    for (auto l = 0; l < this->height; l++)
-    {
-        free(this->pOrgsIn_sizes[l]);
-        free(this->pOrgsAft_sizes[l]);
-        free(this->pRepsIn_sizes[l]);
-        free(this->pRepsAft_sizes[l]);
-    }
-    free(this->pOrgsIn_sizes);
-    free(this->pOrgsAft_sizes);
-    free(this->pRepsIn_sizes);
-    free(this->pRepsAft_sizes);
+    this->compact();
 }
 
 
@@ -292,11 +238,11 @@ void HINT_M_Dynamic::getStats()
         this->numPartitions += cnt;
         for (int pid = 0; pid < cnt; pid++)
         {
-            this->numOriginalsIn  += this->pOrgsInIds[l][pid].size();
-            this->numOriginalsAft += this->pOrgsAftIds[l][pid].size();
-            this->numReplicasIn   += this->pRepsInIds[l][pid].size();
-            this->numReplicasAft  += this->pRepsAftIds[l][pid].size();
-            if ((this->pOrgsInIds[l][pid].empty()) && (this->pOrgsAftIds[l][pid].empty()) && (this->pRepsInIds[l][pid].empty()) && (this->pRepsAftIds[l][pid].empty()))
+            this->numOriginalsIn  += this->pOrgsIn[l].size(pid);
+            this->numOriginalsAft += this->pOrgsAft[l].size(pid);
+            this->numReplicasIn   += this->pRepsIn[l].size(pid);
+            this->numReplicasAft  += this->pRepsAft[l].size(pid);
+            if ((this->pOrgsIn[l].empty(pid)) && (this->pOrgsAft[l].empty(pid)) && (this->pRepsIn[l].empty(pid)) && (this->pRepsAft[l].empty(pid)))
                 this->numEmptyPartitions++;
         }
     }
@@ -305,6 +251,29 @@ void HINT_M_Dynamic::getStats()
 }
 
 
+size_t HINT_M_Dynamic::getMemoryUsage()
+{
+    size_t size = 0;
+
+    for (auto l = 0; l < this->height; l++)
+        size += this->pOrgsIn[l].getMemoryUsage() + this->pOrgsAft[l].getMemoryUsage() + this->pRepsIn[l].getMemoryUsage() + this->pRepsAft[l].getMemoryUsage() + this->pOrgsAggregates[l].getMemoryUsage();
+
+    return size;
+}
+
+
+// Bytes of the segment files, served through the page cache rather than the heap
+size_t HINT_M_Dynamic::getSegmentSize()
+{
+    size_t size = 0;
+
+    for (auto l = 0; l < this->height; l++)
+        size += this->pOrgsIn[l].getSegmentSize() + this->pOrgsAft[l].getSegmentSize() + this->pRepsIn[l].getSegmentSize() + this->pRepsAft[l].getSegmentSize();
+
+    return size;
+}
+
+
 void HINT_M_Dynamic::print(char c)
 {
     for (auto l = 0; l < this->height; l++)
@@ -315,433 +284,299 @@ void HINT_M_Dynamic::print(char c)
         for (auto p = 0; p < cnt; p++)
         {
             cout << "\tPartition " << p << endl;
-            cout << "\t\tOrgsIn[" << p << "] (" << this->pOrgsInIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pOrgsInIds[l][p].size(); i++)
+            cout << "\t\tOrgsIn[" << p << "] (" << this->pOrgsIn[l].size(p) << "):";
+            this->pOrgsIn[l].forEachRun(p, p, [c](const PartitionRun &run)
             {
-                cout << " " << c << this->pOrgsInIds[l][p][i] << "[" << this->pOrgsInTimestamps[l][p][i].first << ".." << this->pOrgsInTimestamps[l][p][i].second << "]";
-            }
+                for (auto i = 0; i < run.size; i++)
+                    cout << " " << c << run.ids[i] << "[" << run.starts[i] << ".." << run.ends[i] << "]";
+            });
             cout << endl;
-            cout << "\t\tOrgsAft[" << p << "] (" << this->pOrgsAftIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pOrgsAftIds[l][p].size(); i++)
+            cout << "\t\tOrgsAft[" << p << "] (" << this->pOrgsAft[l].size(p) << "):";
+            this->pOrgsAft[l].forEachRun(p, p, [c](const PartitionRun &run)
             {
-                cout << " " << c << this->pOrgsAftIds[l][p][i] << "[" << this->pOrgsAftTimestamps[l][p][i].first << ".." << this->pOrgsAftTimestamps[l][p][i].second << "]";
-            }
+                for (auto i = 0; i < run.size; i++)
+                    cout << " " << c << run.ids[i] << "[" << run.starts[i] << "..]";
+            });
             cout << endl;
-            cout << "\t\tRepsIn[" << p << "] (" << this->pRepsInIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pRepsInIds[l][p].size(); i++)
+            cout << "\t\tRepsIn[" << p << "] (" << this->pRepsIn[l].size(p) << "):";
+            this->pRepsIn[l].forEachRun(p, p, [c](const PartitionRun &run)
             {
-                cout << " " << c << this->pRepsInIds[l][p][i] << "[" << this->pRepsInTimestamps[l][p][i].first << ".." << this->pRepsInTimestamps[l][p][i].second << "]";
-            }
+                for (auto i = 0; i < run.size; i++)
+                    cout << " " << c << run.ids[i] << "[.." << run.ends[i] << "]";
+            });
             cout << endl;
-            cout << "\t\tRepsAft[" << p << "] (" << this->pRepsAftIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pRepsAftIds[l][p].size(); i++)
+            cout << "\t\tRepsAft[" << p << "] (" << this->pRepsAft[l].size(p) << "):";
+            this->pRepsAft[l].forEachRun(p, p, [c](const PartitionRun &run)
             {
-                cout << " " << c << this->pRepsAftIds[l][p][i] << "[" << this->pRepsAftTimestamps[l][p][i].first << ".." << this->pRepsAftTimestamps[l][p][i].second << "]";
-            }
+                for (auto i = 0; i < run.size; i++)
+                    cout << " " << c << run.ids[i];
+            });
             cout << endl;
         }
     }
 }
 
 
+void HINT_M_Dynamic::setParallelism(ThreadPool *pool, size_t parallelThreshold)
+{
+    this->pool = pool;
+    this->parallelThreshold = parallelThreshold;
+}
+
+
+// To be set before the first expire()
+void HINT_M_Dynamic::setColdStorage(const char *directory)
+{
+    this->coldDirectory = directory;
+}
+
+
 // Querying
-size_t HINT_M_Dynamic::execute_pureTimeTravel(RangeQuery Q)
+
+// Partitions of a level that are fully covered by the query, given the prefixes and the flags of the level; empty if from > to
+inline void getCoveredPartitions(Timestamp a, Timestamp b, bool foundzero, bool foundone, Timestamp &from, Timestamp &to)
+{
+    if (foundone && foundzero)
+    {
+        from = a;
+        to   = b;
+    }
+    else if (!foundone)
+    {
+        from = a+1;
+        to   = b-1;
+    }
+    else
+    {
+        from = a+1;
+        to   = b;
+    }
+}
+
+
+// All originals of the partitions from..to of level l are results
+template <class S>
+inline void HINT_M_Dynamic::scanPartitions(int l, Timestamp from, Timestamp to, S &sink)
+{
+    if (from <= to)
+    {
+        this->pOrgsIn[l].addAll(from, to, sink);
+        this->pOrgsAft[l].addAll(from, to, sink);
+    }
+}
+
+
+// COUNT and XOR queries take the originals of the covered partitions from the aggregates of the level
+inline void HINT_M_Dynamic::scanPartitions(int l, Timestamp from, Timestamp to, CountSink &sink)
+{
+    if (from <= to)
+        sink.result += this->pOrgsAggregates[l].getCount(to+1)-this->pOrgsAggregates[l].getCount(from);
+}
+
+
+inline void HINT_M_Dynamic::scanPartitions(int l, Timestamp from, Timestamp to, XorSink &sink)
+{
+    if (from <= to)
+        sink.add(this->pOrgsAggregates[l].getXor(to+1) ^ this->pOrgsAggregates[l].getXor(from));
+}
+
+
+// Level l apart from its fully covered partitions, i.e., the replicas and the partitions that need comparisons
+template <class S>
+inline void HINT_M_Dynamic::scanLevel(int l, Timestamp a, Timestamp b, bool foundzero, bool foundone, RangeQuery Q, S &sink)
+{
+    if (foundone && foundzero)
+    {
+        // Partition totally covers lowest-level partition range that includes query range
+        // all contents are guaranteed to be results
+
+        // Handle the partition that contains a: consider both originals and replicas
+        this->pRepsIn[l].addAll(a, a, sink);
+        this->pRepsAft[l].addAll(a, a, sink);
+
+        return;
+    }
+
+    // Comparisons needed
+
+    // Handle the partition that contains a: consider both originals and replicas, comparisons needed
+    if (a == b)
+    {
+        // Special case when query overlaps only one partition, Lemma 3
+        if (!foundzero && !foundone)
+        {
+            this->pOrgsIn[l].scanOverlap(a, Q.start, Q.end, sink);
+            this->pOrgsAft[l].scanLessEqual(a, Q.end, sink);
+        }
+        else if (foundzero)
+        {
+            this->pOrgsIn[l].scanLessEqual(a, Q.end, sink);
+            this->pOrgsAft[l].scanLessEqual(a, Q.end, sink);
+        }
+        else if (foundone)
+        {
+            this->pOrgsIn[l].scanGreaterEqual(a, Q.start, sink);
+            this->pOrgsAft[l].addAll(a, a, sink);
+        }
+    }
+    else
+    {
+        // Lemma 1
+        if (!foundzero)
+            this->pOrgsIn[l].scanGreaterEqual(a, Q.start, sink);
+        else
+            this->pOrgsIn[l].addAll(a, a, sink);
+        this->pOrgsAft[l].addAll(a, a, sink);
+    }
+
+    // Lemma 1, 3
+    if (!foundzero)
+        this->pRepsIn[l].scanGreaterEqual(a, Q.start, sink);
+    else
+        this->pRepsIn[l].addAll(a, a, sink);
+    this->pRepsAft[l].addAll(a, a, sink);
+
+    if ((a < b) && (!foundone))
+    {
+        // Handle the partition that contains b: consider only originals, comparisons needed
+        this->pOrgsIn[l].scanLessEqual(b, Q.end, sink);
+        this->pOrgsAft[l].scanLessEqual(b, Q.end, sink);
+    }
+}
+
+
+template <class S>
+inline void HINT_M_Dynamic::scanRoot(bool foundzero, bool foundone, RangeQuery Q, S &sink)
+{
+    if (foundone && foundzero)
+    {
+        // All contents are guaranteed to be results
+        this->pOrgsIn[this->numBits].addAll(0, 0, sink);
+    }
+    else
+    {
+        // Comparisons needed
+        this->pOrgsIn[this->numBits].scanOverlap(0, Q.start, Q.end, sink);
+    }
+}
+
+
+template <class S>
+void HINT_M_Dynamic::execute_pureTimeTravel(RangeQuery Q, S &sink)
 {
-    size_t result = 0;
-    vector<pair<Timestamp, Timestamp> >::iterator iter, iterStart, iterEnd;
-    RelationIdIterator iterI, iterIStart, iterIEnd;
     Timestamp a = Q.start >> (this->maxBits-this->numBits); // prefix
     Timestamp b = Q.end   >> (this->maxBits-this->numBits); // prefix
+    Timestamp from, to;
     bool foundzero = false;
     bool foundone = false;
     
 
-    for (auto l = 0; l < this->numBits; l++)
+    // Only the part of the query inside the retained domain is answered
+    if (Q.end < this->gstart)
+        return;
+    if (Q.start < this->gstart)
     {
-        if (foundone && foundzero)
-        {
-            // Partition totally covers lowest-level partition range that includes query range
-            // all contents are guaranteed to be results
-            
-            // Handle the partition that contains a: consider both originals and replicas
-            iterIStart = this->pRepsInIds[l][a].begin();
-            iterIEnd = this->pRepsInIds[l][a].end();
-            for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
-            iterIStart =this->pRepsAftIds[l][a].begin();
-            iterIEnd = this->pRepsAftIds[l][a].end();
-            for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
-            
-            // Handle rest: consider only originals
-            for (auto j = a; j <= b; j++)
-            {
-                iterIStart = this->pOrgsInIds[l][j].begin();
-                iterIEnd = this->pOrgsInIds[l][j].end();
-                for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                }
-                iterIStart = this->pOrgsAftIds[l][j].begin();
-                iterIEnd = this->pOrgsAftIds[l][j].end();
-                for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                }
-            }
-        }
-        else
-        {
-            // Comparisons needed
-            
-            // Handle the partition that contains a: consider both originals and replicas, comparisons needed
-            if (a == b)
-            {
-                // Special case when query overlaps only one partition, Lemma 3
-                if (!foundzero && !foundone)
-                {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if ((iter->first <= Q.end) && (Q.start <= iter->second))
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterI = this->pOrgsAftIds[l][a].begin();
-                    iterStart = this->pOrgsAftTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsAftTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                }
-                else if (foundzero)
-                {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterI = this->pOrgsAftIds[l][a].begin();
-                    iterStart = this->pOrgsAftTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsAftTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                }
-                else if (foundone)
-                {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (Q.start <= iter->second)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterIStart = this->pOrgsAftIds[l][a].begin();
-                    iterIEnd = this->pOrgsAftIds[l][a].end();
-                    for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                    {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
-                    }
-                }
-            }
-            else
-            {
-                // Lemma 1
-                if (!foundzero)
-                {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (Q.start <= iter->second)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                }
-                else
-                {
-                    iterIStart = this->pOrgsInIds[l][a].begin();
-                    iterIEnd = this->pOrgsInIds[l][a].end();
-                    for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                    {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
-                    }
-                }
-                iterI = this->pOrgsAftIds[l][a].begin();
-                iterStart = this->pOrgsAftTimestamps[l][a].begin();
-                iterEnd = this->pOrgsAftTimestamps[l][a].end();
-                for (iter = iterStart; iter != iterEnd; iter++)
-                {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                    iterI++;
-                }
-            }
+        Q.start = this->gstart;
+        a = Q.start >> (this->maxBits-this->numBits);
+    }
 
-            // Lemma 1, 3
-            if (!foundzero)
-            {
-                iterI = this->pRepsInIds[l][a].begin();
-                iterStart = this->pRepsInTimestamps[l][a].begin();
-                iterEnd = this->pRepsInTimestamps[l][a].end();
-                for (iter = iterStart; iter != iterEnd; iter++)
-                {
-                    if (Q.start <= iter->second)
-                    {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
-                    }
-                    iterI++;
-                }
-            }
-            else
-            {
-                iterIStart = this->pRepsInIds[l][a].begin();
-                iterIEnd = this->pRepsInIds[l][a].end();
-                for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                }
-            }
+    // Estimate the result size by the fraction of the domain that the query covers
+    if ((this->pool != NULL) && ((double)this->numIndexedRecords*(min(Q.end, this->gend)-Q.start+1)/(this->gend-this->gstart+1) >= this->parallelThreshold))
+    {
+        this->executeParallel_pureTimeTravel(Q, sink);
+        return;
+    }
 
-            iterIStart = this->pRepsAftIds[l][a].begin();
-            iterIEnd = this->pRepsAftIds[l][a].end();
-            for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
+    for (auto l = 0; l < this->numBits; l++)
+    {
+        this->scanLevel(l, a, b, foundzero, foundone, Q, sink);
 
-            if (a < b)
-            {
-                if (!foundone)
-                {
-                    // Handle the rest before the partition that contains b: consider only originals, no comparisons needed
-                    for (auto j = a+1; j < b; j++)
-                    {
-                        iterIStart = this->pOrgsInIds[l][j].begin();
-                        iterIEnd = this->pOrgsInIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterIStart = this->pOrgsAftIds[l][j].begin();
-                        iterIEnd = this->pOrgsAftIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                    }
-
-                    // Handle the partition that contains b: consider only originals, comparisons needed
-                    iterI = this->pOrgsInIds[l][b].begin();
-                    iterStart = this->pOrgsInTimestamps[l][b].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][b].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterI = this->pOrgsAftIds[l][b].begin();
-                    iterStart = this->pOrgsAftTimestamps[l][b].begin();
-                    iterEnd = this->pOrgsAftTimestamps[l][b].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                }
-                else
-                {
-                    for (auto j = a+1; j <= b; j++)
-                    {
-                        iterIStart = this->pOrgsInIds[l][j].begin();
-                        iterIEnd = this->pOrgsInIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterIStart = this->pOrgsAftIds[l][j].begin();
-                        iterIEnd = this->pOrgsAftIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                    }
-                }
-            }
-            
-            if ((!foundone) && (b%2)) //last bit of b is 1
-                foundone = 1;
-            if ((!foundzero) && (!(a%2))) //last bit of a is 0
-                foundzero = 1;
-        }
+        // Handle the rest: consider only originals, no comparisons needed
+        getCoveredPartitions(a, b, foundzero, foundone, from, to);
+        this->scanPartitions(l, from, to, sink);
+
+        if ((!foundone) && (b%2)) //last bit of b is 1
+            foundone = 1;
+        if ((!foundzero) && (!(a%2))) //last bit of a is 0
+            foundzero = 1;
         a >>= 1; // a = a div 2
         b >>= 1; // b = b div 2
     }
     
     // Handle root.
-    if (foundone && foundzero)
+    this->scanRoot(foundzero, foundone, Q, sink);
+}
+
+
+// Same traversal as execute_pureTimeTravel, but every level and every chunk of fully covered partitions becomes a task of
+// the pool with its own sink; the calling thread works on the tasks too until all are done.
+template <class S>
+void HINT_M_Dynamic::executeParallel_pureTimeTravel(RangeQuery Q, S &sink)
+{
+    Timestamp a = Q.start >> (this->maxBits-this->numBits); // prefix
+    Timestamp b = Q.end   >> (this->maxBits-this->numBits); // prefix
+    vector<Timestamp> from(this->numBits), to(this->numBits);
+    vector<function<void(S&)> > tasks;
+    bool foundzero = false;
+    bool foundone = false;
+    size_t numCovered = 0, chunk;
+
+
+    for (auto l = 0; l < this->numBits; l++)
     {
-        // All contents are guaranteed to be results
-        iterIStart = this->pOrgsInIds[this->numBits][0].begin();
-        iterIEnd = this->pOrgsInIds[this->numBits][0].end();
-        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-        {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
-        }
+        tasks.push_back([this, l, a, b, foundzero, foundone, Q](S &s) { this->scanLevel(l, a, b, foundzero, foundone, Q, s); });
+
+        getCoveredPartitions(a, b, foundzero, foundone, from[l], to[l]);
+        if (from[l] <= to[l])
+            numCovered += to[l]-from[l]+1;
+
+        if ((!foundone) && (b%2)) //last bit of b is 1
+            foundone = 1;
+        if ((!foundzero) && (!(a%2))) //last bit of a is 0
+            foundzero = 1;
+        a >>= 1; // a = a div 2
+        b >>= 1; // b = b div 2
     }
-    else
+    tasks.push_back([this, foundzero, foundone, Q](S &s) { this->scanRoot(foundzero, foundone, Q, s); });
+
+    // Split the fully covered partitions of each level into chunks
+    chunk = max((size_t)1, numCovered/(HINT_TASKS_PER_THREAD*(this->pool->getNumThreads()+1)));
+    for (auto l = 0; l < this->numBits; l++)
     {
-        // Comparisons needed
-        iterI = this->pOrgsInIds[this->numBits][0].begin();
-        iterStart = this->pOrgsInTimestamps[this->numBits][0].begin();
-        iterEnd = this->pOrgsInTimestamps[this->numBits][0].end();
-        for (iter = iterStart; iter != iterEnd; iter++)
+        for (auto j = from[l]; j <= to[l]; j += chunk)
         {
-            if ((iter->first <= Q.end) && (Q.start <= iter->second))
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
-            iterI++;
+            Timestamp jEnd = min((Timestamp)(j+chunk-1), to[l]);
+
+            tasks.push_back([this, l, j, jEnd](S &s) { this->scanPartitions(l, j, jEnd, s); });
         }
     }
-    
-    return result;
+
+    PartialSinks<S> partials(tasks.size());
+    TaskGroup group(this->pool);
+
+    for (auto i = 0; i < tasks.size(); i++)
+        group.run([&tasks, &partials, i] { tasks[i](partials[i]); });
+    group.wait();
+
+    partials.mergeInto(sink);
+}
+
+
+size_t HINT_M_Dynamic::execute_pureTimeTravel(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_pureTimeTravel(Q, sink);
+
+    return sink.getResult();
 }
 
 
+template void HINT_M_Dynamic::execute_pureTimeTravel<CountSink>(RangeQuery Q, CountSink &sink);
+template void HINT_M_Dynamic::execute_pureTimeTravel<XorSink>(RangeQuery Q, XorSink &sink);
+template void HINT_M_Dynamic::execute_pureTimeTravel<IdSink>(RangeQuery Q, IdSink &sink);
+
+
 // Updating
 void HINT_M_Dynamic::insert(const Record &r)
 {
@@ -751,63 +586,72 @@ void HINT_M_Dynamic::insert(const Record &r)
 
     
     // Check if the partitions where r will ne inserted already exist.
-    if (this->gend >= r.end)
-    {
-//        cout << "\tgStart         : " << this->gstart << endl;
-//        cout << "\tgEnd           : " << this->gend << endl;
-//        cout << "\tnumBits        : " << this->numBits << endl;
-//        cout << "\tmaxBits        : " << this->maxBits << endl;
-        this->updatePartitions(r);
-    }
-    else    // Need to grow the index
+    if (this->gend < r.end)    // Need to grow the index
     {
-        // Update index parameters, calculate how many extra partitions are needed.
-//        cout<< ceil(log2(ceil((r.end-this->gstart)/(float)partitionExtent))) << endl;
-//
-//        auto extraBitsNeeded = int(log2(r.end-this->gstart)+1)-this->maxBits;
-//
-//        cout << "\tint(log2(r.end-this->gstart)+1) = " << int(log2(r.end-this->gstart)+1) << endl;
-//        cout << "\textraBitsNeeded = " << extraBitsNeeded << endl;
-//        this->numBits += extraBitsNeeded;
-//        this->gend = partitionExtent*pow(2, this->numBits);
-//        this->maxBits = int(log2(this->gend-this->gstart)+1);
-//        this->height = this->numBits+1;
-        this->numBits = ceil(log2(ceil((r.end-this->gstart)/(float)this->leafPartitionExtent)));
-        this->gend = this->leafPartitionExtent*pow(2, this->numBits);
-        this->maxBits = int(log2(this->gend-this->gstart)+1);
-        this->height = this->numBits+1;
-        
-//        cout << "\tgStart     : " << this->gstart << endl;
-//        cout << "\tNew gEnd   : " << this->gend << endl;
-//        cout << "\tNew numBits: " << this->numBits << endl;
-//        cout << "\tNew maxBits: " << this->maxBits << endl;
-//        cout << "\tNew height : " << this->height << endl;
-        
-        // Grow - increase the height of the index.
-        this->pOrgsInIds.resize(this->height);
-        this->pOrgsInTimestamps.resize(this->height);
-        this->pOrgsAftIds.resize(this->height);
-        this->pOrgsAftTimestamps.resize(this->height);
-        this->pRepsInIds.resize(this->height);
-        this->pRepsInTimestamps.resize(this->height);
-        this->pRepsAftIds.resize(this->height);
-        this->pRepsAftTimestamps.resize(this->height);
-        for (auto l = 0; l < this->height; l++)
+        // Add root levels on top, each doubling the domain. The shift maxBits-numBits that maps a timestamp to its
+        // leaf partition stays the same, so every existing partition keeps its boundaries and its contents; a
+        // record is placed on the same levels and partitions whatever the height, as long as it fits the domain.
+        while (this->gend < r.end)
         {
-            auto cnt = (int)(pow(2, this->numBits-l));
-
-            this->pOrgsInIds[l].resize(cnt);
-            this->pOrgsInTimestamps[l].resize(cnt);
-            this->pOrgsAftIds[l].resize(cnt);
-            this->pOrgsAftTimestamps[l].resize(cnt);
-            this->pRepsInIds[l].resize(cnt);
-            this->pRepsInTimestamps[l].resize(cnt);
-            this->pRepsAftIds[l].resize(cnt);
-            this->pRepsAftTimestamps[l].resize(cnt);
+            this->numBits++;
+            this->maxBits++;
+            this->height++;
+            this->gend *= 2;
         }
-        this->updatePartitions(r);
+        this->addLevels();
     }
+    this->updatePartitions(r);
     
     this->numIndexedRecords++;
 //    cout << endl;
 }
+
+
+// Sliding-window retention: evicts the partitions that end before horizon, rounded down to a leaf partition
+// boundary, which becomes the new gstart; queries are then answered over [gstart, gend] only. The boundaries of
+// the remaining partitions do not change, so they keep their contents as is.
+// With cold storage, the partitions are sealed into segment files instead and the boundary becomes hotStart;
+// queries still cover the whole domain, reading the sealed partitions through mmap. If a segment file cannot be
+// written, the failure is reported once and nothing is sealed from then on; the partitions stay in memory.
+void HINT_M_Dynamic::expire(Timestamp horizon)
+{
+    int shift = this->maxBits-this->numBits;
+    Timestamp newStart = (horizon >> shift) << shift;
+
+
+    if (this->coldDirectory != NULL)
+    {
+        if ((this->coldFailed) || (newStart <= this->hotStart))
+            return;
+
+        for (auto l = 0; l < this->height; l++)
+        {
+            size_t upTo = newStart >> (shift+l);
+
+            // A store that fails to seal is left as is, so queries read its partitions from memory
+            if ((!this->pOrgsIn[l].seal(upTo, this->coldDirectory)) || (!this->pOrgsAft[l].seal(upTo, this->coldDirectory)) || (!this->pRepsIn[l].seal(upTo, this->coldDirectory)) || (!this->pRepsAft[l].seal(upTo, this->coldDirectory)))
+            {
+                cerr << endl << "Error - cannot write a segment file to \"" << this->coldDirectory << "\"; the expired partitions are kept in memory" << endl << endl;
+                this->coldFailed = true;
+                return;
+            }
+        }
+        this->hotStart = newStart;
+
+        return;
+    }
+
+    if (newStart <= this->gstart)
+        return;
+
+    this->gstart = newStart;
+    for (auto l = 0; l < this->height; l++)
+    {
+        size_t upTo = newStart >> (shift+l);
+
+        this->numIndexedRecords -= this->pOrgsIn[l].evict(upTo) + this->pOrgsAft[l].evict(upTo);
+        this->pRepsIn[l].evict(upTo);
+        this->pRepsAft[l].evict(upTo);
+        this->pOrgsAggregates[l].evict(upTo);
+    }
+}
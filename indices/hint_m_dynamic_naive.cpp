@@ -316,6 +316,16 @@ void HINT_M_Dynamic_Naive::getStats()
 }
 
 
+size_t HINT_M_Dynamic_Naive::getMemoryUsage()
+{
+    return this->aliveIntervals.capacity()*sizeof(pair<RecordId, Timestamp>)
+         + getPartitionsMemoryUsage(this->pOrgsInIds) + getPartitionsMemoryUsage(this->pOrgsAftIds) + getPartitionsMemoryUsage(this->pRepsInIds) + getPartitionsMemoryUsage(this->pRepsAftIds)
+         + getPartitionsMemoryUsage(this->pTmpOrgsIds) + getPartitionsMemoryUsage(this->pTmpRepsIds)
+         + getPartitionsMemoryUsage(this->pOrgsInTimestamps) + getPartitionsMemoryUsage(this->pOrgsAftTimestamps) + getPartitionsMemoryUsage(this->pRepsInTimestamps) + getPartitionsMemoryUsage(this->pRepsAftTimestamps)
+         + getPartitionsMemoryUsage(this->pTmpOrgsTimestamps) + getPartitionsMemoryUsage(this->pTmpRepsTimestamps);
+}
+
+
 void HINT_M_Dynamic_Naive::print(char c)
 {
     for (auto l = 0; l < this->height; l++)
@@ -356,9 +366,9 @@ void HINT_M_Dynamic_Naive::print(char c)
 
 
 // Querying
-size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
+template <class S>
+void HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q, S &sink)
 {
-    size_t result = 0;
     vector<pair<Timestamp, Timestamp> >::iterator iter, iterStart, iterEnd;
     RelationIdIterator iterI, iterIStart, iterIEnd;
     Timestamp a = Q.start >> (this->maxBits-this->numBits); // prefix
@@ -379,21 +389,13 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsInIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterIStart =this->pRepsAftIds[l][a].begin();
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
 
             //handle alive intervals in the partition that contains a: both originals and replicas
@@ -401,11 +403,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pTmpRepsIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
 
             
@@ -416,21 +414,13 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pOrgsInIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterIStart = this->pOrgsAftIds[l][j].begin();
                 iterIEnd = this->pOrgsAftIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
 
                 // handle the alive Orgs for the rest
@@ -438,11 +428,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pTmpOrgsIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
             }
         }
@@ -463,11 +449,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if ((iter->first <= Q.end) && (Q.start <= iter->second))
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -479,11 +461,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -496,11 +474,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }                    
@@ -514,11 +488,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -529,11 +499,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -546,11 +512,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }                    
@@ -564,11 +526,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -576,22 +534,14 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsAftIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
 
                     iterIStart = this->pTmpOrgsIds[l][a].begin();
                     iterIEnd = this->pTmpOrgsIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
 
                 }
@@ -608,11 +558,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -623,11 +569,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsInIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                 }
                 iterI = this->pOrgsAftIds[l][a].begin();
@@ -635,11 +577,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterEnd = this->pOrgsAftTimestamps[l][a].end();
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                     iterI++;
                 }
 
@@ -649,11 +587,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterEnd = this->pTmpOrgsTimestamps[l][a].end();
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                     iterI++;
                 }                    
             }
@@ -668,11 +602,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 {
                     if (Q.start <= iter->second)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterI++;
                 }
@@ -683,11 +613,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pRepsInIds[l][a].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
             }
 
@@ -695,11 +621,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
 
 
@@ -708,11 +630,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pTmpRepsIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
 
             if (a < b)
@@ -726,32 +644,20 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
 
                         iterIStart = this->pTmpOrgsIds[l][j].begin();
                         iterIEnd = this->pTmpOrgsIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
 
                     }
@@ -764,11 +670,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -781,11 +683,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -798,11 +696,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -816,32 +710,20 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         // consider original alive intervals
                         iterIStart = this->pTmpOrgsIds[l][j].begin();
                         iterIEnd = this->pTmpOrgsIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iter++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
 
                     }
@@ -865,22 +747,14 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
         iterIEnd = this->pOrgsInIds[this->numBits][0].end();
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            sink.add(*iterI);
         }
 
         iterIStart = this->pTmpOrgsIds[this->numBits][0].begin();
         iterIEnd = this->pTmpOrgsIds[this->numBits][0].end();
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            sink.add(*iterI);
         }
 
     }
@@ -894,11 +768,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
         {
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterI++;
         }
@@ -910,17 +780,22 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
         {
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterI++;
         }
     }
     
-    return result;
+}
+
+
+size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_pureTimeTravel(Q, sink);
+
+    return sink.getResult();
 }
 
 
@@ -1125,3 +1000,9 @@ void HINT_M_Dynamic_Naive::expand(){
         for(auto x: aliveIntervals)
             this->updatePartitionsTmp(Record(x.first, x.second, this->gend));          
 }
+
+
+// Instantiations for the result sinks
+template void HINT_M_Dynamic_Naive::execute_pureTimeTravel<CountSink>(RangeQuery Q, CountSink &sink);
+template void HINT_M_Dynamic_Naive::execute_pureTimeTravel<XorSink>(RangeQuery Q, XorSink &sink);
+template void HINT_M_Dynamic_Naive::execute_pureTimeTravel<IdSink>(RangeQuery Q, IdSink &sink);
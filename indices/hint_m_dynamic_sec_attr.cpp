@@ -335,6 +335,14 @@ void HINT_M_Dynamic_Second_Attr::getStats()
 }
 
 
+size_t HINT_M_Dynamic_Second_Attr::getMemoryUsage()
+{
+    return getPartitionsMemoryUsage(this->pOrgsInIds) + getPartitionsMemoryUsage(this->pOrgsAftIds) + getPartitionsMemoryUsage(this->pRepsInIds) + getPartitionsMemoryUsage(this->pRepsAftIds)
+         + getPartitionsMemoryUsage(this->pOrgsInTimestamps) + getPartitionsMemoryUsage(this->pOrgsAftTimestamps) + getPartitionsMemoryUsage(this->pRepsInTimestamps) + getPartitionsMemoryUsage(this->pRepsAftTimestamps)
+         + getPartitionsMemoryUsage(this->pOrgsInAttrs) + getPartitionsMemoryUsage(this->pOrgsAftAttrs) + getPartitionsMemoryUsage(this->pRepsInAttrs) + getPartitionsMemoryUsage(this->pRepsAftAttrs);
+}
+
+
 void HINT_M_Dynamic_Second_Attr::print(char c)
 {
     for (auto l = 0; l < this->height; l++)
@@ -375,9 +383,9 @@ void HINT_M_Dynamic_Second_Attr::print(char c)
 
 
 // Querying
-size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
+template <class S>
+void HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q, S &sink)
 {
-    size_t result = 0;
     vector<pair<Timestamp, Timestamp> >::iterator iter, iterStart, iterEnd;
     RelationIdIterator iterI, iterIStart, iterIEnd;
     Timestamp a = Q.start >> (this->maxBits-this->numBits); // prefix
@@ -398,21 +406,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsInIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterIStart =this->pRepsAftIds[l][a].begin();
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             
             // Handle rest: consider only originals
@@ -422,21 +422,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pOrgsInIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterIStart = this->pOrgsAftIds[l][j].begin();
                 iterIEnd = this->pOrgsAftIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
             }
         }
@@ -457,11 +449,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if ((iter->first <= Q.end) && (Q.start <= iter->second))
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -472,11 +460,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -490,11 +474,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -505,11 +485,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -523,11 +499,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -535,11 +507,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsAftIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                 }
             }
@@ -555,11 +523,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -570,11 +534,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsInIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                 }
                 iterI = this->pOrgsAftIds[l][a].begin();
@@ -582,11 +542,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 iterEnd = this->pOrgsAftTimestamps[l][a].end();
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                     iterI++;
                 }
             }
@@ -601,11 +557,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 {
                     if (Q.start <= iter->second)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterI++;
                 }
@@ -616,11 +568,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pRepsInIds[l][a].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
             }
 
@@ -628,11 +576,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
 
             if (a < b)
@@ -646,21 +590,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                     }
 
@@ -672,11 +608,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -687,11 +619,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterI++;
                     }
@@ -704,21 +632,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                     }
                 }
@@ -741,11 +661,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
         iterIEnd = this->pOrgsInIds[this->numBits][0].end();
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            sink.add(*iterI);
         }
     }
     else
@@ -758,22 +674,27 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
         {
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterI++;
         }
     }
     
-    return result;
 }
 
-size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint)
+
+size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_pureTimeTravel(Q, sink);
+
+    return sink.getResult();
+}
+
+template <class S>
+void HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     vector<pair<Timestamp, Timestamp> >::iterator iter, iterStart, iterEnd;
     RelationIdIterator iterI, iterIStart, iterIEnd;
     vector<int>::iterator iterA;
@@ -797,11 +718,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -811,11 +728,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -829,11 +742,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -844,11 +753,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -873,11 +778,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if ((iter->first <= Q.end) && (Q.start <= iter->second))
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -893,11 +794,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -915,11 +812,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -935,11 +828,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -957,11 +846,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -974,11 +859,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterA++;
                     }
@@ -998,11 +879,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1017,11 +894,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterA++;
                     }
@@ -1033,11 +906,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterI++;
                     iterA++;
@@ -1056,11 +925,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                     if (Q.start <= iter->second)
                     {
                         if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                     }
                     iterI++;
@@ -1075,11 +940,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -1091,11 +952,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -1113,11 +970,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1127,11 +980,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1147,11 +996,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterA++;
@@ -1166,11 +1011,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1187,11 +1028,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1201,11 +1038,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1232,11 +1065,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterA++;
         }
@@ -1253,11 +1082,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
             }
             iterI++;
@@ -1265,12 +1090,21 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
         }
     }
     
-    return result;
 }
 
-size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint)
+
+size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint)
+{
+    WorkloadSink sink;
+
+    this->execute_rangeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint, sink);
+
+    return sink.getResult();
+}
+
+template <class S>
+void HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink)
 {
-    size_t result = 0;
     vector<pair<Timestamp, Timestamp> >::iterator iter, iterStart, iterEnd;
     RelationIdIterator iterI, iterIStart, iterIEnd;
     vector<int>::iterator iterA, iterAStart, iterAEnd;
@@ -1296,11 +1130,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -1313,11 +1143,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -1332,11 +1158,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -1347,11 +1169,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -1378,11 +1196,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1399,11 +1213,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1422,11 +1232,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1443,11 +1249,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1466,11 +1268,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1484,11 +1282,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterA++;
                     }
@@ -1509,11 +1303,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterA++;
@@ -1529,11 +1319,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterA++;
                     }
@@ -1547,11 +1333,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                     iterI++;
@@ -1571,11 +1353,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                     if (Q.start <= iter->second)
                     {
                         if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                     }
                     iterA++;
@@ -1591,11 +1369,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -1608,11 +1382,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -1631,11 +1401,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1647,11 +1413,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1668,11 +1430,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1687,11 +1445,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterA++;
@@ -1709,11 +1463,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1725,11 +1475,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -1757,11 +1503,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterA++;
         }
@@ -1779,11 +1521,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
                 if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
             }
             iterA++;
@@ -1791,13 +1529,21 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
         }
     }
     
-    return result;
 }
 
-size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint)
 
+size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint)
+{
+    WorkloadSink sink;
+
+    this->executeTimeTravel_greaterthan(Q, secondAttrLowerConstraint, sink);
+
+    return sink.getResult();
+}
+
+template <class S>
+void HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     vector<pair<Timestamp, Timestamp> >::iterator iter, iterStart, iterEnd;
     RelationIdIterator iterI, iterIStart, iterIEnd;
     vector<int>::iterator iterA, iterAStart, iterAEnd;
@@ -1823,11 +1569,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -1840,11 +1582,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -1859,11 +1597,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -1874,11 +1608,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -1905,11 +1635,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1926,11 +1652,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1949,11 +1671,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1970,11 +1688,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -1993,11 +1707,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -2011,11 +1721,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterA++;
                     }
@@ -2036,11 +1742,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterA++;
@@ -2056,11 +1758,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                         iterA++;
                     }
@@ -2074,11 +1772,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                     iterI++;
@@ -2098,11 +1792,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                     if (Q.start <= iter->second)
                     {
                         if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            sink.add(*iterI);
                         }
                     }
                     iterA++;
@@ -2118,11 +1808,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        sink.add(*iterI);
                     }
                     iterA++;
                 }
@@ -2135,11 +1821,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
                 iterA++;
             }
@@ -2158,11 +1840,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -2174,11 +1852,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -2195,11 +1869,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterI++;
@@ -2214,11 +1884,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                         }
                         iterA++;
@@ -2236,11 +1902,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -2252,11 +1914,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                sink.add(*iterI);
                             }
                             iterA++;
                         }
@@ -2284,11 +1942,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                sink.add(*iterI);
             }
             iterA++;
         }
@@ -2306,11 +1960,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
                 if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    sink.add(*iterI);
                 }
             }
             iterA++;
@@ -2318,7 +1968,16 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
         }
     }
     
-    return result;
+}
+
+
+size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint)
+{
+    WorkloadSink sink;
+
+    this->executeTimeTravel_lowerthan(Q, secondAttrUpperConstraint, sink);
+
+    return sink.getResult();
 }
 
 // Updating
@@ -2401,3 +2060,18 @@ void HINT_M_Dynamic_Second_Attr::insert(const Record &r)
     this->numIndexedRecords++;
 //    cout << endl;
 }
+
+
+// Instantiations for the result sinks
+template void HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel<CountSink>(RangeQuery Q, CountSink &sink);
+template void HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel<CountSink>(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, CountSink &sink);
+template void HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan<CountSink>(RangeQuery Q, int secondAttrLowerConstraint, CountSink &sink);
+template void HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan<CountSink>(RangeQuery Q, int secondAttrUpperConstraint, CountSink &sink);
+template void HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel<XorSink>(RangeQuery Q, XorSink &sink);
+template void HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel<XorSink>(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, XorSink &sink);
+template void HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan<XorSink>(RangeQuery Q, int secondAttrLowerConstraint, XorSink &sink);
+template void HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan<XorSink>(RangeQuery Q, int secondAttrUpperConstraint, XorSink &sink);
+template void HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel<IdSink>(RangeQuery Q, IdSink &sink);
+template void HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel<IdSink>(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, IdSink &sink);
+template void HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan<IdSink>(RangeQuery Q, int secondAttrLowerConstraint, IdSink &sink);
+template void HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan<IdSink>(RangeQuery Q, int secondAttrUpperConstraint, IdSink &sink);
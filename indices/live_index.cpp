@@ -3,11 +3,16 @@
 
 
 template <class T>
-LiveIndexCapacityConstrainted<T>::LiveIndexCapacityConstrainted(size_t maxCapacity)
+LiveIndexCapacityConstrainted<T>::LiveIndexCapacityConstrainted(size_t maxCapacity) : directory(maxCapacity)
 {
     this->maxCapacity = maxCapacity;
     this->minCapacity = ceil(this->maxCapacity*0.4);
     this->merged = false;
+    this->firstRecordId = this->nextRecordId = 0;
+    this->numRetired = 0;
+    this->tuner = NULL;
+    this->reorganizeCursor = 0;
+    this->reorganizing = false;
 
 //    this->buffers.emplace_back(this->maxCapacity);
 //    this->lastBuffer = this->buffers.begin();
@@ -18,12 +23,17 @@ LiveIndexCapacityConstrainted<T>::LiveIndexCapacityConstrainted(size_t maxCapaci
 template <class T>
 void LiveIndexCapacityConstrainted<T>::insert(RecordId id, Timestamp start)
 {
-    // If current (last) buffer is full, we need a new buffer
-    if ((this->buffers.size() == 0) || (this->lastBufferSize == this->maxCapacity))
+    if (this->tuner != NULL)
+        this->tune();
+
+    // If current (last) buffer is full, we need a new buffer; after a reorganization, it may be of another capacity
+    if ((this->buffers.size() == 0) || (this->lastBufferSize >= this->lastBuffer->capacity))
     {
+        this->directory.append(this->buffers.size(), id);
         this->offsets_starts.push_back(start);
         this->offsets_ids.push_back(id);
         this->buffers.emplace_back(this->maxCapacity);
+        this->aggregates.append();
         
 //        this->lastBuffer++;   // why doesn't ++ work??
         this->lastBuffer = (this->buffers.end()-1);
@@ -32,7 +42,17 @@ void LiveIndexCapacityConstrainted<T>::insert(RecordId id, Timestamp start)
 //        cout<<"\tNEW buffer created" << endl;
 //        this->print('r');
     }
+    // Locating buffers by (id-firstRecordId)/maxCapacity requires dense ids, e.g., not the case for a shard of the ids
+    if (!this->merged)
+    {
+        if ((this->buffers.size() == 1) && (this->lastBufferSize == 0))
+            this->firstRecordId = id;
+        else if (id != this->nextRecordId)
+            this->merged = true;
+        this->nextRecordId = id+1;
+    }
     this->lastBuffer->insert(id, start);
+    this->aggregates.insert(this->buffers.size()-1, id);
     this->lastBufferSize++;
 //    this->latestStart = start;
 //    cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
@@ -43,11 +63,13 @@ template <class T>
 void LiveIndexCapacityConstrainted<T>::insert_secAttr(RecordId id, Timestamp start, int secAttr)
 {
     // If current (last) buffer is full, we need a new buffer
-    if ((this->buffers.size() == 0) || (this->lastBufferSize == this->maxCapacity))
+    if ((this->buffers.size() == 0) || (this->lastBufferSize >= this->lastBuffer->capacity))
     {
+        this->directory.append(this->buffers.size(), id);
         this->offsets_starts.push_back(start);
         this->offsets_ids.push_back(id);
         this->buffers.emplace_back(this->maxCapacity);
+        this->aggregates.append();
         
 //        this->lastBuffer++;   // why doesn't ++ work??
         this->lastBuffer = (this->buffers.end()-1);
@@ -58,6 +80,7 @@ void LiveIndexCapacityConstrainted<T>::insert_secAttr(RecordId id, Timestamp sta
     }
     // this->lastBuffer->insert(id, start);
     this->lastBuffer->insert_secAttr(id, start, secAttr);
+    this->aggregates.insert(this->buffers.size()-1, id);
     this->lastBufferSize++;
 //    this->latestStart = start;
    // cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
@@ -74,16 +97,23 @@ Timestamp LiveIndexCapacityConstrainted<T>::remove(RecordId id)
 
     // First locate the buffer that contains the record.
     if (!merged)
-        bid = id/this->maxCapacity;
+        bid = (id-this->firstRecordId)/this->maxCapacity;
     else
     {
-        vector<RecordId>::iterator pivot = lower_bound(this->offsets_ids.begin(), this->offsets_ids.end(), id+1);
-        bid = (pivot-1-this->offsets_ids.begin());
+        bid = this->locateBuffer(id);
     }
 
     // Remove record from buffer bid.
 
     start = this->buffers[bid].remove(id);
+    this->aggregates.remove(bid, id);
+
+    // Recycle a drained buffer, except for the one being filled
+    if ((bid != this->buffers.size()-1) && (this->buffers[bid].getSize() == 0))
+        this->retireBuffer(bid);
+
+    if (this->tuner != NULL)
+        this->tune();
 
 //     // Merge bid with one of the adjacent buffers if its capacity dropped below the minCapacity threshold.
 //     bsize = this->buffers[bid].getSize();
@@ -122,26 +152,28 @@ Timestamp LiveIndexCapacityConstrainted<T>::remove_secAttr(RecordId id)
     //     bid = id/this->maxCapacity;
     // else
     // {
-        vector<RecordId>::iterator pivot = lower_bound(this->offsets_ids.begin(), this->offsets_ids.end(), id+1);
-        bid = (pivot-1-this->offsets_ids.begin());
+        bid = this->locateBuffer(id);
     // }
     // Remove record from buffer bid.
     // cout << bid << " " << id << endl;
     start = this->buffers[bid].remove_secAttr(id);
+    this->aggregates.remove(bid, id);
     // cout << bid << " " << id << endl;
 
     // Merge bid with one of the adjacent buffers if its capacity dropped below the minCapacity threshold.
     bsize = this->buffers[bid].getSize();
-    if ((this->buffers.size() > 1) && (bsize < this->minCapacity))
+    if ((bsize == 0) && (bid != this->buffers.size()-1))
+        this->retireBuffer(bid);
+    else if ((this->buffers.size() > 1) && (bsize < this->minCapacity))
     {
-        // bid-1
-        if ((bid > 1) && (bsize+this->buffers[bid-1].getSize() < this->maxCapacity))
+        // bid-1; empty neighbours are skipped, they are retired
+        if ((bid > 1) && (this->buffers[bid-1].getSize() > 0) && (bsize+this->buffers[bid-1].getSize() < this->buffers[bid-1].capacity))
         {
 //            cout << "\t\t\tMerge Buffer" << bid << " (" << bsize << ") with Buffer" << (bid-1) << " (" << this->buffers[bid-1].getSize() << ")" << endl;
             this->mergeBuffers_secAttr(bid-1, bid);
         }
         // bid+1
-        else if ((bid+1 < this->buffers.size()) && (bsize+this->buffers[bid+1].getSize() < this->maxCapacity))
+        else if ((bid+1 < this->buffers.size()) && (this->buffers[bid+1].getSize() > 0) && (bsize+this->buffers[bid+1].getSize() < this->buffers[bid].capacity))
         {
 //            cout << "\t\t\tMerge Buffer" << bid << " (" << bsize << ") with Buffer" << (bid+1) << " (" << this->buffers[bid+1].getSize() << ")" << endl;
             this->mergeBuffers_secAttr(bid, bid+1);
@@ -160,41 +192,146 @@ size_t LiveIndexCapacityConstrainted<T>::getNumBuffers()
 }
 
 
+template <class T>
+size_t LiveIndexCapacityConstrainted<T>::getMemoryUsage()
+{
+    size_t bytes = this->buffers.capacity()*sizeof(T) + this->offsets_starts.capacity()*sizeof(Timestamp) + this->offsets_ids.capacity()*sizeof(RecordId) + this->directory.getMemoryUsage() + this->aggregates.getMemoryUsage();
+
+    for (auto i = 0; i < this->buffers.size(); i++)
+        bytes += this->buffers[i].getMemoryUsage();
+
+    return bytes;
+}
+
+
 
+// Frees buffers [from, to), e.g., merged into another or drained, and drops them with their offsets.
 template <class T>
-void LiveIndexCapacityConstrainted<T>::mergeBuffers(size_t from, size_t to)
+void LiveIndexCapacityConstrainted<T>::eraseBuffers(size_t from, size_t to)
 {
-    typename vector<T>::iterator iterBBegin  = this->buffers.begin()+to;
-    vector<Timestamp>::iterator  iterOSBegin = this->offsets_starts.begin()+to;
-    vector<RecordId>::iterator   iterOIBegin = this->offsets_ids.begin()+to;
+    for (auto b = from; b < to; b++)
+        this->buffers[b].destroy();
 
-    this->buffers[from].insert(*iterBBegin);
+    this->buffers.erase(this->buffers.begin()+from, this->buffers.begin()+to);
+    this->offsets_starts.erase(this->offsets_starts.begin()+from, this->offsets_starts.begin()+to);
+    this->offsets_ids.erase(this->offsets_ids.begin()+from, this->offsets_ids.begin()+to);
+    this->directory.erase(from, to);
+    this->aggregates.erase(from, to);
 
-    this->buffers.erase(iterBBegin, iterBBegin+1);
-    this->offsets_starts.erase(iterOSBegin, iterOSBegin+1);
-    this->offsets_ids.erase(iterOIBegin, iterOIBegin+1);
-    
     this->lastBuffer = (this->buffers.end()-1);
-    this->lastBufferSize = this->lastBuffer->getSize();
     this->merged = true;
 }
 
+
+// Empties buffer bid, e.g., merged into another or drained, without splicing it out of the buffers and their
+// offsets; empty buffers are dropped together by sweepBuffers(), once they make up half of the buffers. Only the
+// last buffer is erased on the spot, as this costs nothing.
+// The sweep is amortized on purpose: the update that triggers it pays O(#buffers), but at least #buffers/2
+// retirements precede it, i.e., O(1) per update. Dropping at most k buffers per update would not bound the update
+// either, as the offsets, the directory and the aggregate tree are indexed by buffer position, and shift on every
+// erase before the last buffer.
 template <class T>
-void LiveIndexCapacityConstrainted<T>::mergeBuffers_secAttr(size_t from, size_t to)
+void LiveIndexCapacityConstrainted<T>::retireBuffer(size_t bid)
+{
+    if (bid == this->buffers.size()-1)
+    {
+        this->eraseBuffers(bid, bid+1);
+        return;
+    }
+
+    this->emptyBuffer(bid);
+    if (2*this->numRetired > this->buffers.size())
+        this->sweepBuffers();
+}
+
+
+// Entries of a merged buffer moved to its predecessor, which now holds starts up to the lowest start of the next
+// buffer; taking on that start keeps queries from picking the emptied buffer as their last one.
+template <class T>
+void LiveIndexCapacityConstrainted<T>::emptyBuffer(size_t bid)
 {
-    typename vector<T>::iterator iterBBegin  = this->buffers.begin()+to;
-    vector<Timestamp>::iterator  iterOSBegin = this->offsets_starts.begin()+to;
-    vector<RecordId>::iterator   iterOIBegin = this->offsets_ids.begin()+to;
+    if (this->buffers[bid].getSize() > 0)
+    {
+        this->buffers[bid].destroy();
+        this->buffers[bid] = T(1);
+        this->offsets_starts[bid] = this->offsets_starts[bid+1];
+    }
+    this->merged = true;
+    this->numRetired++;
+}
 
-    this->buffers[from].insert_secAttr(*iterBBegin);
 
-    this->buffers.erase(iterBBegin, iterBBegin+1);
-    this->offsets_starts.erase(iterOSBegin, iterOSBegin+1);
-    this->offsets_ids.erase(iterOIBegin, iterOIBegin+1);
-    
+// Drops all empty buffers except for the last one, in a single pass over the buffers and their offsets; nothing to
+// do if no buffer was retired since the last sweep.
+template <class T>
+void LiveIndexCapacityConstrainted<T>::sweepBuffers()
+{
+    size_t numBuffers = this->buffers.size(), b = 0, cursor = this->reorganizeCursor;
+
+
+    if ((numBuffers == 0) || (this->numRetired == 0))
+        return;
+
+    for (auto i = 0; i < numBuffers; i++)
+    {
+        if ((this->buffers[i].getSize() == 0) && (i != numBuffers-1))
+        {
+            this->buffers[i].destroy();
+            if (i < this->reorganizeCursor)
+                cursor--;
+            continue;
+        }
+
+        if (b != i)
+        {
+            this->buffers[b] = move(this->buffers[i]);
+            this->offsets_starts[b] = this->offsets_starts[i];
+            this->offsets_ids[b] = this->offsets_ids[i];
+        }
+        b++;
+    }
+    this->buffers.erase(this->buffers.begin()+b, this->buffers.end());
+    this->offsets_starts.resize(b);
+    this->offsets_ids.resize(b);
+    this->directory.rebuild(this->offsets_ids);
+    this->aggregates.sweep();
+
     this->lastBuffer = (this->buffers.end()-1);
+    this->numRetired = 0;
+    this->reorganizeCursor = cursor;
+}
+
+
+// The buffer holding id is the last one starting not after it or, if that one was retired after a merge, its
+// closest non-empty predecessor, as merges move entries only towards the front.
+template <class T>
+size_t LiveIndexCapacityConstrainted<T>::locateBuffer(RecordId id)
+{
+    size_t bid = this->directory.locate(id, this->offsets_ids);
+
+    while ((bid > 0) && (this->buffers[bid].getSize() == 0))
+        bid--;
+
+    return bid;
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::mergeBuffers(size_t from, size_t to)
+{
+    this->buffers[from].insert(this->buffers[to]);
+    this->aggregates.transfer(to, from);
+    this->retireBuffer(to);
+    this->lastBufferSize = this->lastBuffer->getSize();
+}
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::mergeBuffers_secAttr(size_t from, size_t to)
+{
+    this->buffers[from].insert_secAttr(this->buffers[to]);
+    this->aggregates.transfer(to, from);
+    this->retireBuffer(to);
     this->lastBufferSize = this->lastBuffer->getSize();
-    this->merged = true;
 }
 
 template <class T>
@@ -205,6 +342,8 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers()
 
 
 //    cout << endl << "\tMerging buffers" << endl;
+    // A pass over all buffers anyway, so sweeping first does not change its cost
+    this->sweepBuffers();
     while (b < this->buffers.size())
     {
         auto bsize = this->buffers[b].getSize();
@@ -219,10 +358,6 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers()
 //                cout << "\t\t\tMerge from Buffer" << from << " to Buffer" << (b-1) << " with " << collectiveSize << " collective size" << endl;
                 typename vector<T>::iterator iterBBegin = this->buffers.begin()+(from+1);
                 typename vector<T>::iterator iterBEnd   = this->buffers.begin()+b;
-                vector<Timestamp>::iterator  iterOSBegin = this->offsets_starts.begin()+(from+1);
-                vector<Timestamp>::iterator  iterOSEnd   = this->offsets_starts.begin()+b;
-                vector<RecordId>::iterator   iterOIBegin = this->offsets_ids.begin()+(from+1);
-                vector<RecordId>::iterator   iterOIEnd   = this->offsets_ids.begin()+b;
 
                 auto i = from+1;
                 for (auto iter = iterBBegin; iter != iterBEnd; iter++)
@@ -232,11 +367,10 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers()
 //                    cout << "\t\t\terase b" << i << ": " << iter->getSize() << endl;
                     i++;
                     this->buffers[from].insert((*iter));
+                    this->aggregates.transfer(iter-this->buffers.begin(), from);
                     b--;
                 }
-                this->buffers.erase(iterBBegin, iterBEnd);
-                this->offsets_starts.erase(iterOSBegin, iterOSEnd);
-                this->offsets_ids.erase(iterOIBegin, iterOIEnd);
+                this->eraseBuffers(iterBBegin-this->buffers.begin(), iterBEnd-this->buffers.begin());
             }
             collectiveSize = bsize;
             from = b;
@@ -260,10 +394,6 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers()
 //            cout << "\t\t\tMerge from Buffer" << from << " to Buffer" << (b-1) << " with " << collectiveSize << " collective size" << endl;
             typename vector<T>::iterator iterBBegin = this->buffers.begin()+(from+1);
             typename vector<T>::iterator iterBEnd   = this->buffers.begin()+b;
-            vector<Timestamp>::iterator  iterOSBegin = this->offsets_starts.begin()+(from+1);
-            vector<Timestamp>::iterator  iterOSEnd   = this->offsets_starts.begin()+b;
-            vector<RecordId>::iterator   iterOIBegin = this->offsets_ids.begin()+(from+1);
-            vector<RecordId>::iterator   iterOIEnd   = this->offsets_ids.begin()+b;
 
             auto i = from+1;
             for (auto iter = iterBBegin; iter != iterBEnd; iter++)
@@ -273,10 +403,9 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers()
 //                cout << "\t\t\terase b" << i << ": " << iter->getSize() << endl;
                 i++;
                 this->buffers[from].insert((*iter));
+                this->aggregates.transfer(iter-this->buffers.begin(), from);
             }
-            this->buffers.erase(iterBBegin, iterBEnd);
-            this->offsets_starts.erase(iterOSBegin, iterOSEnd);
-            this->offsets_ids.erase(iterOIBegin, iterOIEnd);
+            this->eraseBuffers(iterBBegin-this->buffers.begin(), iterBEnd-this->buffers.begin());
         }
     }
 
@@ -286,104 +415,121 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers()
 }
 
 
+// Switches to buffers of maxCapacity: the buffer being filled is closed, and the others are coalesced into buffers
+// of maxCapacity by reorganizeStep(), one run of them per update. Buffers above maxCapacity are kept as they are.
+// The tuner calls it at the end of a window, right after a pass over all buffers (see tune()), so the sweep does
+// not change the cost of that update.
 template <class T>
 void LiveIndexCapacityConstrainted<T>::reorganize(size_t maxCapacity)
 {
-    auto collectiveSize = 0;
-    auto b = 0, from = 0, to = 0;
+    this->sweepBuffers();
+    if ((maxCapacity != this->maxCapacity) && (!this->buffers.empty()))
+        this->lastBufferSize = this->lastBuffer->capacity;
+    this->maxCapacity = maxCapacity;
+    this->minCapacity = ceil(this->maxCapacity*0.4);
+    this->merged = true;
 
+    this->reorganizeCursor = 0;
+    this->reorganizing = true;
+}
 
-//    cout << endl << "\tMerging buffers" << endl;
-    this->maxCapacity = maxCapacity;
-    while (b < this->buffers.size())
+
+// Coalesces the next run of consecutive buffers that fits in one buffer of maxCapacity, i.e., moves at most
+// maxCapacity entries; the buffer being filled is left out.
+template <class T>
+void LiveIndexCapacityConstrainted<T>::reorganizeStep()
+{
+    size_t last = this->buffers.size()-1, from = this->reorganizeCursor, to, numEntries = 0;
+
+
+    while ((from < last) && (this->buffers[from].getSize() == 0))
+        from++;
+    if (from >= last)
     {
-        auto bsize = this->buffers[b].getSize();
-        
-        // If merging also with current buffer will exceed the maxCapacity constraint then merge only the previous buffers, and continue
-        cout << "\t\tBuffer" << b << ": " << this->buffers[b].getSize() << ", |B| = " << this->buffers.size() << ", collectiveSize = " << collectiveSize << endl;
-        if (collectiveSize+bsize > this->maxCapacity)
-        {
-            // Merging occurs only for at least two concecutive buffers.
-            if (b-1 > from)
-            {
-//                cout << "\t\t\tMerge from Buffer" << from << " to Buffer" << (b-1) << " with " << collectiveSize << " collective size" << endl;
-                T newB;
-                typename vector<T>::iterator iterBBegin = this->buffers.begin()+(from);
-                typename vector<T>::iterator iterBEnd   = this->buffers.begin()+b;
-                vector<Timestamp>::iterator  iterOSBegin = this->offsets_starts.begin()+(from);
-                vector<Timestamp>::iterator  iterOSEnd   = this->offsets_starts.begin()+b;
-                vector<RecordId>::iterator   iterOIBegin = this->offsets_ids.begin()+(from);
-                vector<RecordId>::iterator   iterOIEnd   = this->offsets_ids.begin()+b;
+        this->reorganizing = false;
+        return;
+    }
 
-                auto i = from;
-                for (auto iter = iterBBegin; iter != iterBEnd; iter++)
-//                auto U = b;
-//                for (auto i = from+1; i < U; i++)
-                {
-//                    cout << "\t\t\terase b" << i << ": " << iter->getSize() << endl;
-                    i++;
-                    newB.insert((*iter));
-                    b--;
-                }
-                this->buffers.erase(iterBBegin, iterBEnd);
-                this->offsets_starts.erase(iterOSBegin, iterOSEnd);
-                this->offsets_ids.erase(iterOIBegin, iterOIEnd);
-            }
-            collectiveSize = bsize;
-            from = b;
+    to = from;
+    while ((to < last) && (numEntries+this->buffers[to].getSize() <= this->maxCapacity))
+        numEntries += this->buffers[to++].getSize();
+    this->reorganizeCursor = max(to, from+1);
+
+    if (to-from > 1)
+    {
+        T newB(this->maxCapacity);
+
+        for (auto b = from; b < to; b++)
+        {
+            newB.insert(this->buffers[b]);
+            if (b > from)
+                this->aggregates.transfer(b, from);
         }
-        else
+        this->buffers[from].destroy();
+        this->buffers[from] = move(newB);
+
+        // Back to front, so that every emptied buffer takes on the lowest start of the next; so do the ones drained
+        // before, as from now holds entries that start after their own lowest start
+        for (auto b = to-1; b > from; b--)
         {
-            collectiveSize += bsize;
+            if (this->buffers[b].getSize() > 0)
+                this->emptyBuffer(b);
+            else
+                this->offsets_starts[b] = this->offsets_starts[b+1];
         }
 
-        b++;
+        if (2*this->numRetired > this->buffers.size())
+            this->sweepBuffers();
     }
-    
-    // Merging with the last buffer.
-//    cout << "from = " << from << "\tb = " << b << "\tcollectiveSize = " << collectiveSize << "\tthis->buffers.size() = " << this->buffers.size() << endl;
-    if (collectiveSize < this->maxCapacity)
-    {
-        // Merging occurs only for at least two concecutive buffers.
-        if (b-1 > from)
-        {
-            cout << "\t\tBuffer" << b-1 << ": " << this->buffers[b-1].getSize() << ", |B| = " << this->buffers.size() << ", collectiveSize = " << collectiveSize << endl;
-            cout << "\t\t\tMerge from Buffer" << from << " to Buffer" << (b-1) << " with " << collectiveSize << " collective size" << endl;
+}
 
-            T newB;
-            typename vector<T>::iterator iterBBegin = this->buffers.begin()+(from);
-            typename vector<T>::iterator iterBEnd   = this->buffers.begin()+b;
-            vector<Timestamp>::iterator  iterOSBegin = this->offsets_starts.begin()+(from);
-            vector<Timestamp>::iterator  iterOSEnd   = this->offsets_starts.begin()+b;
-            vector<RecordId>::iterator   iterOIBegin = this->offsets_ids.begin()+(from);
-            vector<RecordId>::iterator   iterOIEnd   = this->offsets_ids.begin()+b;
-            Timestamp minStart = (*iterOSBegin);
-            RecordId minId = (*iterOIBegin);
 
-            auto i = from+1;
-            for (auto iter = iterBBegin; iter != iterBEnd; iter++)
-//                auto U = b;
-//                for (auto i = from+1; i < U; i++)
-            {
-//                cout << "\t\t\terase b" << i << ": " << iter->getSize() << endl;
-                i++;
-                newB.insert((*iter));
-            }
-            this->buffers.erase(iterBBegin, iterBEnd);
-            this->offsets_starts.erase(iterOSBegin, iterOSEnd);
-            this->offsets_ids.erase(iterOIBegin, iterOIEnd);
-            
-            this->buffers.push_back(newB);
-            this->offsets_starts.push_back(minStart);
-            this->offsets_ids.push_back(minId);
-            cout << this->buffers.size() << endl;
-            cout << newB.getSize() << endl;
+// Closes the window of the tuner every getWindowSize() updates and applies its decision; meanwhile, advances the
+// reorganization, if any.
+template <class T>
+void LiveIndexCapacityConstrainted<T>::tune()
+{
+    size_t capacity;
+    bool compact;
+
+
+    if (this->reorganizing)
+        this->reorganizeStep();
+
+    if (++this->window.numUpdates < this->tuner->getWindowSize())
+        return;
+
+    for (auto b = 0; b < this->buffers.size(); b++)
+    {
+        size_t bsize = this->buffers[b].getSize();
+
+        if (bsize > 0)
+        {
+            this->window.numBuffers++;
+            this->window.numEntries += bsize;
+            this->window.sumCapacities += this->buffers[b].capacity;
         }
     }
 
-    this->lastBuffer = (this->buffers.end()-1);
-    this->lastBufferSize = this->lastBuffer->getSize();
-    this->merged = true;
+    capacity = this->tuner->decide(this->maxCapacity, this->window, compact);
+    if (compact)
+        this->reorganize(capacity);
+    this->window = LiveIndexWindow();
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::setTuner(LiveIndexTuner *tuner)
+{
+    this->tuner = tuner;
+    this->window = LiveIndexWindow();
+}
+
+
+template <class T>
+size_t LiveIndexCapacityConstrainted<T>::getCapacity()
+{
+    return this->maxCapacity;
 }
 
 
@@ -456,119 +602,264 @@ LiveIndexCapacityConstrainted<T>::~LiveIndexCapacityConstrainted()
 
 
 template <class T>
-size_t LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q)
+template <class S>
+void LiveIndexCapacityConstrainted<T>::executeSink_pureTimeTravel(RangeQuery Q, S &sink)
 {
-    size_t result = 0;
     vector<Timestamp>::iterator iterO    = this->offsets_starts.begin();
     vector<Timestamp>::iterator iterOEnd = lower_bound(iterO, this->offsets_starts.end(), Q.end+1);
     typename vector<T>::iterator iterB   = this->buffers.begin();
     typename vector<T>::iterator pivot   = iterB+(iterOEnd-iterO-1);
-//    size_t cnt = 0;
 
 
-    // Comparisons are needed only at the last buffer - contents sorted on start by construction.
-    while (iterB != pivot)
+    // No buffer holds a start before the end of the query
+    if (iterOEnd == iterO)
+        return;
+
+    // Observed by the tuner: the buffers visited, the entries reported as they are and those compared on start
+    if (this->tuner != NULL)
     {
-        result ^= iterB->execute_gOverlaps();
-        iterB++;
-//        cnt++;
+        this->window.numQueries++;
+        this->window.numBuffersScanned += pivot-iterB+1;
+        for (auto iter = iterB; iter != pivot; iter++)
+            this->window.numEntriesScanned += iter->getSize();
+        this->window.numEntriesCompared += pivot->getSize();
     }
 
-    result ^= iterB->execute_gOverlaps(Q);
+    // Comparisons are needed only at the last buffer - contents sorted on start by construction.
+    this->executeSink_coveredBuffers(pivot-iterB, sink);
+    pivot->execute_gOverlaps(Q, sink);
+}
 
 
-    return result;
+// The first numBuffers buffers qualify as a whole
+template <class T>
+template <class S>
+void LiveIndexCapacityConstrainted<T>::executeSink_coveredBuffers(size_t numBuffers, S &sink)
+{
+    for (auto b = 0; b < numBuffers; b++)
+        this->buffers[b].execute_gOverlaps(sink);
 }
 
 
 template <class T>
-size_t LiveIndexCapacityConstrainted<T>::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint)
+void LiveIndexCapacityConstrainted<T>::executeSink_coveredBuffers(size_t numBuffers, CountSink &sink)
+{
+    sink.result += this->aggregates.getCount(numBuffers);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::executeSink_coveredBuffers(size_t numBuffers, XorSink &sink)
+{
+    sink.add(this->aggregates.getXor(numBuffers));
+}
+
+
+template <class T>
+size_t LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->executeSink_pureTimeTravel(Q, sink);
+
+    return sink.getResult();
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, CountSink &sink)
+{
+    this->executeSink_pureTimeTravel(Q, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, XorSink &sink)
+{
+    this->executeSink_pureTimeTravel(Q, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, IdSink &sink)
+{
+    this->executeSink_pureTimeTravel(Q, sink);
+}
+
+
+template <class T>
+template <class S>
+void LiveIndexCapacityConstrainted<T>::executeSink_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     vector<Timestamp>::iterator iter    = this->offsets_starts.begin();
     vector<Timestamp>::iterator iterEnd = lower_bound(iter, this->offsets_starts.end(), Q.end+1);
     typename vector<T>::iterator iterB  = this->buffers.begin();
     typename vector<T>::iterator pivot = iterB+(iterEnd-iter-1);
 
 
+    // No buffer holds a start before the end of the query
+    if (iterEnd == iter)
+        return;
+
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-#ifdef WORKLOAD_COUNT
-        result += iterB->executeTimeTravel(secondAttrLowerConstraint, secondAttrUpperConstraint);
-#else
-        result ^= iterB->executeTimeTravel(secondAttrLowerConstraint, secondAttrUpperConstraint);
-#endif
+        iterB->executeTimeTravel(secondAttrLowerConstraint, secondAttrUpperConstraint, sink);
         iterB++;
     }
-#ifdef WORKLOAD_COUNT
-    result += iterB->executeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint);
-#else
-    result ^= iterB->executeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint);
-#endif
-    return result;
+    iterB->executeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint, sink);
 }
 
+
 template <class T>
-size_t LiveIndexCapacityConstrainted<T>::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint)
+size_t LiveIndexCapacityConstrainted<T>::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint)
+{
+    WorkloadSink sink;
+
+    this->executeSink_rangeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint, sink);
+
+    return sink.getResult();
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, CountSink &sink)
+{
+    this->executeSink_rangeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, XorSink &sink)
+{
+    this->executeSink_rangeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, IdSink &sink)
+{
+    this->executeSink_rangeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint, sink);
+}
+
+
+template <class T>
+template <class S>
+void LiveIndexCapacityConstrainted<T>::executeSink_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink)
 {
-    size_t result = 0;
     vector<Timestamp>::iterator iter    = this->offsets_starts.begin();
     vector<Timestamp>::iterator iterEnd = lower_bound(iter, this->offsets_starts.end(), Q.end+1);
     typename vector<T>::iterator iterB  = this->buffers.begin();
     typename vector<T>::iterator pivot = iterB+(iterEnd-iter-1);
 
 
+    // No buffer holds a start before the end of the query
+    if (iterEnd == iter)
+        return;
+
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-#ifdef WORKLOAD_COUNT
-        result += iterB->executeTimeTravel_greaterthan(secondAttrLowerConstraint);
-#else
-        result ^= iterB->executeTimeTravel_greaterthan(secondAttrLowerConstraint);
-#endif
+        iterB->executeTimeTravel_greaterthan(secondAttrLowerConstraint, sink);
         iterB++;
     }
-#ifdef WORKLOAD_COUNT
-    result += iterB->executeTimeTravel_greaterthan(Q, secondAttrLowerConstraint);
-#else
-    result ^= iterB->executeTimeTravel_greaterthan(Q, secondAttrLowerConstraint);
-#endif
-    return result;
+    iterB->executeTimeTravel_greaterthan(Q, secondAttrLowerConstraint, sink);
 }
 
+
 template <class T>
-size_t LiveIndexCapacityConstrainted<T>::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint)
+size_t LiveIndexCapacityConstrainted<T>::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint)
+{
+    WorkloadSink sink;
+
+    this->executeSink_greaterthan(Q, secondAttrLowerConstraint, sink);
+
+    return sink.getResult();
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, CountSink &sink)
+{
+    this->executeSink_greaterthan(Q, secondAttrLowerConstraint, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, XorSink &sink)
+{
+    this->executeSink_greaterthan(Q, secondAttrLowerConstraint, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, IdSink &sink)
+{
+    this->executeSink_greaterthan(Q, secondAttrLowerConstraint, sink);
+}
+
+
+template <class T>
+template <class S>
+void LiveIndexCapacityConstrainted<T>::executeSink_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink)
 {
-    size_t result = 0;
     vector<Timestamp>::iterator iter    = this->offsets_starts.begin();
     vector<Timestamp>::iterator iterEnd = lower_bound(iter, this->offsets_starts.end(), Q.end+1);
     typename vector<T>::iterator iterB  = this->buffers.begin();
     typename vector<T>::iterator pivot = iterB+(iterEnd-iter-1);
 
 
+    // No buffer holds a start before the end of the query
+    if (iterEnd == iter)
+        return;
+
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-#ifdef WORKLOAD_COUNT
-        result += iterB->executeTimeTravel_lowerthan(secondAttrUpperConstraint);
-#else
-        result ^= iterB->executeTimeTravel_lowerthan(secondAttrUpperConstraint);
-#endif
+        iterB->executeTimeTravel_lowerthan(secondAttrUpperConstraint, sink);
         iterB++;
     }
-#ifdef WORKLOAD_COUNT
-    result += iterB->executeTimeTravel_lowerthan(Q, secondAttrUpperConstraint);
-#else
-    result ^= iterB->executeTimeTravel_lowerthan(Q, secondAttrUpperConstraint);
-#endif
-    return result;
+    iterB->executeTimeTravel_lowerthan(Q, secondAttrUpperConstraint, sink);
+}
+
+
+template <class T>
+size_t LiveIndexCapacityConstrainted<T>::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint)
+{
+    WorkloadSink sink;
+
+    this->executeSink_lowerthan(Q, secondAttrUpperConstraint, sink);
+
+    return sink.getResult();
 }
 
+
 template <class T>
-LiveIndexDurationConstrainted<T>::LiveIndexDurationConstrainted(Timestamp duration)
+void LiveIndexCapacityConstrainted<T>::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, CountSink &sink)
+{
+    this->executeSink_lowerthan(Q, secondAttrUpperConstraint, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, XorSink &sink)
+{
+    this->executeSink_lowerthan(Q, secondAttrUpperConstraint, sink);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, IdSink &sink)
+{
+    this->executeSink_lowerthan(Q, secondAttrUpperConstraint, sink);
+}
+
+
+template <class T>
+LiveIndexDurationConstrainted<T>::LiveIndexDurationConstrainted(Timestamp duration) : directory(BUFFER_DIRECTORY_BLOCK_SIZE)
 {
     this->duration = duration;
+    this->numRetired = 0;
 }
 
 
@@ -578,9 +869,11 @@ void LiveIndexDurationConstrainted<T>::insert(RecordId id, Timestamp start)
     // If current (last) buffer is full, we need a new buffer
     if ((this->buffers.size() == 0) || (start > this->lastBufferEnd))
     {
+        this->directory.append(this->buffers.size(), id);
         this->offsets_starts.push_back(start);
         this->offsets_ids.push_back(id);
         this->buffers.emplace_back();
+        this->aggregates.append();
         
         auto bid = ceil((float)start/this->duration);  // Id of the buffer to store the id
         this->lastBuffer = (this->buffers.end()-1);
@@ -589,6 +882,7 @@ void LiveIndexDurationConstrainted<T>::insert(RecordId id, Timestamp start)
 //        cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
     }
     this->lastBuffer->insert(id, start);
+    this->aggregates.insert(this->buffers.size()-1, id);
 //    cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
 }
 
@@ -596,15 +890,69 @@ void LiveIndexDurationConstrainted<T>::insert(RecordId id, Timestamp start)
 template <class T>
 Timestamp LiveIndexDurationConstrainted<T>::remove(RecordId id)
 {
-    vector<RecordId>::iterator pivot = lower_bound(this->offsets_ids.begin(), this->offsets_ids.end(), id+1);
-    auto bid = (pivot-1-this->offsets_ids.begin());
+    auto bid = this->directory.locate(id, this->offsets_ids);
     Timestamp start = this->buffers[bid].remove(id);
+    this->aggregates.remove(bid, id);
     
 
+    // Recycle a drained buffer, except for the one being filled
+    if ((bid != this->buffers.size()-1) && (this->buffers[bid].getSize() == 0))
+        this->retireBuffer(bid);
+
     return start;
 }
 
 
+// Drained buffers stay in place until they make up half of the buffers; then sweepBuffers() drops them together,
+// i.e., O(1) amortized per update, see LiveIndexCapacityConstrainted::retireBuffer().
+template <class T>
+void LiveIndexDurationConstrainted<T>::retireBuffer(size_t bid)
+{
+    this->numRetired++;
+
+    if (2*this->numRetired > this->buffers.size())
+        this->sweepBuffers();
+}
+
+
+// Drops all empty buffers except for the last one, in a single pass over the buffers and their offsets; nothing to
+// do if no buffer was drained since the last sweep.
+template <class T>
+void LiveIndexDurationConstrainted<T>::sweepBuffers()
+{
+    size_t numBuffers = this->buffers.size(), b = 0;
+
+
+    if ((numBuffers == 0) || (this->numRetired == 0))
+        return;
+
+    for (auto i = 0; i < numBuffers; i++)
+    {
+        if ((this->buffers[i].getSize() == 0) && (i != numBuffers-1))
+        {
+            this->buffers[i].destroy();
+            continue;
+        }
+
+        if (b != i)
+        {
+            this->buffers[b] = move(this->buffers[i]);
+            this->offsets_starts[b] = this->offsets_starts[i];
+            this->offsets_ids[b] = this->offsets_ids[i];
+        }
+        b++;
+    }
+    this->buffers.erase(this->buffers.begin()+b, this->buffers.end());
+    this->offsets_starts.resize(b);
+    this->offsets_ids.resize(b);
+    this->directory.rebuild(this->offsets_ids);
+    this->aggregates.sweep();
+
+    this->lastBuffer = (this->buffers.end()-1);
+    this->numRetired = 0;
+}
+
+
 template <class T>
 size_t LiveIndexDurationConstrainted<T>::getNumBuffers()
 {
@@ -612,6 +960,18 @@ size_t LiveIndexDurationConstrainted<T>::getNumBuffers()
 }
 
 
+template <class T>
+size_t LiveIndexDurationConstrainted<T>::getMemoryUsage()
+{
+    size_t bytes = this->buffers.capacity()*sizeof(T) + this->offsets_starts.capacity()*sizeof(Timestamp) + this->offsets_ids.capacity()*sizeof(RecordId) + this->directory.getMemoryUsage() + this->aggregates.getMemoryUsage();
+
+    for (auto i = 0; i < this->buffers.size(); i++)
+        bytes += this->buffers[i].getMemoryUsage();
+
+    return bytes;
+}
+
+
 template <class T>
 void LiveIndexDurationConstrainted<T>::mergeBuffers()
 {
@@ -654,26 +1014,83 @@ LiveIndexDurationConstrainted<T>::~LiveIndexDurationConstrainted()
 
 
 template <class T>
-size_t LiveIndexDurationConstrainted<T>::execute_gOverlaps(RangeQuery Q)
+template <class S>
+void LiveIndexDurationConstrainted<T>::executeSink_pureTimeTravel(RangeQuery Q, S &sink)
 {
-    size_t result = 0;
     vector<Timestamp>::iterator iter    = this->offsets_starts.begin();
     vector<Timestamp>::iterator iterEnd = lower_bound(iter, this->offsets_starts.end(), Q.end+1);
     typename vector<T>::iterator iterB  = this->buffers.begin();
     typename vector<T>::iterator pivot = iterB+(iterEnd-iter-1);
 
 
+    // No buffer holds a start before the end of the query
+    if (iterEnd == iter)
+        return;
+
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
-    while (iterB != pivot)
-    {
-        result ^= iterB->execute_gOverlaps();
-        iterB++;
-    }
-    result ^= iterB->execute_gOverlaps(Q);
-    
-    
-    return result;
+    this->executeSink_coveredBuffers(pivot-iterB, sink);
+    pivot->execute_gOverlaps(Q, sink);
+}
+
+
+// The first numBuffers buffers qualify as a whole
+template <class T>
+template <class S>
+void LiveIndexDurationConstrainted<T>::executeSink_coveredBuffers(size_t numBuffers, S &sink)
+{
+    for (auto b = 0; b < numBuffers; b++)
+        this->buffers[b].execute_gOverlaps(sink);
+}
+
+
+template <class T>
+void LiveIndexDurationConstrainted<T>::executeSink_coveredBuffers(size_t numBuffers, CountSink &sink)
+{
+    sink.result += this->aggregates.getCount(numBuffers);
 }
 
 
+template <class T>
+void LiveIndexDurationConstrainted<T>::executeSink_coveredBuffers(size_t numBuffers, XorSink &sink)
+{
+    sink.add(this->aggregates.getXor(numBuffers));
+}
+
+
+template <class T>
+size_t LiveIndexDurationConstrainted<T>::execute_gOverlaps(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->executeSink_pureTimeTravel(Q, sink);
 
+    return sink.getResult();
+}
+
+
+template <class T>
+size_t LiveIndexDurationConstrainted<T>::execute_pureTimeTravel(RangeQuery Q)
+{
+    return this->execute_gOverlaps(Q);
+}
+
+
+template <class T>
+void LiveIndexDurationConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, CountSink &sink)
+{
+    this->executeSink_pureTimeTravel(Q, sink);
+}
+
+
+template <class T>
+void LiveIndexDurationConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, XorSink &sink)
+{
+    this->executeSink_pureTimeTravel(Q, sink);
+}
+
+
+template <class T>
+void LiveIndexDurationConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, IdSink &sink)
+{
+    this->executeSink_pureTimeTravel(Q, sink);
+}
@@ -3,6 +3,9 @@
 
 #include "../def_global.h"
 #include "../containers/buffer.h"
+#include "../containers/buffer_directory.h"
+#include "../containers/aggregate_tree.h"
+#include "live_index_tuner.h"
 
 
 
@@ -16,17 +19,32 @@ public:
     virtual Timestamp remove_secAttr(RecordId id) {};
     virtual size_t getNumBuffers() {};
     virtual size_t getSize() {};
+    virtual size_t getMemoryUsage() { return 0; };
     virtual void mergeBuffers() {};
     virtual void reorganize(size_t capacity) {};
+    virtual void setTuner(LiveIndexTuner *tuner) {};
+    virtual size_t getCapacity() { return 0; };
 //    virtual void removeEmptyBuffers() {};
     virtual void print(char c) {};
     virtual ~LiveIndex() {};
 
     // Querying
     virtual size_t execute_pureTimeTravel(RangeQuery Q) { return 0; };
+    virtual void execute_pureTimeTravel(RangeQuery Q, CountSink &sink) {};
+    virtual void execute_pureTimeTravel(RangeQuery Q, XorSink &sink) {};
+    virtual void execute_pureTimeTravel(RangeQuery Q, IdSink &sink) {};
     virtual size_t execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint) { return 0; };
+    virtual void execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, CountSink &sink) {};
+    virtual void execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, XorSink &sink) {};
+    virtual void execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, IdSink &sink) {};
     virtual size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint) { return 0; };
+    virtual void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, CountSink &sink) {};
+    virtual void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, XorSink &sink) {};
+    virtual void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, IdSink &sink) {};
     virtual size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint) { return 0; };
+    virtual void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, CountSink &sink) {};
+    virtual void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, XorSink &sink) {};
+    virtual void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, IdSink &sink) {};
 };
 
 
@@ -38,10 +56,33 @@ private:
     size_t maxCapacity, minCapacity;
     vector<Timestamp> offsets_starts;       // On-top auxiliary struct which stores the lowest start per buffer
     vector<RecordId>  offsets_ids;          // On-top auxiliary struct which stores the first id per buffer: to deal with merged buffers
+    BufferDirectory   directory;            // Locates the buffer of an id on removals, once buffers are merged or recycled
+    AggregateTree     aggregates;           // Count and XOR per buffer, for the buffers covered by a query
     vector<T> buffers;
     typename vector<T>::iterator lastBuffer;
     size_t lastBufferSize;
     bool merged;
+    RecordId firstRecordId, nextRecordId;   // While not merged, the ids are firstRecordId, ..., nextRecordId-1
+    size_t numRetired;                      // Buffers emptied since the last sweep, see retireBuffer()
+    LiveIndexTuner *tuner;                  // Optional, retunes maxCapacity online
+    LiveIndexWindow window;
+    size_t reorganizeCursor;                // Next buffer to coalesce, while reorganizing
+    bool reorganizing;
+
+    void eraseBuffers(size_t from, size_t to);
+    void emptyBuffer(size_t bid);
+    void retireBuffer(size_t bid);
+    void sweepBuffers();
+    size_t locateBuffer(RecordId id);
+    void reorganizeStep();
+    void tune();
+    template <class S> void executeSink_pureTimeTravel(RangeQuery Q, S &sink);
+    template <class S> void executeSink_coveredBuffers(size_t numBuffers, S &sink);
+    void executeSink_coveredBuffers(size_t numBuffers, CountSink &sink);
+    void executeSink_coveredBuffers(size_t numBuffers, XorSink &sink);
+    template <class S> void executeSink_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, S &sink);
+    template <class S> void executeSink_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, S &sink);
+    template <class S> void executeSink_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, S &sink);
 
 public:
     LiveIndexCapacityConstrainted(size_t maxCapacity);
@@ -50,19 +91,34 @@ public:
     Timestamp remove(RecordId id);
     Timestamp remove_secAttr(RecordId id);
     size_t getNumBuffers();
+    size_t getMemoryUsage();
     void mergeBuffers(size_t from, size_t to);
     void mergeBuffers_secAttr(size_t from, size_t to);
     void mergeBuffers();
     void reorganize(size_t maxCapacity);
+    void setTuner(LiveIndexTuner *tuner);
+    size_t getCapacity();
 //    void removeEmptyBuffers();
     void print(char c);
     ~LiveIndexCapacityConstrainted();
 
     // Querying
     size_t execute_pureTimeTravel(RangeQuery Q);
+    void execute_pureTimeTravel(RangeQuery Q, CountSink &sink);
+    void execute_pureTimeTravel(RangeQuery Q, XorSink &sink);
+    void execute_pureTimeTravel(RangeQuery Q, IdSink &sink);
     size_t execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint);
+    void execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, CountSink &sink);
+    void execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, XorSink &sink);
+    void execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint, IdSink &sink);
     size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint);
-    size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUppclearerConstraint);
+    void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, CountSink &sink);
+    void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, XorSink &sink);
+    void executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint, IdSink &sink);
+    size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint);
+    void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, CountSink &sink);
+    void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, XorSink &sink);
+    void executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint, IdSink &sink);
 
 };
 
@@ -70,6 +126,8 @@ typedef LiveIndexCapacityConstrainted<Buffer_Map>    LiveIndexCapacityConstraint
 typedef LiveIndexCapacityConstrainted<Buffer_Vector> LiveIndexCapacityConstraintedVector;
 typedef LiveIndexCapacityConstrainted<Buffer_List>   LiveIndexCapacityConstraintedList;
 typedef LiveIndexCapacityConstrainted<Buffer_ICDE16> LiveIndexCapacityConstraintedICDE16;
+typedef LiveIndexCapacityConstrainted<Buffer_Columnar> LiveIndexCapacityConstraintedColumnar;
+typedef LiveIndexCapacityConstrainted<Buffer_Ordered> LiveIndexCapacityConstraintedOrdered;
 
 
 
@@ -80,25 +138,42 @@ private:
     Timestamp duration;
     vector<Timestamp> offsets_starts;       // On-top auxiliary struct which stores the lowest start per buffer: to avoid storing empty buffers
     vector<RecordId>  offsets_ids;          // On-top auxiliary struct which stores the first id per buffer
+    BufferDirectory   directory;            // Locates the buffer of an id on removals
+    AggregateTree     aggregates;           // Count and XOR per buffer, for the buffers covered by a query
     vector<T> buffers;
     typename vector<T>::iterator lastBuffer;
     Timestamp lastBufferEnd;
+    size_t numRetired;                      // Buffers drained since the last sweep, see retireBuffer()
+
+    void retireBuffer(size_t bid);
+    void sweepBuffers();
+    template <class S> void executeSink_pureTimeTravel(RangeQuery Q, S &sink);
+    template <class S> void executeSink_coveredBuffers(size_t numBuffers, S &sink);
+    void executeSink_coveredBuffers(size_t numBuffers, CountSink &sink);
+    void executeSink_coveredBuffers(size_t numBuffers, XorSink &sink);
 
 public:
     LiveIndexDurationConstrainted(Timestamp duration);
     void insert(RecordId id, Timestamp start);
     Timestamp remove(RecordId id);
     size_t getNumBuffers();
+    size_t getMemoryUsage();
     void mergeBuffers();
     void print(char c);
     ~LiveIndexDurationConstrainted();
 
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
+    size_t execute_pureTimeTravel(RangeQuery Q);
+    void execute_pureTimeTravel(RangeQuery Q, CountSink &sink);
+    void execute_pureTimeTravel(RangeQuery Q, XorSink &sink);
+    void execute_pureTimeTravel(RangeQuery Q, IdSink &sink);
 };
 
 typedef LiveIndexDurationConstrainted<Buffer_Map>    LiveIndexDurationConstraintedMap;
 typedef LiveIndexDurationConstrainted<Buffer_Vector> LiveIndexDurationConstraintedVector;
 typedef LiveIndexDurationConstrainted<Buffer_List>   LiveIndexDurationConstraintedList;
 typedef LiveIndexDurationConstrainted<Buffer_ICDE16> LiveIndexDurationConstraintedICDE16;
+typedef LiveIndexDurationConstrainted<Buffer_Columnar> LiveIndexDurationConstraintedColumnar;
+typedef LiveIndexDurationConstrainted<Buffer_Ordered> LiveIndexDurationConstraintedOrdered;
 #endif // _LIVE_INDEX_H_
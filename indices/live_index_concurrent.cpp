@@ -0,0 +1,363 @@
+#include "live_index_concurrent.h"
+
+
+
+ConcurrentBuffer::ConcurrentBuffer(size_t capacity)
+{
+    this->capacity = capacity;
+    this->ids      = array_malloc<RecordId>(capacity);
+    this->starts   = array_malloc<Timestamp>(capacity);
+    this->births   = array_malloc<uint64_t>(capacity);
+    this->deaths   = new atomic<uint64_t>[capacity];
+    this->size     = 0;
+    this->numAlive = 0;
+}
+
+
+// Writer only; the slot becomes visible to readers with the size update.
+size_t ConcurrentBuffer::append(RecordId id, Timestamp start, uint64_t birth, uint64_t death)
+{
+    size_t slot = this->size.load(memory_order_relaxed);
+
+    this->ids[slot]    = id;
+    this->starts[slot] = start;
+    this->births[slot] = birth;
+    this->deaths[slot].store(death, memory_order_relaxed);
+    this->size.store(slot+1, memory_order_release);
+    if (death == 0)
+        this->numAlive++;
+
+    return slot;
+}
+
+
+size_t ConcurrentBuffer::getMemoryUsage()
+{
+    return sizeof(ConcurrentBuffer) + this->capacity*(sizeof(RecordId)+sizeof(Timestamp)+sizeof(uint64_t)+sizeof(atomic<uint64_t>));
+}
+
+
+ConcurrentBuffer::~ConcurrentBuffer()
+{
+    free(this->ids);
+    free(this->starts);
+    free(this->births);
+    delete[] this->deaths;
+}
+
+
+template <class S>
+void ConcurrentBuffer::execute_gOverlaps(RangeQuery Q, uint64_t snapshot, S &sink)
+{
+    size_t n = this->size.load(memory_order_acquire);
+
+    for (auto i = 0; i < n; i++)
+    {
+        uint64_t death = this->deaths[i].load(memory_order_relaxed);
+
+        if ((this->starts[i] <= Q.end) && (this->births[i] <= snapshot) && ((death == 0) || (death > snapshot)))
+            sink.add(this->ids[i]);
+    }
+}
+
+
+template <class S>
+void ConcurrentBuffer::execute_gOverlaps(uint64_t snapshot, S &sink)
+{
+    size_t n = this->size.load(memory_order_acquire);
+
+    for (auto i = 0; i < n; i++)
+    {
+        uint64_t death = this->deaths[i].load(memory_order_relaxed);
+
+        if ((this->births[i] <= snapshot) && ((death == 0) || (death > snapshot)))
+            sink.add(this->ids[i]);
+    }
+}
+
+
+
+LiveIndexConcurrent::LiveIndexConcurrent(size_t maxCapacity)
+{
+    this->maxCapacity = maxCapacity;
+    this->minCapacity = ceil(this->maxCapacity*0.4);
+    this->directory = new ConcurrentDirectory();
+    this->lastBuffer = NULL;
+    this->position = 0;
+    this->numCompactions = 0;
+}
+
+
+// Replaces the current directory; readers still holding the old one keep it until they leave their epoch.
+void LiveIndexConcurrent::publish(ConcurrentDirectory *dir)
+{
+    ConcurrentDirectory *old = this->directory.exchange(dir);
+
+    this->epochs.retire(old);
+}
+
+
+// Buffers are sorted on their lowest start, the one holding start is the last with a lowest start not after it
+// or, on equal starts, one of its predecessors.
+size_t LiveIndexConcurrent::locateBuffer(ConcurrentDirectory *dir, ConcurrentBuffer *buffer, Timestamp start)
+{
+    auto bid = upper_bound(dir->offsets_starts.begin(), dir->offsets_starts.end(), start)-dir->offsets_starts.begin()-1;
+
+    while (dir->buffers[bid] != buffer)
+        bid--;
+
+    return bid;
+}
+
+
+void LiveIndexConcurrent::insert(RecordId id, Timestamp start)
+{
+    uint64_t p = this->position.load(memory_order_relaxed)+1;
+
+
+    // If current (last) buffer is full, we need a new buffer
+    if ((this->lastBuffer == NULL) || (this->lastBuffer->size.load(memory_order_relaxed) == this->lastBuffer->capacity))
+    {
+        ConcurrentDirectory *dir = new ConcurrentDirectory(*this->directory.load(memory_order_relaxed));
+
+        this->lastBuffer = new ConcurrentBuffer(this->maxCapacity);
+        dir->offsets_starts.push_back(start);
+        dir->buffers.push_back(this->lastBuffer);
+        this->publish(dir);
+    }
+
+    this->locations[id] = {this->lastBuffer, this->lastBuffer->append(id, start, p, 0)};
+    this->position.store(p);
+}
+
+
+Timestamp LiveIndexConcurrent::remove(RecordId id)
+{
+    auto iter = this->locations.find(id);
+    ConcurrentBuffer *buffer = iter->second.buffer;
+    size_t slot = iter->second.slot;
+    Timestamp start = buffer->starts[slot];
+    uint64_t p = this->position.load(memory_order_relaxed)+1;
+
+
+    this->locations.erase(iter);
+    buffer->deaths[slot].store(p, memory_order_relaxed);
+    buffer->numAlive--;
+    this->position.store(p);
+
+    // The last buffer is still being filled
+    if ((buffer != this->lastBuffer) && (buffer->numAlive < this->minCapacity))
+        this->compact(buffer, start);
+
+    return start;
+}
+
+
+// Drops the buffer if empty, otherwise copies its entries together with those of a neighbour into a new buffer,
+// if they fit; never touches the last buffer. Removed entries are copied along only while a pinned snapshot still
+// sees them.
+void LiveIndexConcurrent::compact(ConcurrentBuffer *buffer, Timestamp start)
+{
+    ConcurrentDirectory *dir = this->directory.load(memory_order_relaxed);
+    auto bid = this->locateBuffer(dir, buffer, start);
+    uint64_t oldest = this->snapshots.getOldestPinned(this->position.load());
+    size_t from = bid, to = bid, numKept = 0;
+    ConcurrentDirectory *newDir;
+    ConcurrentBuffer *merged = NULL;
+
+
+    if (buffer->numAlive > 0)
+    {
+        if ((bid > 0) && (buffer->numAlive+dir->buffers[bid-1]->numAlive < this->maxCapacity))
+            from = bid-1;
+        else if ((dir->buffers[bid+1] != this->lastBuffer) && (buffer->numAlive+dir->buffers[bid+1]->numAlive < this->maxCapacity))
+            to = bid+1;
+        else
+            return;
+    }
+
+    for (auto b = from; b <= to; b++)
+    {
+        ConcurrentBuffer *src = dir->buffers[b];
+        size_t n = src->size.load(memory_order_relaxed);
+
+        for (auto i = 0; i < n; i++)
+        {
+            uint64_t death = src->deaths[i].load(memory_order_relaxed);
+
+            numKept += ((death == 0) || (death > oldest));
+        }
+    }
+
+    // An empty buffer still seen by a pinned snapshot is left for a later compaction of a neighbour
+    if ((buffer->numAlive == 0) && (numKept > 0))
+        return;
+
+    // Start order is kept: the first buffer precedes the second
+    if (numKept > 0)
+    {
+        merged = new ConcurrentBuffer(max(numKept, this->maxCapacity));
+        for (auto b = from; b <= to; b++)
+        {
+            ConcurrentBuffer *src = dir->buffers[b];
+            size_t n = src->size.load(memory_order_relaxed);
+
+            for (auto i = 0; i < n; i++)
+            {
+                uint64_t death = src->deaths[i].load(memory_order_relaxed);
+
+                if (death == 0)
+                    this->locations[src->ids[i]] = {merged, merged->append(src->ids[i], src->starts[i], src->births[i], 0)};
+                else if (death > oldest)
+                    merged->append(src->ids[i], src->starts[i], src->births[i], death);
+            }
+        }
+    }
+
+    newDir = new ConcurrentDirectory();
+    newDir->offsets_starts.reserve(dir->buffers.size());
+    newDir->buffers.reserve(dir->buffers.size());
+    for (auto b = 0; b < dir->buffers.size(); b++)
+    {
+        if ((b < from) || (b > to))
+        {
+            newDir->offsets_starts.push_back(dir->offsets_starts[b]);
+            newDir->buffers.push_back(dir->buffers[b]);
+        }
+        else if ((b == from) && (merged != NULL))
+        {
+            newDir->offsets_starts.push_back(merged->starts[0]);
+            newDir->buffers.push_back(merged);
+        }
+    }
+
+    // The old directory may be freed as soon as it is replaced
+    vector<ConcurrentBuffer*> replaced(dir->buffers.begin()+from, dir->buffers.begin()+to+1);
+    this->publish(newDir);
+    for (auto buffer : replaced)
+        this->epochs.retire(buffer);
+    this->numCompactions++;
+}
+
+
+uint64_t LiveIndexConcurrent::getPosition()
+{
+    return this->position.load();
+}
+
+
+// Pins the current position for the calling thread, until unpin(); entries removed after it are kept meanwhile.
+uint64_t LiveIndexConcurrent::pin()
+{
+    return this->snapshots.pin(this->position);
+}
+
+
+void LiveIndexConcurrent::unpin()
+{
+    this->snapshots.unpin();
+}
+
+
+size_t LiveIndexConcurrent::getNumBuffers()
+{
+    return this->directory.load()->buffers.size();
+}
+
+
+size_t LiveIndexConcurrent::getSize()
+{
+    return this->locations.size();
+}
+
+
+size_t LiveIndexConcurrent::getMemoryUsage()
+{
+    ConcurrentDirectory *dir = this->directory.load();
+    size_t bytes = sizeof(ConcurrentDirectory) + dir->buffers.size()*(sizeof(Timestamp)+sizeof(ConcurrentBuffer*));
+
+    for (auto buffer : dir->buffers)
+        bytes += buffer->getMemoryUsage();
+
+    return bytes + this->locations.size()*(sizeof(RecordId)+sizeof(Location));
+}
+
+
+size_t LiveIndexConcurrent::getNumCompactions()
+{
+    return this->numCompactions;
+}
+
+
+size_t LiveIndexConcurrent::getNumReclaimed()
+{
+    return this->epochs.getNumReclaimed();
+}
+
+
+LiveIndexConcurrent::~LiveIndexConcurrent()
+{
+    ConcurrentDirectory *dir = this->directory.load();
+
+    for (auto buffer : dir->buffers)
+        delete buffer;
+    delete dir;
+}
+
+
+// The snapshot must be pinned by the calling thread.
+template <class S>
+void LiveIndexConcurrent::execute_pureTimeTravel(RangeQuery Q, uint64_t snapshot, S &sink)
+{
+    EpochGuard guard(&this->epochs);
+    ConcurrentDirectory *dir = this->directory.load(memory_order_acquire);
+    auto iterOEnd = upper_bound(dir->offsets_starts.begin(), dir->offsets_starts.end(), Q.end);
+    auto numBuffers = iterOEnd-dir->offsets_starts.begin();
+
+
+    // No buffer holds a start before the end of the query
+    if (numBuffers == 0)
+        return;
+
+    // Comparisons are needed only at the last buffer - contents sorted on start by construction.
+    for (auto b = 0; b < numBuffers-1; b++)
+        dir->buffers[b]->execute_gOverlaps(snapshot, sink);
+    dir->buffers[numBuffers-1]->execute_gOverlaps(Q, snapshot, sink);
+}
+
+
+size_t LiveIndexConcurrent::execute_pureTimeTravel(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_pureTimeTravel(Q, this->pin(), sink);
+    this->unpin();
+
+    return sink.getResult();
+}
+
+
+void LiveIndexConcurrent::execute_pureTimeTravel(RangeQuery Q, CountSink &sink)
+{
+    this->execute_pureTimeTravel(Q, this->pin(), sink);
+    this->unpin();
+}
+
+
+void LiveIndexConcurrent::execute_pureTimeTravel(RangeQuery Q, XorSink &sink)
+{
+    this->execute_pureTimeTravel(Q, this->pin(), sink);
+    this->unpin();
+}
+
+
+void LiveIndexConcurrent::execute_pureTimeTravel(RangeQuery Q, IdSink &sink)
+{
+    this->execute_pureTimeTravel(Q, this->pin(), sink);
+    this->unpin();
+}
+
+
+template void LiveIndexConcurrent::execute_pureTimeTravel<CountSink>(RangeQuery Q, uint64_t snapshot, CountSink &sink);
+template void LiveIndexConcurrent::execute_pureTimeTravel<XorSink>(RangeQuery Q, uint64_t snapshot, XorSink &sink);
+template void LiveIndexConcurrent::execute_pureTimeTravel<IdSink>(RangeQuery Q, uint64_t snapshot, IdSink &sink);
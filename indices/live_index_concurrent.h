@@ -0,0 +1,95 @@
+#ifndef _LIVE_INDEX_CONCURRENT_H_
+#define _LIVE_INDEX_CONCURRENT_H_
+
+#include "../def_global.h"
+#include "../containers/epoch.h"
+#include "../indices/live_index.h"
+#include <unordered_map>
+
+
+
+// Append-only buffer: the writer fills slots in start order and publishes them through size; a removal only
+// stamps its slot, so readers never see an entry move. Every slot carries the stream positions of its insertion
+// (birth) and removal (death, 0 while alive); a reader at snapshot s sees the slots with birth <= s < death.
+class ConcurrentBuffer
+{
+public:
+    size_t capacity;
+    RecordId *ids;
+    Timestamp *starts;
+    uint64_t *births;
+    atomic<uint64_t> *deaths;
+    atomic<size_t> size;            // Published slots
+    size_t numAlive;                // Writer only
+
+    ConcurrentBuffer(size_t capacity);
+    size_t append(RecordId id, Timestamp start, uint64_t birth, uint64_t death);
+    size_t getMemoryUsage();
+    ~ConcurrentBuffer();
+
+    // Querying
+    template <class S> void execute_gOverlaps(RangeQuery Q, uint64_t snapshot, S &sink);
+    template <class S> void execute_gOverlaps(uint64_t snapshot, S &sink);
+};
+
+
+
+// Immutable once published; the writer installs a new copy whenever the set of buffers changes.
+struct ConcurrentDirectory
+{
+    vector<Timestamp> offsets_starts;         // Lowest start per buffer
+    vector<ConcurrentBuffer*> buffers;
+};
+
+
+
+// Capacity-constrained LIVE INDEX that one writer updates while any number of threads query it without locks.
+// Every update advances the stream position; queries read the snapshot at the position they pin. Readers go
+// through the directory published last; buffers drained below the minimum capacity are compacted into a new
+// buffer (merged with a neighbour, or dropped when empty), keeping only the removed entries a pinned snapshot
+// still sees, and the replaced buffers and directories are freed by epoch-based reclamation once no reader can
+// reference them.
+class LiveIndexConcurrent : public LiveIndex
+{
+private:
+    struct Location
+    {
+        ConcurrentBuffer *buffer;
+        size_t slot;
+    };
+
+    size_t maxCapacity, minCapacity;
+    atomic<ConcurrentDirectory*> directory;
+    ConcurrentBuffer *lastBuffer;
+    unordered_map<RecordId, Location> locations;    // Writer only
+    atomic<uint64_t> position;                      // Stream position of the last update
+    EpochManager epochs;
+    SnapshotRegistry snapshots;
+    size_t numCompactions;
+
+    void publish(ConcurrentDirectory *dir);
+    size_t locateBuffer(ConcurrentDirectory *dir, ConcurrentBuffer *buffer, Timestamp start);
+    void compact(ConcurrentBuffer *buffer, Timestamp start);
+
+public:
+    LiveIndexConcurrent(size_t maxCapacity);
+    void insert(RecordId id, Timestamp start);
+    Timestamp remove(RecordId id);
+    uint64_t getPosition();
+    uint64_t pin();
+    void unpin();
+    size_t getNumBuffers();
+    size_t getSize();
+    size_t getMemoryUsage();
+    size_t getNumCompactions();
+    size_t getNumReclaimed();
+    ~LiveIndexConcurrent();
+
+    // Querying
+    size_t execute_pureTimeTravel(RangeQuery Q);
+    void execute_pureTimeTravel(RangeQuery Q, CountSink &sink);
+    void execute_pureTimeTravel(RangeQuery Q, XorSink &sink);
+    void execute_pureTimeTravel(RangeQuery Q, IdSink &sink);
+    template <class S> void execute_pureTimeTravel(RangeQuery Q, uint64_t snapshot, S &sink);
+};
+#endif // _LIVE_INDEX_CONCURRENT_H_
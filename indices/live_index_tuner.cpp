@@ -0,0 +1,83 @@
+#include "live_index_tuner.h"
+
+
+
+LiveIndexTuner::LiveIndexTuner(size_t windowSize)
+{
+    this->windowSize = max(windowSize, (size_t)1);
+    this->numUpdates = 0;
+}
+
+
+size_t LiveIndexTuner::getWindowSize()
+{
+    return this->windowSize;
+}
+
+
+// Returns the capacity for the next window; compact is set when the buffers should be coalesced, also when the
+// capacity changes.
+size_t LiveIndexTuner::decide(size_t capacity, const LiveIndexWindow &window, bool &compact)
+{
+    LiveIndexTunerDecision d;
+    double fill = (window.sumCapacities > 0)? (double)window.numEntries/window.sumCapacities: 1;
+    double pivotShare = 0, buffersPerQuery = 0;
+
+
+    this->numUpdates += window.numUpdates;
+    compact = false;
+
+    if (window.numQueries > 0)
+    {
+        size_t numEntries = window.numEntriesScanned+window.numEntriesCompared;
+
+        pivotShare = (numEntries > 0)? (double)window.numEntriesCompared/numEntries: 0;
+        buffersPerQuery = (double)window.numBuffersScanned/window.numQueries;
+    }
+
+    d.numUpdates = this->numUpdates;
+    d.fromCapacity = d.toCapacity = capacity;
+    d.fill = fill;
+    d.pivotShare = pivotShare;
+    d.buffersPerQuery = buffersPerQuery;
+
+    if ((pivotShare > TUNER_MAX_PIVOT_SHARE) && (2*buffersPerQuery <= TUNER_MAX_BUFFERS_PER_QUERY) && (capacity/2 >= TUNER_MIN_CAPACITY))
+    {
+        d.action = "shrink";
+        d.toCapacity = capacity/2;
+    }
+    else if ((buffersPerQuery > TUNER_MAX_BUFFERS_PER_QUERY) && (2*pivotShare <= TUNER_MAX_PIVOT_SHARE) && (fill >= TUNER_MIN_FILL) && (capacity*2 <= TUNER_MAX_CAPACITY))
+    {
+        d.action = "grow";
+        d.toCapacity = capacity*2;
+    }
+    else if ((fill < TUNER_MIN_FILL) && (window.numBuffers > 1))
+        d.action = "compact";
+    else
+        return capacity;
+
+    compact = true;
+    this->decisions.push_back(d);
+
+    return d.toCapacity;
+}
+
+
+size_t LiveIndexTuner::getNumDecisions()
+{
+    return this->decisions.size();
+}
+
+
+void LiveIndexTuner::print()
+{
+    cout << "Tuning decisions" << endl;
+    cout << "Window size [updates]              : " << this->windowSize << endl;
+    cout << "Num of decisions                   : " << this->decisions.size() << endl;
+    if (this->decisions.empty())
+        return;
+
+    printf("%14s  %-8s  %10s  %10s  %6s  %6s  %8s\n", "updates", "action", "capacity", "new", "fill", "pivot", "buffers");
+    for (auto &d : this->decisions)
+        printf("%14zu  %-8s  %10zu  %10zu  %6.3f  %6.3f  %8.1f\n", d.numUpdates, d.action.c_str(), d.fromCapacity, d.toCapacity, d.fill, d.pivotShare, d.buffersPerQuery);
+}
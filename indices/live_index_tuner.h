@@ -0,0 +1,67 @@
+#ifndef _LIVE_INDEX_TUNER_H_
+#define _LIVE_INDEX_TUNER_H_
+
+#include "../def_global.h"
+
+#define TUNER_WINDOW_SIZE           65536       // in updates
+#define TUNER_MAX_PIVOT_SHARE       0.5         // of the entries scanned per query
+#define TUNER_MAX_BUFFERS_PER_QUERY 256
+#define TUNER_MIN_FILL              0.4         // as the minCapacity of the LIVE INDEX
+#define TUNER_MIN_CAPACITY          64
+#define TUNER_MAX_CAPACITY          (1 << 20)
+
+
+
+// What a capacity-constrained LIVE INDEX observed over a window of updates; the buffer counters are sampled when
+// the window closes, the query counters accumulate over the window.
+struct LiveIndexWindow
+{
+    size_t numUpdates;
+    size_t numQueries;
+    size_t numBuffersScanned;       // Buffers visited by the queries, up to and including their last one
+    size_t numEntriesScanned;       // Entries reported by the queries without comparisons
+    size_t numEntriesCompared;      // Entries of the last buffer visited, compared on their start
+    size_t numBuffers;              // Non-empty buffers
+    size_t numEntries;
+    size_t sumCapacities;           // Of the non-empty buffers
+
+    LiveIndexWindow()
+    {
+        memset(this, 0, sizeof(LiveIndexWindow));
+    };
+};
+
+
+struct LiveIndexTunerDecision
+{
+    size_t numUpdates;              // Since the start, when the decision was taken
+    string action;
+    size_t fromCapacity, toCapacity;
+    double fill, pivotShare, buffersPerQuery;
+};
+
+
+
+// Retunes the capacity of a LIVE INDEX at the end of every window of updates:
+//   shrink  : the last buffer of the queries holds more than TUNER_MAX_PIVOT_SHARE of their entries, i.e., most
+//             of them are compared on their start; halves the capacity
+//   grow    : the queries visit more than TUNER_MAX_BUFFERS_PER_QUERY buffers while these are well filled, i.e.,
+//             the per-buffer cost dominates; doubles the capacity
+//   compact : the buffers are less than TUNER_MIN_FILL full on average; coalesces them at the same capacity
+// Either rule requires the opposite one to stay clear by a factor of two, so that consecutive decisions do not
+// undo each other. Every decision is kept in a log.
+class LiveIndexTuner
+{
+private:
+    size_t windowSize;
+    size_t numUpdates;
+    vector<LiveIndexTunerDecision> decisions;
+
+public:
+    LiveIndexTuner(size_t windowSize);
+    size_t getWindowSize();
+    size_t decide(size_t capacity, const LiveIndexWindow &window, bool &compact);
+    size_t getNumDecisions();
+    void print();
+};
+#endif // _LIVE_INDEX_TUNER_H_
@@ -0,0 +1,202 @@
+#include "sharded_lit.h"
+
+
+
+ShardedLIT::Shard::Shard(LiveIndex *lidx, HINT_M_Dynamic *idx, size_t queueCapacity) : queue(queueCapacity)
+{
+    this->lidx = lidx;
+    this->idx  = idx;
+    this->numIssued  = 0;
+    this->numApplied = 0;
+}
+
+
+// Takes over the given LIVE INDEXes and HINTs, one pair per shard.
+ShardedLIT::ShardedLIT(const vector<LiveIndex*> &lidxs, const vector<HINT_M_Dynamic*> &idxs, size_t queueCapacity, ThreadPool *pool)
+{
+    this->pool = pool;
+    this->running = true;
+    for (auto i = 0; i < lidxs.size(); i++)
+        this->shards.push_back(new Shard(lidxs[i], idxs[i], queueCapacity));
+    for (auto s : this->shards)
+        s->writer = thread(&ShardedLIT::runWriter, this, s);
+}
+
+
+// Backs off a thread waiting on a shard, after numIdle unsuccessful checks: yields at first, then sleeps, so an
+// idle writer does not keep a core busy.
+static inline void backoff(unsigned int &numIdle)
+{
+    if (numIdle < SHARD_IDLE_YIELDS)
+    {
+        numIdle++;
+        this_thread::yield();
+    }
+    else
+        this_thread::sleep_for(chrono::microseconds(SHARD_IDLE_SLEEP_US));
+}
+
+
+void ShardedLIT::runWriter(Shard *s)
+{
+    ShardUpdate u;
+    Timestamp start;
+    unsigned int numIdle = 0;
+
+
+    while (true)
+    {
+        if (s->queue.pop(u))
+        {
+            if (u.operation == 'S')
+                s->lidx->insert(u.id, u.timestamp);
+            else
+            {
+                start = s->lidx->remove(u.id);
+                s->idx->insert(Record(u.id, start, u.timestamp));
+            }
+            s->numApplied.store(s->numApplied.load(memory_order_relaxed)+1, memory_order_release);
+            numIdle = 0;
+        }
+        else if (!this->running.load(memory_order_acquire))
+        {
+            // Updates pushed before running was cleared are visible by now
+            if (s->queue.empty())
+                return;
+        }
+        else
+            backoff(numIdle);
+    }
+}
+
+
+void ShardedLIT::insert(RecordId id, Timestamp start)
+{
+    Shard *s = this->shards[id % this->shards.size()];
+
+    s->queue.push({'S', id, start});
+    s->numIssued++;
+}
+
+
+void ShardedLIT::remove(RecordId id, Timestamp end)
+{
+    Shard *s = this->shards[id % this->shards.size()];
+
+    s->queue.push({'E', id, end});
+    s->numIssued++;
+}
+
+
+// Waits until every shard has applied all the updates issued so far; the shards are idle afterwards.
+void ShardedLIT::sync()
+{
+    for (auto s : this->shards)
+    {
+        unsigned int numIdle = 0;
+
+        while (s->numApplied.load(memory_order_acquire) < s->numIssued)
+            backoff(numIdle);
+    }
+}
+
+
+size_t ShardedLIT::getNumShards()
+{
+    return this->shards.size();
+}
+
+
+// The remaining statistics read the shards, so sync() first.
+size_t ShardedLIT::getNumBuffers()
+{
+    size_t numBuffers = 0;
+
+    for (auto s : this->shards)
+        numBuffers += s->lidx->getNumBuffers();
+
+    return numBuffers;
+}
+
+
+size_t ShardedLIT::getLiveIndexMemoryUsage()
+{
+    size_t bytes = 0;
+
+    for (auto s : this->shards)
+        bytes += s->lidx->getMemoryUsage() + s->queue.getMemoryUsage();
+
+    return bytes;
+}
+
+
+size_t ShardedLIT::getHINTMemoryUsage()
+{
+    size_t bytes = 0;
+
+    for (auto s : this->shards)
+        bytes += s->idx->getMemoryUsage();
+
+    return bytes;
+}
+
+
+ShardedLIT::~ShardedLIT()
+{
+    this->running.store(false, memory_order_release);
+    for (auto s : this->shards)
+    {
+        s->writer.join();
+        delete s->lidx;
+        delete s->idx;
+        delete s;
+    }
+}
+
+
+template <class S>
+inline void ShardedLIT::executeShard_pureTimeTravel(Shard *s, RangeQuery Q, S &sink)
+{
+    s->lidx->execute_pureTimeTravel(Q, sink);
+    if (Q.start <= s->idx->gend)
+        s->idx->execute_pureTimeTravel(Q, sink);
+}
+
+
+template <class S>
+void ShardedLIT::execute_pureTimeTravel(RangeQuery Q, S &sink)
+{
+    this->sync();
+
+    if (this->pool == NULL)
+    {
+        for (auto s : this->shards)
+            this->executeShard_pureTimeTravel(s, Q, sink);
+
+        return;
+    }
+
+    PartialSinks<S> partials(this->shards.size());
+    TaskGroup group(this->pool);
+
+    for (auto i = 0; i < this->shards.size(); i++)
+        group.run([this, i, Q, &partials] { this->executeShard_pureTimeTravel(this->shards[i], Q, partials[i]); });
+    group.wait();
+
+    partials.mergeInto(sink);
+}
+
+
+size_t ShardedLIT::execute_pureTimeTravel(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_pureTimeTravel(Q, sink);
+
+    return sink.getResult();
+}
+
+
+template void ShardedLIT::execute_pureTimeTravel<CountSink>(RangeQuery Q, CountSink &sink);
+template void ShardedLIT::execute_pureTimeTravel<XorSink>(RangeQuery Q, XorSink &sink);
+template void ShardedLIT::execute_pureTimeTravel<IdSink>(RangeQuery Q, IdSink &sink);
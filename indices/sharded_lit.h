@@ -0,0 +1,67 @@
+#ifndef _SHARDED_LIT_H_
+#define _SHARDED_LIT_H_
+
+#include "../def_global.h"
+#include "../containers/spsc_queue.h"
+#include "../containers/thread_pool.h"
+#include "../indices/live_index.h"
+#include "../indices/hint_m.h"
+
+#define SHARD_QUEUE_CAPACITY 65536
+#define SHARD_IDLE_YIELDS    1024   // An idle writer, or sync(), yields this many times before sleeping
+#define SHARD_IDLE_SLEEP_US  50
+
+
+
+// An S or E event routed to a shard
+struct ShardUpdate
+{
+    char operation;
+    RecordId id;
+    Timestamp timestamp;
+};
+
+
+
+// LIT over numShards independent LIVE INDEX/HINT pairs; record ids are hash-partitioned (id mod numShards). Every
+// shard is owned by a writer thread that applies the updates it receives through its SPSC queue. Updates are
+// issued by a single thread, which also runs the queries: a query first waits until every shard has applied the
+// updates issued before it, then probes the shards (concurrently, if a pool is given) and merges their results.
+class ShardedLIT
+{
+private:
+    struct Shard
+    {
+        LiveIndex *lidx;
+        HINT_M_Dynamic *idx;
+        SPSCQueue<ShardUpdate> queue;
+        thread writer;
+        size_t numIssued;               // Updates pushed by the issuing thread
+        atomic<size_t> numApplied;      // Updates applied by the writer thread
+
+        Shard(LiveIndex *lidx, HINT_M_Dynamic *idx, size_t queueCapacity);
+    };
+
+    vector<Shard*> shards;
+    ThreadPool *pool;
+    atomic<bool> running;
+
+    void runWriter(Shard *s);
+    template <class S> inline void executeShard_pureTimeTravel(Shard *s, RangeQuery Q, S &sink);
+
+public:
+    ShardedLIT(const vector<LiveIndex*> &lidxs, const vector<HINT_M_Dynamic*> &idxs, size_t queueCapacity, ThreadPool *pool);
+    void insert(RecordId id, Timestamp start);
+    void remove(RecordId id, Timestamp end);
+    void sync();
+    size_t getNumShards();
+    size_t getNumBuffers();
+    size_t getLiveIndexMemoryUsage();
+    size_t getHINTMemoryUsage();
+    ~ShardedLIT();
+
+    // Querying
+    size_t execute_pureTimeTravel(RangeQuery Q);
+    template <class S> void execute_pureTimeTravel(RangeQuery Q, S &sink);
+};
+#endif // _SHARDED_LIT_H_
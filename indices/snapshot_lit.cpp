@@ -0,0 +1,95 @@
+#include "snapshot_lit.h"
+
+
+
+// Takes over the given LIVE INDEX and HINT.
+SnapshotLIT::SnapshotLIT(LiveIndexConcurrent *lidx, HINT_M_Dynamic *idx)
+{
+    this->lidx = lidx;
+    this->idx  = idx;
+}
+
+
+void SnapshotLIT::insert(RecordId id, Timestamp start)
+{
+    this->lidx->insert(id, start);
+}
+
+
+void SnapshotLIT::remove(RecordId id, Timestamp end)
+{
+    lock_guard<shared_timed_mutex> guard(this->lock);
+    Timestamp start = this->lidx->remove(id);
+
+    this->idx->insert(Record(id, start, end));
+}
+
+
+uint64_t SnapshotLIT::getPosition()
+{
+    return this->lidx->getPosition();
+}
+
+
+size_t SnapshotLIT::getNumBuffers()
+{
+    return this->lidx->getNumBuffers();
+}
+
+
+size_t SnapshotLIT::getLiveIndexMemoryUsage()
+{
+    return this->lidx->getMemoryUsage();
+}
+
+
+size_t SnapshotLIT::getHINTMemoryUsage()
+{
+    shared_lock<shared_timed_mutex> guard(this->lock);
+
+    return this->idx->getMemoryUsage();
+}
+
+
+SnapshotLIT::~SnapshotLIT()
+{
+    delete this->lidx;
+    delete this->idx;
+}
+
+
+// Returns the stream position the results refer to.
+template <class S>
+uint64_t SnapshotLIT::execute_pureTimeTravel(RangeQuery Q, S &sink)
+{
+    uint64_t snapshot;
+
+
+    {
+        shared_lock<shared_timed_mutex> guard(this->lock);
+
+        // HINT spans [gstart, gend] at this point, which the caller cannot know; no ended record starts after gend
+        snapshot = this->lidx->pin();
+        if (Q.start <= this->idx->gend)
+            this->idx->execute_pureTimeTravel(RangeQuery(Q.id, Q.start, min(Q.end, this->idx->gend)), sink);
+    }
+    this->lidx->execute_pureTimeTravel(Q, snapshot, sink);
+    this->lidx->unpin();
+
+    return snapshot;
+}
+
+
+size_t SnapshotLIT::execute_pureTimeTravel(RangeQuery Q)
+{
+    WorkloadSink sink;
+
+    this->execute_pureTimeTravel(Q, sink);
+
+    return sink.getResult();
+}
+
+
+template uint64_t SnapshotLIT::execute_pureTimeTravel<CountSink>(RangeQuery Q, CountSink &sink);
+template uint64_t SnapshotLIT::execute_pureTimeTravel<XorSink>(RangeQuery Q, XorSink &sink);
+template uint64_t SnapshotLIT::execute_pureTimeTravel<IdSink>(RangeQuery Q, IdSink &sink);
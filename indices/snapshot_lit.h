@@ -0,0 +1,38 @@
+#ifndef _SNAPSHOT_LIT_H_
+#define _SNAPSHOT_LIT_H_
+
+#include "../def_global.h"
+#include "../indices/live_index_concurrent.h"
+#include "../indices/hint_m.h"
+#include <shared_mutex>
+
+
+
+// LIT whose queries run concurrently with the updates of a single writer and read a consistent cut of the stream.
+// Every update advances the stream position of the LIVE INDEX; an end event moves the record into HINT and stamps
+// its removal from the LIVE INDEX under the exclusive lock of HINT, while a query holds the lock shared only to
+// pin the current position and scan HINT, which then holds exactly the records ended up to that position. The
+// LIVE INDEX is scanned afterwards without locks at the same snapshot, so a record is reported either as live or
+// as ended, never twice or not at all.
+class SnapshotLIT
+{
+private:
+    LiveIndexConcurrent *lidx;
+    HINT_M_Dynamic *idx;
+    shared_timed_mutex lock;
+
+public:
+    SnapshotLIT(LiveIndexConcurrent *lidx, HINT_M_Dynamic *idx);
+    void insert(RecordId id, Timestamp start);
+    void remove(RecordId id, Timestamp end);
+    uint64_t getPosition();
+    size_t getNumBuffers();
+    size_t getLiveIndexMemoryUsage();
+    size_t getHINTMemoryUsage();
+    ~SnapshotLIT();
+
+    // Querying
+    size_t execute_pureTimeTravel(RangeQuery Q);
+    template <class S> uint64_t execute_pureTimeTravel(RangeQuery Q, S &sink);
+};
+#endif // _SNAPSHOT_LIT_H_
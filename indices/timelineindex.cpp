@@ -60,9 +60,9 @@ inline bool compare(const TimelineIndexEntry &lhs, const TimelineIndexEntry &rhs
 
 }
 
-size_t TimelineIndex::execute_pureTimeTravel(RangeQuery Q)
+template <class S>
+void TimelineIndex::execute_pureTimeTravel(RangeQuery Q, S &sink)
 {
-	size_t result = 0;
 	int closestValidCheckpointIndex = ((Q.start) / this->checkpointFrequency);
 	closestValidCheckpointIndex-=1;
 
@@ -91,7 +91,7 @@ size_t TimelineIndex::execute_pureTimeTravel(RangeQuery Q)
 				resultsBeforeQstart.erase((*iter).id);
 		}
 		for(auto x : resultsBeforeQstart)
-			result^=x;
+			sink.add(x);
 	}else{
 		CheckPoint temp(this->VersionMap[closestValidCheckpointIndex]);
 		iterStart = this->eventList.begin() + this->VersionMap[closestValidCheckpointIndex].checkpointSpot;
@@ -106,7 +106,7 @@ size_t TimelineIndex::execute_pureTimeTravel(RangeQuery Q)
 
 		for(int i = 0; i < temp.size(); i++)
 			if(temp[i])
-				result^= i;
+				sink.add(i);
 
 
 	}
@@ -114,13 +114,18 @@ size_t TimelineIndex::execute_pureTimeTravel(RangeQuery Q)
 	
 	for(auto iter = qstartBound; iter!= qendBound; iter++)
 		if((*iter).isStart)
-				result^= (*iter).id;
-	
+				sink.add((*iter).id);
+}
 
 
-	return result;
-	
 
+size_t TimelineIndex::execute_pureTimeTravel(RangeQuery Q)
+{
+	WorkloadSink sink;
+
+	this->execute_pureTimeTravel(Q, sink);
+
+	return sink.getResult();
 }
 
 
@@ -133,10 +138,24 @@ void TimelineIndex::getStats()
 }
 
 
-TimelineIndex::~TimelineIndex()
+// Checkpoints are bit vectors, one bit per record seen so far
+size_t TimelineIndex::getMemoryUsage()
 {
+    size_t bytes = this->VersionMap.capacity()*sizeof(CheckPoint) + this->deltaCheckPoint.capacity()/8 + this->eventList.capacity()*sizeof(TimelineIndexEntry);
+
+    for (auto &cp : this->VersionMap)
+        bytes += cp.capacity()/8;
 
+    return bytes;
 }
 
 
+TimelineIndex::~TimelineIndex()
+{
+
+}
+
 
+template void TimelineIndex::execute_pureTimeTravel<CountSink>(RangeQuery Q, CountSink &sink);
+template void TimelineIndex::execute_pureTimeTravel<XorSink>(RangeQuery Q, XorSink &sink);
+template void TimelineIndex::execute_pureTimeTravel<IdSink>(RangeQuery Q, IdSink &sink);
@@ -58,11 +58,13 @@ public:
     void createCheckpoint(Timestamp endpoint);
     void printCheckpoints();
     void getStats();
+    size_t getMemoryUsage();
     ~TimelineIndex();
 
     // Querying
     size_t execute(StabbingQuery Q);
     size_t execute_pureTimeTravel(RangeQuery Q);
+    template <class S> void execute_pureTimeTravel(RangeQuery Q, S &sink);
     size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrConstraint);
     size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrConstraint);
     size_t executeTimeTravel(RangeQuery Q, int lowerConstraint, int upperConstraint);
@@ -1,20 +1,10 @@
-#include <boost/geometry.hpp>
-#include <boost/geometry/geometries/geometries.hpp>
-#include <boost/geometry/index/rtree.hpp>
-
-
-namespace bg = boost::geometry;
-namespace bgi = boost::geometry::index;
-
 #include "getopt.h"
 #include "def_global.h"
 #include "./containers/relation.h"
-#include "./indices/live_index.cpp"
-#define PAGESIZE    16
-
-
-
-
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "replay.h"
+#include "replay_methods.h"
 
 
 
@@ -34,6 +24,12 @@ void usage()
     cerr << "              set the capacity constraint number for the LIVE INDEX" << endl; 
     cerr << "       -d" << endl;
     cerr << "              set the duration constraint number for the LIVE INDEX" << endl;      
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              dump the latency percentiles per operation to file; JSON if it ends with .json, CSV otherwise" << endl;
+    cerr << "       -s interval" << endl;
+    cerr << "              set the memory sampling interval in milliseconds; by default " << MEMORY_SAMPLING_INTERVAL << endl;
     cerr << "       -r runs" << endl;
     cerr << "              set the number of runs per query; by default 1" << endl << endl;
     cerr << "EXAMPLE" << endl;
@@ -44,30 +40,21 @@ void usage()
 int main(int argc, char **argv)
 {
     Timer tim;
-    Record r;
     LiveIndex *lidxR;
-    size_t totalResult = 0, queryresult = 0, numQueries = 0, numUpdates = 0;
-    double b_starttime = 0, b_endtime = 0, i_endtime = 0, b_querytime = 0, i_querytime = 0, avgQueryTime = 0;
-    double totalIndexTime = 0, totalBufferStartTime = 0, totalBufferEndTime = 0, totalIndexEndTime = 0, totalQueryTime_b = 0, totalQueryTime_i = 0, totalBufferMergingTime = 0;
-    Timestamp first, second, startEndpoint;
+    double totalIndexTime = 0;
     RunSettings settings;
-    char c, operation;
-    double third, fourth;
-    double vm = 0, rss = 0, vmMax = 0, rssMax = 0;
-    string strQuery = "", strPredicate = "", strOptimizations = "";
-    Timestamp leafPartitionExtent = 0;
+    char c;
+    unsigned int samplingInterval = MEMORY_SAMPLING_INTERVAL;
+    const char *latencyFile = NULL;
+    string strWorkload = "";
     string typeBuffer;
     size_t maxCapacity = -1;
     Timestamp maxDuration = -1;
-    unsigned int mergeParameter = 0;
-    size_t maxNumBuffers = 0;
-    Timestamp rgstart = std::numeric_limits<Timestamp>::max();
-    Timestamp rgend   = std::numeric_limits<Timestamp>::min();
 
     
     settings.init();
     settings.method = "2dR-tree";
-    while ((c = getopt(argc, argv, "?hq:c:d:b:m:r:")) != -1)
+    while ((c = getopt(argc, argv, "?hq:c:d:b:m:w:o:s:r:")) != -1)
     {
         switch (c)
         {
@@ -87,6 +74,19 @@ int main(int argc, char **argv)
             case 'd':
                 maxDuration = atoi(optarg);
                 break;
+
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+
+            case 'o':
+                latencyFile = optarg;
+                break;
+
+            case 's':
+                samplingInterval = atoi(optarg);
+                break;
+
             case 'r':
                 settings.numRuns = atoi(optarg);
                 break;
@@ -105,10 +105,11 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    
-    tim.start();
-    bgi::rtree<pair<bg::model::point<Timestamp, 2, bg::cs::cartesian>, RecordId>, bgi::linear<PAGESIZE>> rtree;
-    totalIndexTime = tim.stop();
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
     
 
     
@@ -120,6 +121,10 @@ int main(int argc, char **argv)
             lidxR = new LiveIndexCapacityConstraintedVector(maxCapacity);
         else if (typeBuffer == "ENHANCEDHASHMAP")
             lidxR = new LiveIndexCapacityConstraintedICDE16(maxCapacity);
+        else if (typeBuffer == "COLUMNAR")
+            lidxR = new LiveIndexCapacityConstraintedColumnar(maxCapacity);
+        else if (typeBuffer == "ORDERED")
+            lidxR = new LiveIndexCapacityConstraintedOrdered(maxCapacity);
         else
         {
             usage();
@@ -134,6 +139,10 @@ int main(int argc, char **argv)
             lidxR = new LiveIndexDurationConstraintedVector(maxDuration);
         else if (typeBuffer == "ENHANCEDHASHMAP")
             lidxR = new LiveIndexDurationConstraintedICDE16(maxDuration);
+        else if (typeBuffer == "COLUMNAR")
+            lidxR = new LiveIndexDurationConstraintedColumnar(maxDuration);
+        else if (typeBuffer == "ORDERED")
+            lidxR = new LiveIndexDurationConstraintedOrdered(maxDuration);
         else
         {
             usage();
@@ -147,115 +156,28 @@ int main(int argc, char **argv)
     }
 
     settings.queryFile = argv[optind];
-    ifstream fQ(settings.queryFile);
-    if (!fQ)
+    Stream fQ(settings.queryFile);
+    if (!fQ.isOpen())
     {
             usage();
             return 1;
     }
 
-    size_t sumQ = 0;
-    size_t count = 0;
-    if (settings.verbose)
-        cout << "Operation\tInput1\tInput2\tBuffer_time\tIndex_time\tPredicate\tResult" << endl;
-
-    while (fQ >> operation >> first >> second >> third >> fourth)
-    {
-        switch (operation)
-        {
-            case 'S':
-                tim.start();
-                lidxR->insert(first, second);
-                b_starttime = tim.stop();
-                totalBufferStartTime += b_starttime;
-                
-                numUpdates++;
-                if (settings.verbose)
-                {
-                    cout << "S\t" << first << "\t" << second;
-                    printf("\t%f\t0", b_starttime);
-                    cout << "\t-\t-" << endl;
-                }
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'E':
-                tim.start();
-                startEndpoint = lidxR->remove(first);
-                b_endtime = tim.stop();
-                totalBufferEndTime += b_endtime;
-                
-                tim.start();
-                rtree.insert(make_pair(bg::model::point<Timestamp, 2, bg::cs::cartesian>(startEndpoint, second), first));
-                rgstart = min(rgstart, startEndpoint);
-                rgend = max(rgend, second);
-                i_endtime = tim.stop();
-                totalIndexEndTime += i_endtime;
-
-                numUpdates++;
-                if (settings.verbose)
-                {
-                    cout << "E\t" << first << "\t" << second;
-                    printf("\t%f\t%f", b_endtime, i_endtime);
-                    cout << "\t-\t-" << endl;
-                }
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'Q':
-                numQueries++;
-                sumQ += second-first;
-
-                double sumT = 0;
-                for (auto r = 0; r < settings.numRuns; r++)
-                {
-
-                    tim.start();
-                    queryresult = lidxR->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-                    b_querytime = tim.stop();
-
-                    tim.start();
-                    if (first <= rgend)
-                    {
-                        bg::model::box<bg::model::point<Timestamp, 2, bg::cs::cartesian>> qwindow(bg::model::point<Timestamp, 2, bg::cs::cartesian>(rgstart, first), bg::model::point<Timestamp, 2, bg::cs::cartesian>(second, rgend));
-                        for (auto it = rtree.qbegin(bgi::intersects(qwindow)); it != rtree.qend(); ++it)
-#ifdef WORKLOAD_COUNT
-                            queryresult++;
-#else
-                            queryresult^= it->second;
-#endif 
-                    }
-                    i_querytime = tim.stop();
-
-
-                }
-                totalQueryTime_b += b_querytime;
-                totalQueryTime_i += i_querytime;
-
-                if (settings.verbose)
-                {
-                    cout << "Q\t" << first << "\t" << second;
-                    printf("\t%f\t%f", b_querytime, i_querytime);
-                    cout << "\t" << strPredicate << "\t" << queryresult << endl;
-                }
-                
-                totalResult += queryresult;
-                avgQueryTime += sumT/settings.numRuns;
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-        }
-        maxNumBuffers = max(maxNumBuffers, lidxR->getNumBuffers());
-    }
+    LatencyTelemetry latTelemetry;
+    ReplayStats stats;
+    stats.latencyS   = latTelemetry.add("S (buffer)");
+    stats.latencyE_b = latTelemetry.add("E (buffer)");
+    stats.latencyE_i = latTelemetry.add("E (index)");
+    stats.latencyQ_b = latTelemetry.add("Q (buffer)");
+    stats.latencyQ_i = latTelemetry.add("Q (index)");
+    MemoryTelemetry memTelemetry(samplingInterval);
+    tim.start();
+    RTree2DReplay method(lidxR);
+    totalIndexTime = tim.stop();
+    memTelemetry.start();
+    replayStream(fQ, method, NULL, settings.numRuns, settings.typeWorkload, stats);
     fQ.close();
+    memTelemetry.stop();
     
 
     
@@ -272,23 +194,23 @@ int main(int argc, char **argv)
         cout << "Buffer duration                    : " << maxDuration << endl << endl;
     cout << "Index info" << endl;
     cout << "Updates report" << endl;
-    cout << "Num of updates                     : " << numUpdates << endl;
-    cout << "Num of buffers (max)               : " << maxNumBuffers << endl;
-    printf( "Total updating time (buffer) [secs]: %f\n", (totalBufferStartTime+totalBufferEndTime));
-    printf( "Total updating time (index)  [secs]: %f\n\n", totalIndexEndTime);
+    cout << "Num of updates                     : " << stats.numUpdates << endl;
+    cout << "Num of buffers (max)               : " << stats.maxNumBuffers << endl;
+    printf( "Total updating time (buffer) [secs]: %f\n", stats.totalBufferUpdateTime);
+    printf( "Total updating time (index)  [secs]: %f\n\n", stats.totalIndexUpdateTime);
 
     cout << "Queries report" << endl;
-    cout << "Num of queries                     : " << numQueries << endl;
+    cout << "Num of queries                     : " << stats.numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [";
-#ifdef WORKLOAD_COUNT
-    cout << "COUNT]               : ";
-#else
-    cout << "XOR]                 : ";
-#endif
-    cout << totalResult << endl;
-    printf( "Total querying time (buffer) [secs]: %f\n", totalQueryTime_b/settings.numRuns);
-    printf( "Total querying time (index)  [secs]: %f\n\n", totalQueryTime_i/settings.numRuns);
+    printf( "%-35s: %zu\n", ("Total result [" + getWorkloadName(settings.typeWorkload) + "]").c_str(), stats.totalResult);
+    printf( "Total querying time (buffer) [secs]: %f\n", stats.totalQueryTime_b/settings.numRuns);
+    printf( "Total querying time (index)  [secs]: %f\n\n", stats.totalQueryTime_i/settings.numRuns);
+    memTelemetry.account("LIVE INDEX", lidxR->getMemoryUsage());
+    latTelemetry.print();
+    if ((latencyFile != NULL) && (!latTelemetry.dump(latencyFile)))
+        cerr << endl << "Error - cannot write latencies to '" << latencyFile << "'" << endl << endl;
+    memTelemetry.print();
+
     delete lidxR;
     
     
@@ -1,8 +1,11 @@
 #include "getopt.h"
 #include "def_global.h"
 #include "./containers/relation.h"
-#include "./indices/hint_m.h"
-#include "./indices/live_index.cpp"
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "replay.h"
+#include "replay_methods.h"
+
 
 
 void usage()
@@ -23,6 +26,14 @@ void usage()
     cerr << "              set the capacity constraint number for the LIVE INDEX" << endl; 
     cerr << "       -n" << endl;
     cerr << "              set the number of LIT indices for non-temporal attribute indexing" << endl;    
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -t threads" << endl;
+    cerr << "              set the number of threads per query; with more than 1, the LIVE INDEXes and HINT are probed concurrently; by default 1" << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              dump the latency percentiles per operation to file; JSON if it ends with .json, CSV otherwise" << endl;
+    cerr << "       -s interval" << endl;
+    cerr << "              set the memory sampling interval in milliseconds; by default " << MEMORY_SAMPLING_INTERVAL << endl;
     cerr << "       -r runs" << endl;
     cerr << "              set the number of runs per query; by default 1" << endl << endl;
     cerr << "EXAMPLE" << endl;
@@ -34,30 +45,24 @@ int main(int argc, char **argv)
 {
     Timer tim;
     vector<HINT_M_Dynamic_Second_Attr*> idxR;
-    vector<LiveIndexCapacityConstraintedICDE16*> lidxR;
-    size_t totalResult = 0, queryresult = 0, numQueries = 0, numInserts = 0, numUpdates = 0;
-    double b_starttime = 0, b_endtime = 0, i_endtime = 0, b_querytime = 0, i_querytime = 0, avgQueryTime = 0;
-    double totalIndexTime = 0, totalBufferStartTime = 0, totalBufferEndTime = 0, totalIndexEndTime = 0, totalQueryTime_b = 0, totalQueryTime_i = 0, totalBufferMergingTime = 0;
-    Timestamp first, second, startEndpoint;
+    vector<LiveIndex*> lidxR;
+    double totalIndexTime = 0;
     RunSettings settings;
-    int numberOfIndices;
-    double third, fourth;
-    char c, operation;
-    double vm = 0, rss = 0, vmMax = 0, rssMax = 0;
-    string strQuery = "", strPredicate = "", strOptimizations = "";
+    int numberOfIndices = 0;
+    char c;
+    unsigned int samplingInterval = MEMORY_SAMPLING_INTERVAL;
+    const char *latencyFile = NULL;
+    string strWorkload = "";
+    int numThreads = 1;
+    ThreadPool *pool = NULL;
     Timestamp leafPartitionExtent = 0;
     string typeBuffer;
     size_t maxCapacity = -1;
     Timestamp maxDuration = -1;
-    unsigned int mergeParameter = 0;
-    size_t maxNumBuffers = 0;
-    size_t segment = ((MAX_ATTRIBUTE_VALUE + numberOfIndices)/ numberOfIndices);
-    size_t sumQ = 0;
-    int indexStart = 0, indexEnd = 0;
     
     settings.init();
     settings.method = "hint_m_dynamic";
-    while ((c = getopt(argc, argv, "?hq:e:c:d:b:m:n:r:")) != -1)
+    while ((c = getopt(argc, argv, "?hq:e:c:d:b:m:n:w:t:o:s:r:")) != -1)
     {
         switch (c)
         {
@@ -86,6 +91,23 @@ int main(int argc, char **argv)
                 maxDuration = atoi(optarg);
                 break;
                 
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+                
+            case 't':
+                numThreads = atoi(optarg);
+                break;
+
+            case 'o':
+                latencyFile = optarg;
+                break;
+
+            case 's':
+                samplingInterval = atoi(optarg);
+                break;
+
+                
             case 'r':
                 settings.numRuns = atoi(optarg);
                 break;
@@ -111,18 +133,47 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    if (numberOfIndices <= 0)
+    {
+        usage();
+        return 1;
+    }
+
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
+
+    if (numThreads <= 0)
+    {
+        usage();
+        return 1;
+    }
+    if (numThreads > 1)
+        pool = new ThreadPool(numThreads-1);
+
     
     idxR.reserve(numberOfIndices);
     lidxR.reserve(numberOfIndices);    
     tim.start();
     for(int i = 0; i < numberOfIndices; i++)
-        idxR[i] = new HINT_M_Dynamic_Second_Attr(leafPartitionExtent);
+        idxR.push_back(new HINT_M_Dynamic_Second_Attr(leafPartitionExtent));
     totalIndexTime = tim.stop();
     
 
     if(maxCapacity != -1)
         for(int i = 0; i < numberOfIndices; i++)
-            lidxR[i] = new LiveIndexCapacityConstraintedICDE16(maxCapacity);
+        {
+            if (typeBuffer == "COLUMNAR")
+                lidxR.push_back(new LiveIndexCapacityConstraintedColumnar(maxCapacity));
+            else if (typeBuffer == "ORDERED")
+                lidxR.push_back(new LiveIndexCapacityConstraintedOrdered(maxCapacity));
+            else if (typeBuffer == "VECTOR")
+                lidxR.push_back(new LiveIndexCapacityConstraintedVector(maxCapacity));
+            else
+                lidxR.push_back(new LiveIndexCapacityConstraintedICDE16(maxCapacity));
+        }
     else
     {
         usage();
@@ -132,7 +183,7 @@ int main(int argc, char **argv)
     
     if (maxCapacity != -1)
     {
-        if (typeBuffer != "ENHANCEDHASHMAP"){
+        if ((typeBuffer != "ENHANCEDHASHMAP") && (typeBuffer != "COLUMNAR") && (typeBuffer != "ORDERED") && (typeBuffer != "VECTOR")){
             usage();
             return 1;
         }
@@ -145,148 +196,28 @@ int main(int argc, char **argv)
 
 
     settings.queryFile = argv[optind];
-    ifstream fQ(settings.queryFile);
-    if (!fQ)
+    Stream fQ(settings.queryFile);
+    if (!fQ.isOpen())
     {
         usage();
         return 1;
     }
 
 
-    while (fQ >> operation >> first >> second  >> third >> fourth)
-    {
-        switch (operation)
-        {
-            case 'S':
-                indexStart = third/segment;
-                tim.start();
-                lidxR[indexStart]->insert_secAttr(first, second, third);
-                b_starttime = tim.stop();
-                totalBufferStartTime += b_starttime;
-                
-                numInserts++;
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'E':
-                indexStart = third/segment;
-
-                tim.start();
-                startEndpoint = lidxR[indexStart]->remove_secAttr(first);
-                b_endtime = tim.stop();
-                totalBufferEndTime += b_endtime;
-                tim.start();
-                idxR[indexStart]->insert(Record(first, startEndpoint, second, third));
-                i_endtime = tim.stop();
-                totalIndexEndTime += i_endtime;
-
-                numUpdates++;                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'Q':
-                numQueries++;
-                sumQ += second-first;
-                indexStart = third/segment;
-                indexEnd = fourth/segment;
-
-                double sumT = 0;
-                for (auto r = 0; r < settings.numRuns; r++)
-                {
-                    if(indexStart != indexEnd){
-                        tim.start();
-                        queryresult = lidxR[indexStart]->executeTimeTravel_greaterthan(RangeQuery(numQueries, first, second), third);
-                        b_querytime = tim.stop();
-
-                        tim.start();
-                        if (first <= idxR[indexStart]->gend){
-#ifdef WORKLOAD_COUNT
-                            queryresult += idxR[indexStart]->executeTimeTravel_greaterthan(RangeQuery(numQueries, first, second), third);
-#else
-                            queryresult ^= idxR[indexStart]->executeTimeTravel_greaterthan(RangeQuery(numQueries, first, second), third);
-#endif
-                        }
-                        i_querytime = tim.stop();
-
-                        for(int i = indexStart+1; i < indexEnd; i++){
-                            tim.start();
-#ifdef WORKLOAD_COUNT
-                            queryresult += lidxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#else
-                            queryresult ^= lidxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#endif
-                            b_querytime += tim.stop();
-
-                            tim.start();
-                            if (first <= idxR[i]->gend){
-#ifdef WORKLOAD_COUNT
-                                queryresult += idxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#else
-                                queryresult ^= idxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#endif
-                            }
-                                i_querytime += tim.stop();
-                        }
-
-
-                        tim.start();
-#ifdef WORKLOAD_COUNT
-                        queryresult += lidxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#else
-                        queryresult ^= lidxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#endif
-                        b_querytime += tim.stop();
-
-                        tim.start();
-                        if (first <= idxR[indexEnd]->gend){
-#ifdef WORKLOAD_COUNT
-                            queryresult += idxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#else
-                            queryresult ^= idxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#endif
-                        }
-                        i_querytime += tim.stop();
-                    }
-                    else{
-                        tim.start();
-#ifdef WORKLOAD_COUNT
-                        queryresult = lidxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#else
-                        queryresult = lidxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#endif
-                        b_querytime = tim.stop();
-
-                        tim.start();
-                        if (first <= idxR[indexStart]->gend){
-#ifdef WORKLOAD_COUNT
-                            queryresult += idxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#else
-                            queryresult ^= idxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#endif
-                        }
-                        i_querytime = tim.stop();
-                    }
-
-                }
-                totalQueryTime_b += b_querytime;
-                totalQueryTime_i += i_querytime;
-                totalResult += queryresult;
-                break;
-        }
-        maxNumBuffers = max(maxNumBuffers, lidxR[0]->getNumBuffers());
-                
-
-                
-        process_mem_usage(vm, rss);
-        vmMax = max(vm, vmMax);
-        rssMax = max(rss, rssMax);
-
-    }
+    LatencyTelemetry latTelemetry;
+    ReplayStats stats;
+    stats.latencyS   = latTelemetry.add("S (buffer)");
+    stats.latencyE_b = latTelemetry.add("E (buffer)");
+    stats.latencyE_i = latTelemetry.add("E (index)");
+    stats.latencyQ_b = latTelemetry.add("Q (buffer)");
+    stats.latencyQ_i = latTelemetry.add("Q (index)");
+    stats.latencyQ   = (pool != NULL)? latTelemetry.add("Q (total)"): NULL;
+    MemoryTelemetry memTelemetry(samplingInterval);
+    ALITReplay method(lidxR, idxR);
+    memTelemetry.start();
+    replayStream(fQ, method, pool, settings.numRuns, settings.typeWorkload, stats);
     fQ.close();
+    memTelemetry.stop();
     
 
     cout << "aLIT" << endl;
@@ -299,24 +230,38 @@ int main(int argc, char **argv)
     else
         cout << "Buffer duration                    : " << maxDuration << endl << endl;
     cout << "Updates report" << endl;
-    cout << "Num of inserts                     : " << numInserts << endl;
-    cout << "Num of updates                     : " << numUpdates << endl;
-    cout << "Num of buffers (max)               : " << maxNumBuffers << endl;
-    printf( "Total updating time (buffer) [secs]: %f\n", (totalBufferStartTime+totalBufferEndTime));
-    printf( "Total updating time (index)  [secs]: %f\n\n", totalIndexEndTime);
+    cout << "Num of inserts                     : " << stats.numInserts << endl;
+    cout << "Num of updates                     : " << stats.numUpdates-stats.numInserts << endl;
+    cout << "Num of buffers (max)               : " << stats.maxNumBuffers << endl;
+    printf( "Total updating time (buffer) [secs]: %f\n", stats.totalBufferUpdateTime);
+    printf( "Total updating time (index)  [secs]: %f\n\n", stats.totalIndexUpdateTime);
     cout << "Queries report" << endl;
-    cout << "Num of queries                     : " << numQueries << endl;
+    cout << "Num of queries                     : " << stats.numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [";
-#ifdef WORKLOAD_COUNT
-    cout << "COUNT]               : ";
-#else
-    cout << "XOR]                 : ";
-#endif
-    cout << totalResult << endl;
-    printf( "Total querying time (buffer) [secs]: %f\n", totalQueryTime_b/settings.numRuns);
-    printf( "Total querying time (index)  [secs]: %f\n\n", totalQueryTime_i/settings.numRuns);
+    printf( "%-35s: %zu\n", ("Total result [" + getWorkloadName(settings.typeWorkload) + "]").c_str(), stats.totalResult);
+    printf( "Total querying time (buffer) [secs]: %f\n", stats.totalQueryTime_b/settings.numRuns);
+    printf( "Total querying time (index)  [secs]: %f\n", stats.totalQueryTime_i/settings.numRuns);
+    if (pool != NULL)
+    {
+        cout << "Num of threads per query           : " << numThreads << endl;
+        printf( "Total querying time (total)  [secs]: %f\n", stats.totalQueryTime/settings.numRuns);
+    }
+    cout << endl;
 
+    size_t liveIndexBytes = 0, hintBytes = 0;
+    for (int i = 0; i < numberOfIndices; i++)
+    {
+        liveIndexBytes += lidxR[i]->getMemoryUsage();
+        hintBytes += idxR[i]->getMemoryUsage();
+    }
+    memTelemetry.account("LIVE INDEX", liveIndexBytes);
+    memTelemetry.account("HINT", hintBytes);
+    latTelemetry.print();
+    if ((latencyFile != NULL) && (!latTelemetry.dump(latencyFile)))
+        cerr << endl << "Error - cannot write latencies to '" << latencyFile << "'" << endl << endl;
+    memTelemetry.print();
+
+    delete pool;
     for(int i = 0; i < numberOfIndices; i++){
         delete lidxR[i];
         delete idxR[i];
@@ -0,0 +1,470 @@
+#include "getopt.h"
+#include "def_global.h"
+#include "./containers/relation.h"
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "replay.h"
+#include "replay_methods.h"
+
+
+
+// One point of a parameter sweep; parameters that do not apply to the method are left at -1
+struct BenchConfig
+{
+    string    method;
+    string    typeBuffer;
+    Timestamp leafPartitionExtent;
+    long      maxCapacity;
+    long      maxDuration;
+    long      numIndices;
+};
+
+struct BenchResult
+{
+    ReplayStats stats;
+    size_t memoryUsage;
+    LatencyHistogram latencyQ;
+
+    BenchResult()
+    {
+        this->memoryUsage = 0;
+        this->stats.latencyQ = &this->latencyQ;
+    };
+};
+
+
+
+void usage()
+{
+    cerr << endl;
+    cerr << "PROJECT" << endl;
+    cerr << "       LIT: Lightning-fast In-memory Temporal Indexing" << endl << endl;
+    cerr << "USAGE" << endl;
+    cerr << "       ./query_bench.exec -m method [OPTIONS] [STREAMFILE]" << endl << endl;
+    cerr << "DESCRIPTION" << endl;
+    cerr << "       Loads the stream once and replays it for every combination of the given parameters;" << endl;
+    cerr << "       each parameter accepts a comma-separated list of values. Outputs one CSV row per combination." << endl << endl;
+    cerr << "       -? or -h" << endl;
+    cerr << "              display this help message and exit" << endl;
+    cerr << "       -m method" << endl;
+    cerr << "              set the method: PURELIT, ALIT, TEHINT, TIMELINEINDEX, 2DRTREE_LIT or 3DRTREE_LIT" << endl;
+    cerr << "       -e" << endl;
+    cerr << "              set the leaf partition extent(s); it is set in seconds" << endl;
+    cerr << "       -b" << endl;
+    cerr << "              set the type(s) of data structure for the LIVE INDEX" << endl;
+    cerr << "       -c" << endl;
+    cerr << "              set the capacity constraint number(s) for the LIVE INDEX; the checkpoint frequency for TIMELINEINDEX" << endl;
+    cerr << "       -d" << endl;
+    cerr << "              set the duration constraint number(s) for the LIVE INDEX" << endl;
+    cerr << "       -n" << endl;
+    cerr << "              set the number(s) of LIT indices for non-temporal attribute indexing" << endl;
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              write the CSV rows to file instead of the standard output" << endl;
+    cerr << "       -r runs" << endl;
+    cerr << "              set the number of runs per query; by default 1" << endl << endl;
+    cerr << "EXAMPLE" << endl;
+    cerr << "       ./query_bench.exec -m PURELIT -e 43200,86400 -b ENHANCEDHASHMAP,MAP -c 1000,10000 streams/BOOKS.bmix" << endl << endl;
+}
+
+
+vector<long> parseNumberList(char *str)
+{
+    vector<long> values;
+    char *token = strtok(str, ",");
+
+    while (token != NULL)
+    {
+        values.push_back(atol(token));
+        token = strtok(NULL, ",");
+    }
+
+    return values;
+}
+
+
+vector<string> parseStringList(char *str)
+{
+    vector<string> values;
+    char *token = strtok(str, ",");
+
+    while (token != NULL)
+    {
+        values.push_back(toUpperCase(token));
+        token = strtok(NULL, ",");
+    }
+
+    return values;
+}
+
+
+LiveIndex* createLiveIndex(const BenchConfig &cfg)
+{
+    if (cfg.maxCapacity != -1)
+    {
+        if (cfg.typeBuffer == "MAP")
+            return new LiveIndexCapacityConstraintedMap(cfg.maxCapacity);
+        else if (cfg.typeBuffer == "VECTOR")
+            return new LiveIndexCapacityConstraintedVector(cfg.maxCapacity);
+        else if (cfg.typeBuffer == "ENHANCEDHASHMAP")
+            return new LiveIndexCapacityConstraintedICDE16(cfg.maxCapacity);
+        else if (cfg.typeBuffer == "COLUMNAR")
+            return new LiveIndexCapacityConstraintedColumnar(cfg.maxCapacity);
+        else if (cfg.typeBuffer == "ORDERED")
+            return new LiveIndexCapacityConstraintedOrdered(cfg.maxCapacity);
+    }
+    else if (cfg.maxDuration != -1)
+    {
+        if (cfg.typeBuffer == "MAP")
+            return new LiveIndexDurationConstraintedMap(cfg.maxDuration);
+        else if (cfg.typeBuffer == "VECTOR")
+            return new LiveIndexDurationConstraintedVector(cfg.maxDuration);
+        else if (cfg.typeBuffer == "ENHANCEDHASHMAP")
+            return new LiveIndexDurationConstraintedICDE16(cfg.maxDuration);
+        else if (cfg.typeBuffer == "COLUMNAR")
+            return new LiveIndexDurationConstraintedColumnar(cfg.maxDuration);
+        else if (cfg.typeBuffer == "ORDERED")
+            return new LiveIndexDurationConstraintedOrdered(cfg.maxDuration);
+    }
+
+    return NULL;
+}
+
+
+bool runPureLIT(LoadedStream &fQ, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    LiveIndex *lidxR = createLiveIndex(cfg);
+    HINT_M_Dynamic *idxR;
+
+
+    if ((lidxR == NULL) || (cfg.leafPartitionExtent <= 0))
+    {
+        delete lidxR;
+        return false;
+    }
+    idxR = new HINT_M_Dynamic(cfg.leafPartitionExtent);
+
+    PureLITReplay method(lidxR, idxR, 0);
+    replayStream(fQ, method, NULL, numRuns, typeWorkload, res.stats);
+    res.memoryUsage = lidxR->getMemoryUsage()+idxR->getMemoryUsage();
+
+    delete lidxR;
+    delete idxR;
+
+    return true;
+}
+
+
+bool runALIT(LoadedStream &fQ, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    vector<HINT_M_Dynamic_Second_Attr*> idxR;
+    vector<LiveIndex*> lidxR;
+
+
+    if ((cfg.maxCapacity == -1) || ((cfg.typeBuffer != "ENHANCEDHASHMAP") && (cfg.typeBuffer != "COLUMNAR") && (cfg.typeBuffer != "ORDERED") && (cfg.typeBuffer != "VECTOR")) || (cfg.leafPartitionExtent <= 0) || (cfg.numIndices <= 0))
+        return false;
+
+    for (auto i = 0; i < cfg.numIndices; i++)
+    {
+        idxR.push_back(new HINT_M_Dynamic_Second_Attr(cfg.leafPartitionExtent));
+        lidxR.push_back(createLiveIndex(cfg));
+    }
+
+    ALITReplay method(lidxR, idxR);
+    replayStream(fQ, method, NULL, numRuns, typeWorkload, res.stats);
+
+    for (auto i = 0; i < cfg.numIndices; i++)
+    {
+        res.memoryUsage += lidxR[i]->getMemoryUsage()+idxR[i]->getMemoryUsage();
+        delete lidxR[i];
+        delete idxR[i];
+    }
+
+    return true;
+}
+
+
+bool runTeHINT(LoadedStream &fQ, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    HINT_M_Dynamic_Naive *idxR;
+
+
+    if (cfg.leafPartitionExtent <= 0)
+        return false;
+    idxR = new HINT_M_Dynamic_Naive(cfg.leafPartitionExtent);
+
+    TeHINTReplay method(idxR);
+    replayStream(fQ, method, NULL, numRuns, typeWorkload, res.stats);
+    res.memoryUsage = idxR->getMemoryUsage();
+
+    delete idxR;
+
+    return true;
+}
+
+
+bool runTimelineIndex(LoadedStream &fQ, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    TimelineIndex *idxR;
+
+
+    if (cfg.maxCapacity <= 0)
+        return false;
+    idxR = new TimelineIndex(cfg.maxCapacity);
+
+    TimelineIndexReplay method(idxR);
+    replayStream(fQ, method, NULL, numRuns, typeWorkload, res.stats);
+    res.memoryUsage = idxR->getMemoryUsage();
+
+    delete idxR;
+
+    return true;
+}
+
+
+bool runRTree2D(LoadedStream &fQ, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    LiveIndex *lidxR = createLiveIndex(cfg);
+
+
+    if (lidxR == NULL)
+        return false;
+
+    RTree2DReplay method(lidxR);
+    replayStream(fQ, method, NULL, numRuns, typeWorkload, res.stats);
+    res.memoryUsage = lidxR->getMemoryUsage();
+
+    delete lidxR;
+
+    return true;
+}
+
+
+bool runRTree3D(LoadedStream &fQ, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    LiveIndex *lidxR = createLiveIndex(cfg);
+
+
+    if (lidxR == NULL)
+        return false;
+
+    RTree3DReplay method(lidxR);
+    replayStream(fQ, method, NULL, numRuns, typeWorkload, res.stats);
+    res.memoryUsage = lidxR->getMemoryUsage();
+
+    delete lidxR;
+
+    return true;
+}
+
+
+bool runMethod(LoadedStream &fQ, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    fQ.rewind();
+    if (cfg.method == "PURELIT")
+        return runPureLIT(fQ, cfg, numRuns, typeWorkload, res);
+    else if (cfg.method == "ALIT")
+        return runALIT(fQ, cfg, numRuns, typeWorkload, res);
+    else if (cfg.method == "TEHINT")
+        return runTeHINT(fQ, cfg, numRuns, typeWorkload, res);
+    else if (cfg.method == "TIMELINEINDEX")
+        return runTimelineIndex(fQ, cfg, numRuns, typeWorkload, res);
+    else if (cfg.method == "2DRTREE_LIT")
+        return runRTree2D(fQ, cfg, numRuns, typeWorkload, res);
+    else if (cfg.method == "3DRTREE_LIT")
+        return runRTree3D(fQ, cfg, numRuns, typeWorkload, res);
+
+    return false;
+}
+
+
+void printHeader(FILE *fOut)
+{
+    fprintf(fOut, "method,buffer,extent,capacity,duration,indices,runs,workload,num_updates,num_queries,result,");
+    fprintf(fOut, "update_buffer_secs,update_index_secs,query_buffer_secs,query_index_secs,query_p50_us,query_p99_us,query_max_us,max_buffers,memory_mb\n");
+}
+
+
+void printRow(FILE *fOut, const BenchConfig &cfg, unsigned int numRuns, unsigned int typeWorkload, BenchResult &res)
+{
+    fprintf(fOut, "%s,%s,%ld,%ld,%ld,%ld,%u,%s,%zu,%zu,%zu,", cfg.method.c_str(), cfg.typeBuffer.c_str(), (long)cfg.leafPartitionExtent, cfg.maxCapacity, cfg.maxDuration, cfg.numIndices, numRuns, getWorkloadName(typeWorkload).c_str(), res.stats.numUpdates, res.stats.numQueries, res.stats.totalResult);
+    fprintf(fOut, "%f,%f,%f,%f,%f,%f,%f,%zu,%f\n", res.stats.totalBufferUpdateTime, res.stats.totalIndexUpdateTime, res.stats.totalQueryTime_b/numRuns, res.stats.totalQueryTime_i/numRuns, res.latencyQ.getPercentile(50)*1e6, res.latencyQ.getPercentile(99)*1e6, res.latencyQ.getMax()*1e6, res.stats.maxNumBuffers, res.memoryUsage/(1024.0*1024.0));
+    fflush(fOut);
+}
+
+
+int main(int argc, char **argv)
+{
+    Timer tim;
+    char c;
+    string method, strWorkload = "";
+    RunSettings settings;
+    vector<long> extents(1, -1), capacities(1, -1), durations(1, -1), indices(1, -1);
+    vector<string> typesBuffer(1, "");
+    unsigned int numRuns = 1;
+    const char *outputFile = NULL;
+    FILE *fOut = stdout;
+    vector<StreamEntry> stream;
+    size_t numConfigs = 0;
+    double loadTime = 0;
+
+
+    settings.init();
+    while ((c = getopt(argc, argv, "?hm:e:c:d:b:n:w:o:r:")) != -1)
+    {
+        switch (c)
+        {
+            case '?':
+            case 'h':
+                usage();
+                return 0;
+
+            case 'm':
+                method = toUpperCase((char*)optarg);
+                break;
+
+            case 'e':
+                extents = parseNumberList(optarg);
+                break;
+
+            case 'b':
+                typesBuffer = parseStringList(optarg);
+                break;
+
+            case 'c':
+                capacities = parseNumberList(optarg);
+                break;
+
+            case 'd':
+                durations = parseNumberList(optarg);
+                break;
+
+            case 'n':
+                indices = parseNumberList(optarg);
+                break;
+
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+
+            case 'o':
+                outputFile = optarg;
+                break;
+
+            case 'r':
+                numRuns = atoi(optarg);
+                break;
+
+            default:
+                cerr << endl << "Error - unknown option '" << c << "'" << endl << endl;
+                usage();
+                return 1;
+        }
+    }
+
+
+    // Sanity check
+    if ((argc-optind != 1) || (method == "") || (numRuns == 0))
+    {
+        usage();
+        return 1;
+    }
+
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
+
+    if ((capacities[0] != -1) && (durations[0] != -1))
+    {
+        cerr << endl << "Error - capacity and duration constraints cannot be swept together" << endl << endl;
+        return 1;
+    }
+
+    // Ignore the parameters a method does not use, so that they do not multiply the runs
+    if ((method == "PURELIT") || (method == "2DRTREE_LIT") || (method == "3DRTREE_LIT"))
+    {
+        indices.assign(1, -1);
+        if (method != "PURELIT")
+            extents.assign(1, -1);
+    }
+    else if (method == "ALIT")
+        durations.assign(1, -1);
+    else if ((method == "TEHINT") || (method == "TIMELINEINDEX"))
+    {
+        typesBuffer.assign(1, "");
+        durations.assign(1, -1);
+        indices.assign(1, -1);
+        if (method == "TEHINT")
+            capacities.assign(1, -1);
+        else
+            extents.assign(1, -1);
+    }
+    else
+    {
+        cerr << endl << "Error - unknown method '" << method << "'" << endl << endl;
+        usage();
+        return 1;
+    }
+
+
+    // Load stream once; all configurations replay it from memory
+    Stream fQ(argv[optind]);
+    if (!fQ.isOpen())
+    {
+        usage();
+        return 1;
+    }
+    tim.start();
+    fQ.load(stream);
+    loadTime = tim.stop();
+    fQ.close();
+    cerr << "Loaded " << stream.size() << " operations in " << loadTime << " secs" << endl;
+    LoadedStream fLoaded(stream);
+
+    if (outputFile != NULL)
+    {
+        fOut = fopen(outputFile, "w");
+        if (fOut == NULL)
+        {
+            cerr << endl << "Error - cannot open '" << outputFile << "'" << endl << endl;
+            return 1;
+        }
+    }
+
+
+    printHeader(fOut);
+    for (auto &typeBuffer : typesBuffer)
+    {
+        for (auto e : extents)
+        {
+            for (auto cap : capacities)
+            {
+                for (auto dur : durations)
+                {
+                    for (auto n : indices)
+                    {
+                        BenchConfig cfg = {method, typeBuffer, e, cap, dur, n};
+                        BenchResult res;
+
+                        if (!runMethod(fLoaded, cfg, numRuns, settings.typeWorkload, res))
+                        {
+                            cerr << endl << "Error - invalid parameters for method '" << method << "' (buffer '" << typeBuffer << "', extent " << e << ", capacity " << cap << ", duration " << dur << ", indices " << n << ")" << endl << endl;
+                            continue;
+                        }
+                        printRow(fOut, cfg, numRuns, settings.typeWorkload, res);
+                        numConfigs++;
+                    }
+                }
+            }
+        }
+    }
+
+    if (fOut != stdout)
+        fclose(fOut);
+
+
+    return (numConfigs > 0)? 0: 1;
+}
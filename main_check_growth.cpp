@@ -0,0 +1,136 @@
+#include "getopt.h"
+#include "def_global.h"
+#include "./containers/relation.h"
+#include "./containers/thread_pool.h"
+#include "./indices/hint_m.h"
+#include <random>
+
+
+
+void usage()
+{
+    cerr << endl;
+    cerr << "PROJECT" << endl;
+    cerr << "       LIT: Lightning-fast In-memory Temporal Indexing" << endl << endl;
+    cerr << "USAGE" << endl;
+    cerr << "       ./check_growth.exec [OPTIONS]" << endl << endl;
+    cerr << "DESCRIPTION" << endl;
+    cerr << "       Inserts random growing streams into HINT, their ends passing the indexed domain several times," << endl;
+    cerr << "       and checks every query against a brute-force scan of the inserted records. Exits with 1 on" << endl;
+    cerr << "       the first mismatch." << endl << endl;
+    cerr << "       -? or -h" << endl;
+    cerr << "              display this help message and exit" << endl;
+    cerr << "       -n trials" << endl;
+    cerr << "              set the number of streams; by default 20" << endl;
+    cerr << "       -s seed" << endl;
+    cerr << "              set the seed of the generator; by default 7" << endl << endl;
+    cerr << "EXAMPLE" << endl;
+    cerr << "       ./check_growth.exec -n 100 -s 42" << endl << endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    char c;
+    unsigned int numTrials = 20, seed = 7;
+    size_t numQueries = 0, numGrowths = 0;
+    ThreadPool pool(2);
+
+
+    while ((c = getopt(argc, argv, "?hn:s:")) != -1)
+    {
+        switch (c)
+        {
+            case '?':
+            case 'h':
+                usage();
+                return 0;
+
+            case 'n':
+                numTrials = atoi(optarg);
+                break;
+
+            case 's':
+                seed = atoi(optarg);
+                break;
+
+            default:
+                cerr << endl << "Error - unknown option '" << c << "'" << endl << endl;
+                usage();
+                return 1;
+        }
+    }
+
+    if ((argc-optind != 0) || (numTrials <= 0))
+    {
+        usage();
+        return 1;
+    }
+
+
+    mt19937 gen(seed);
+    for (auto t = 0; t < numTrials; t++)
+    {
+        Timestamp leafPartitionExtent = 1+gen()%300;
+        HINT_M_Dynamic idx(leafPartitionExtent);
+        Relation R;
+        Timestamp now = 0;
+        unsigned int numBits = idx.numBits, trialGrowths = 0;
+        size_t numRecords = 2000+gen()%20000;
+
+        // Every other stream scans HINT in parallel, whatever the size of the result
+        if (t%2 == 1)
+            idx.setParallelism(&pool, 0);
+
+        // Ends are non-decreasing, so HINT grows whenever one passes gend; a quarter of the records reach far back
+        for (auto i = 0; i < numRecords; i++)
+        {
+            Timestamp extent = (gen()%4 == 0)? gen()%(now+1): gen()%50;
+            Record r(i, max((Timestamp)0, now-extent), now);
+
+            idx.insert(r);
+            R.push_back(r);
+            if (idx.numBits != numBits)
+            {
+                trialGrowths += idx.numBits-numBits;
+                numBits = idx.numBits;
+            }
+
+            if ((i%97 == 0) || (i == numRecords-1))
+            {
+                for (auto q = 0; q < 5; q++)
+                {
+                    Timestamp qstart = gen()%(now+100);
+                    RangeQuery Q(numQueries++, qstart, qstart+gen()%(1+((q%2 == 1)? 5000: 50)));
+                    WorkloadSink sink;
+                    size_t result;
+
+                    if (Q.start <= idx.gend)
+                        idx.execute_pureTimeTravel(Q, sink);
+                    result = R.execute_gOverlaps(Q);
+                    if (sink.getResult() != result)
+                    {
+                        cerr << endl << "Error - stream " << t << " (leaf extent " << leafPartitionExtent << "), after " << (i+1) << " records, query [" << Q.start << ", " << Q.end << "]: " << sink.getResult() << " instead of " << result << endl << endl;
+                        return 1;
+                    }
+                }
+            }
+            now += gen()%((t%5+1)*40);
+        }
+
+        // The stream must have made HINT grow, or it checked nothing
+        if (trialGrowths < 2)
+        {
+            cerr << endl << "Error - stream " << t << " grew HINT only " << trialGrowths << " times" << endl << endl;
+            return 1;
+        }
+        numGrowths += trialGrowths;
+    }
+
+    cout << "Num of streams                     : " << numTrials << endl;
+    cout << "Num of root levels added           : " << numGrowths << endl;
+    cout << "Num of queries checked             : " << numQueries << endl;
+
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "getopt.h"
+#include "def_global.h"
+#include "./indices/live_index.cpp"
+#include <random>
+#include <map>
+
+
+
+void usage()
+{
+    cerr << endl;
+    cerr << "PROJECT" << endl;
+    cerr << "       LIT: Lightning-fast In-memory Temporal Indexing" << endl << endl;
+    cerr << "USAGE" << endl;
+    cerr << "       ./check_reorganize.exec [OPTIONS]" << endl << endl;
+    cerr << "DESCRIPTION" << endl;
+    cerr << "       Inserts and removes random records in capacity-constrained LIVE INDEXes of every buffer type while" << endl;
+    cerr << "       they are reorganized to other capacities, and checks every removal and query against the records" << endl;
+    cerr << "       inserted and not removed. Exits with 1 on the first mismatch." << endl << endl;
+    cerr << "       -? or -h" << endl;
+    cerr << "              display this help message and exit" << endl;
+    cerr << "       -n trials" << endl;
+    cerr << "              set the number of streams per buffer type; by default 10" << endl;
+    cerr << "       -s seed" << endl;
+    cerr << "              set the seed of the generator; by default 7" << endl << endl;
+    cerr << "EXAMPLE" << endl;
+    cerr << "       ./check_reorganize.exec -n 100 -s 42" << endl << endl;
+}
+
+
+// Counts the records of live that start not after Q.end, the answer of a LIVE INDEX to any query
+inline size_t countLive(const map<RecordId, Timestamp> &live, RangeQuery Q)
+{
+    size_t result = 0;
+
+    for (auto &r : live)
+        result += (r.second <= Q.end);
+
+    return result;
+}
+
+
+// Buffers drained while a reorganization is under way end up inside a coalesced run; none of them may be picked as
+// the last buffer of a query afterwards. Buffers of 10 records starting at 10*id; b0, b1 and b2 are drained down to
+// a single record, then the one of b1 goes once the reorganization started, i.e., b0..b3 are coalesced into b0
+// around the empty b1.
+template <class T>
+bool checkDrainedRun(const char *name)
+{
+    LiveIndexCapacityConstrainted<T> lidx(10);
+    LiveIndexTuner tuner(numeric_limits<size_t>::max());
+    map<RecordId, Timestamp> live;
+    RangeQuery Q(0, 0, 150);
+    CountSink sink;
+
+
+    for (RecordId id = 0; id <= 300; id++)
+    {
+        lidx.insert(id, 10*id);
+        live[id] = 10*id;
+    }
+    for (RecordId id = 1; id < 30; id++)
+    {
+        if (id%10 != 0)
+        {
+            lidx.remove(id);
+            live.erase(id);
+        }
+    }
+    lidx.setTuner(&tuner);
+    lidx.reorganize(15);
+    lidx.remove(10);
+    live.erase(10);
+
+    lidx.execute_pureTimeTravel(Q, sink);
+    if (sink.getResult() != countLive(live, Q))
+    {
+        cerr << endl << "Error - " << name << ", drained buffer in a coalesced run, query [" << Q.start << ", " << Q.end << "]: " << sink.getResult() << " instead of " << countLive(live, Q) << endl << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+// Random stream on a LIVE INDEX reorganized every few hundred updates, mostly removing old records so that buffers
+// at the front drain while a reorganization is under way
+template <class T>
+bool checkStream(const char *name, mt19937 &gen, size_t &numQueries)
+{
+    LiveIndexCapacityConstrainted<T> lidx(8+gen()%64);
+    LiveIndexTuner tuner(numeric_limits<size_t>::max());
+    map<RecordId, Timestamp> live;
+    RecordId nextId = gen()%1000;
+    Timestamp now = 0;
+    size_t numUpdates = 20000+gen()%20000;
+
+
+    lidx.setTuner(&tuner);
+    for (auto i = 0; i < numUpdates; i++)
+    {
+        if ((live.empty()) || (gen()%100 < 52))
+        {
+            lidx.insert(nextId, now);
+            live[nextId++] = now;
+        }
+        else
+        {
+            auto iter = live.begin();
+
+            advance(iter, (gen()%4 == 0)? gen()%live.size(): gen()%min(live.size(), (size_t)50));
+
+            Timestamp start = lidx.remove(iter->first);
+            if (start != iter->second)
+            {
+                cerr << endl << "Error - " << name << ", after " << i << " updates, removing record " << iter->first << ": start " << start << " instead of " << iter->second << endl << endl;
+                return false;
+            }
+            live.erase(iter);
+        }
+        now += gen()%3;
+
+        if (gen()%300 == 0)
+            lidx.reorganize(8+gen()%64);
+
+        if (i%20 == 0)
+        {
+            Timestamp qstart = gen()%(now+1);
+            RangeQuery Q(numQueries++, qstart, qstart+gen()%50);
+            CountSink sink;
+
+            lidx.execute_pureTimeTravel(Q, sink);
+            if (sink.getResult() != countLive(live, Q))
+            {
+                cerr << endl << "Error - " << name << ", after " << i << " updates, query [" << Q.start << ", " << Q.end << "]: " << sink.getResult() << " instead of " << countLive(live, Q) << endl << endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+template <class T>
+bool check(const char *name, unsigned int numTrials, mt19937 &gen, size_t &numQueries)
+{
+    if (!checkDrainedRun<T>(name))
+        return false;
+    for (auto t = 0; t < numTrials; t++)
+    {
+        if (!checkStream<T>(name, gen, numQueries))
+            return false;
+    }
+
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    char c;
+    unsigned int numTrials = 10, seed = 7;
+    size_t numQueries = 0;
+
+
+    while ((c = getopt(argc, argv, "?hn:s:")) != -1)
+    {
+        switch (c)
+        {
+            case '?':
+            case 'h':
+                usage();
+                return 0;
+
+            case 'n':
+                numTrials = atoi(optarg);
+                break;
+
+            case 's':
+                seed = atoi(optarg);
+                break;
+
+            default:
+                cerr << endl << "Error - unknown option '" << c << "'" << endl << endl;
+                usage();
+                return 1;
+        }
+    }
+
+    if ((argc-optind != 0) || (numTrials <= 0))
+    {
+        usage();
+        return 1;
+    }
+
+
+    mt19937 gen(seed);
+    if ((!check<Buffer_Map>("MAP", numTrials, gen, numQueries)) ||
+        (!check<Buffer_Vector>("VECTOR", numTrials, gen, numQueries)) ||
+        (!check<Buffer_ICDE16>("ENHANCEDHASHMAP", numTrials, gen, numQueries)) ||
+        (!check<Buffer_Columnar>("COLUMNAR", numTrials, gen, numQueries)) ||
+        (!check<Buffer_Ordered>("ORDERED", numTrials, gen, numQueries)))
+        return 1;
+
+    cout << "Num of streams per buffer type     : " << numTrials << endl;
+    cout << "Num of queries checked             : " << numQueries << endl;
+
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+#include "getopt.h"
+#include "def_global.h"
+#include "./containers/relation.h"
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "./indices/hint_m.h"
+#include "./indices/live_index_concurrent.h"
+#include "./indices/snapshot_lit.h"
+#include <thread>
+
+
+
+void usage()
+{
+    cerr << endl;
+    cerr << "PROJECT" << endl;
+    cerr << "       LIT: Lightning-fast In-memory Temporal Indexing" << endl << endl;
+    cerr << "USAGE" << endl;
+    cerr << "       ./query_concurrentLIT.exec [OPTIONS] [STREAMFILE]" << endl << endl;
+    cerr << "DESCRIPTION" << endl;
+    cerr << "       A writer thread applies the updates of the stream while reader threads run its queries concurrently;" << endl;
+    cerr << "       each query reads a snapshot of the stream taken when it starts, no earlier than its position in the stream." << endl << endl;
+    cerr << "       -? or -h" << endl;
+    cerr << "              display this help message and exit" << endl;
+    cerr << "       -e" << endl;
+    cerr << "              set the leaf partition extent; it is set in seconds" << endl;
+    cerr << "       -c" << endl;
+    cerr << "              set the capacity constraint number for the LIVE INDEX" << endl;
+    cerr << "       -n readers" << endl;
+    cerr << "              set the number of reader threads; by default 1" << endl;
+    cerr << "       -x" << endl;
+    cerr << "              exact snapshots: the writer waits for every query to finish before applying the next update" << endl;
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              dump the latency percentiles per operation to file; JSON if it ends with .json, CSV otherwise" << endl;
+    cerr << "       -s interval" << endl;
+    cerr << "              set the memory sampling interval in milliseconds; by default " << MEMORY_SAMPLING_INTERVAL << endl << endl;
+    cerr << "EXAMPLE" << endl;
+    cerr << "       ./query_concurrentLIT.exec -e 86400 -c 10000 -n 4 streams/BOOKS.bmix" << endl << endl;
+}
+
+
+// A query of the stream and the number of updates preceding it
+struct StreamQuery
+{
+    Timestamp start, end;
+    uint64_t position;
+    size_t result;
+    uint64_t snapshot;
+};
+
+
+template <class S>
+size_t executeQuery(SnapshotLIT *slit, StreamQuery &q, size_t qid, S &sink)
+{
+    q.snapshot = slit->execute_pureTimeTravel(RangeQuery(qid, q.start, q.end), sink);
+
+    return sink.getResult();
+}
+
+
+int main(int argc, char **argv)
+{
+    Timer tim, timTotal;
+    SnapshotLIT *slit;
+    RunSettings settings;
+    char c;
+    unsigned int samplingInterval = MEMORY_SAMPLING_INTERVAL;
+    const char *latencyFile = NULL;
+    string strWorkload = "";
+    Timestamp leafPartitionExtent = 0;
+    size_t maxCapacity = -1;
+    unsigned int numReaders = 1;
+    bool exact = false;
+    vector<StreamEntry> entries;
+    vector<StreamQuery> queries;
+    size_t totalResult = 0, numUpdates = 0, maxNumBuffers = 0;
+    uint64_t totalLag = 0, maxLag = 0;
+    double totalUpdateTime = 0, totalTime = 0;
+    atomic<uint64_t> numApplied(0);         // Updates applied by the writer
+    atomic<size_t> nextQuery(0), numFinished(0);
+
+
+    settings.init();
+    settings.method = "concurrentLIT";
+    while ((c = getopt(argc, argv, "?he:c:n:xw:o:s:")) != -1)
+    {
+        switch (c)
+        {
+            case '?':
+            case 'h':
+                usage();
+                return 0;
+
+            case 'e':
+                leafPartitionExtent = atoi(optarg);
+                break;
+
+            case 'c':
+                maxCapacity = atoi(optarg);
+                break;
+
+            case 'n':
+                numReaders = atoi(optarg);
+                break;
+
+            case 'x':
+                exact = true;
+                break;
+
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+
+            case 'o':
+                latencyFile = optarg;
+                break;
+
+            case 's':
+                samplingInterval = atoi(optarg);
+                break;
+
+            default:
+                cerr << endl << "Error - unknown option '" << c << "'" << endl << endl;
+                usage();
+                return 1;
+        }
+    }
+
+
+    if (argc-optind != 1)
+    {
+        usage();
+        return 1;
+    }
+
+    if ((leafPartitionExtent <= 0) || (maxCapacity == -1) || (numReaders <= 0))
+    {
+        usage();
+        return 1;
+    }
+
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
+
+
+    // Load stream; the updates are replayed from memory so that the writer does not wait on the file
+    settings.queryFile = argv[optind];
+    Stream fQ(settings.queryFile);
+    if (!fQ.isOpen())
+    {
+        usage();
+        return 1;
+    }
+    fQ.load(entries);
+    fQ.close();
+    for (auto &e : entries)
+    {
+        if (e.operation == 'Q')
+            queries.push_back({e.first, e.second, numUpdates, 0, 0});
+        else
+            numUpdates++;
+    }
+
+
+    LatencyTelemetry latTelemetry;
+    LatencyHistogram *latencyS = latTelemetry.add("S");
+    LatencyHistogram *latencyE = latTelemetry.add("E");
+    vector<LatencyHistogram*> latencyQ;
+    for (auto i = 0; i < numReaders; i++)
+        latencyQ.push_back(latTelemetry.add("Q (reader " + to_string(i) + ")"));
+    MemoryTelemetry memTelemetry(samplingInterval);
+    memTelemetry.start();
+    slit = new SnapshotLIT(new LiveIndexConcurrent(maxCapacity), new HINT_M_Dynamic(leafPartitionExtent));
+    timTotal.start();
+
+    thread writer([&]()
+    {
+        Timer timU;
+        size_t numQueriesBefore = 0;
+        double updatetime;
+
+        for (auto &e : entries)
+        {
+            if (e.operation == 'Q')
+            {
+                numQueriesBefore++;
+                continue;
+            }
+
+            // Exact snapshots: the queries issued before this update must have read the stream without it
+            while ((exact) && (numFinished.load(memory_order_acquire) < numQueriesBefore))
+                this_thread::yield();
+
+            timU.start();
+            if (e.operation == 'S')
+                slit->insert(e.first, e.second);
+            else
+                slit->remove(e.first, e.second);
+            updatetime = timU.stop();
+            (e.operation == 'S') ? latencyS->record(updatetime) : latencyE->record(updatetime);
+            totalUpdateTime += updatetime;
+            numApplied.store(numApplied.load(memory_order_relaxed)+1, memory_order_release);
+        }
+    });
+
+    vector<thread> readers;
+    for (auto i = 0; i < numReaders; i++)
+    {
+        readers.emplace_back([&, i]()
+        {
+            Timer timQ;
+            vector<RecordId> ids;       // Output of the IDS workload; reused across queries
+            size_t qid;
+
+            while ((qid = nextQuery++) < queries.size())
+            {
+                StreamQuery &q = queries[qid];
+
+                // A query is not answered before the stream reaches it
+                while (numApplied.load(memory_order_acquire) < q.position)
+                    this_thread::yield();
+
+                timQ.start();
+                switch (settings.typeWorkload)
+                {
+                    case WORKLOAD_MODE_COUNT:
+                    {
+                        CountSink sink;
+                        q.result = executeQuery(slit, q, qid+1, sink);
+                        break;
+                    }
+                    case WORKLOAD_MODE_XOR:
+                    {
+                        XorSink sink;
+                        q.result = executeQuery(slit, q, qid+1, sink);
+                        break;
+                    }
+                    case WORKLOAD_MODE_IDS:
+                    {
+                        IdSink sink(ids);
+                        ids.clear();
+                        q.result = executeQuery(slit, q, qid+1, sink);
+                        break;
+                    }
+                }
+                latencyQ[i]->record(timQ.stop());
+                numFinished++;
+            }
+        });
+    }
+
+    writer.join();
+    for (auto &r : readers)
+        r.join();
+    totalTime = timTotal.stop();
+    memTelemetry.stop();
+    maxNumBuffers = slit->getNumBuffers();
+    for (auto &q : queries)
+    {
+        totalResult += q.result;
+        totalLag += q.snapshot-q.position;
+        maxLag = max(maxLag, q.snapshot-q.position);
+    }
+
+
+    // Report
+    cout << endl;
+    cout << "concurrentLIT" << endl;
+    cout << "====================" << endl;
+    cout << endl;
+    cout << "Buffer info" << endl;
+    cout << "Type                               : CONCURRENT" << endl;
+    cout << "Buffer capacity                    : " << maxCapacity << endl << endl;
+    cout << "Concurrency info" << endl;
+    cout << "Num of reader threads              : " << numReaders << endl;
+    cout << "Exact snapshots                    : " << (exact ? "yes" : "no") << endl << endl;
+    cout << "Updates report" << endl;
+    cout << "Num of updates                     : " << numUpdates << endl;
+    cout << "Num of buffers                     : " << maxNumBuffers << endl;
+    printf( "Total updating time          [secs]: %f\n\n", totalUpdateTime);
+    cout << "Queries report" << endl;
+    cout << "Num of queries                     : " << queries.size() << endl;
+    if (settings.typeWorkload == WORKLOAD_MODE_COUNT)
+        cout << "Total result [COUNT]               : ";
+    else if (settings.typeWorkload == WORKLOAD_MODE_XOR)
+        cout << "Total result [XOR]                 : ";
+    else
+        cout << "Total result [IDS]                 : ";
+    cout << totalResult << endl;
+    printf( "Avg snapshot lag          [updates]: %f\n", (queries.empty() ? 0 : (double)totalLag/queries.size()));
+    cout << "Max snapshot lag          [updates]: " << maxLag << endl;
+    printf( "Total time                   [secs]: %f\n\n", totalTime);
+
+
+    memTelemetry.account("LIVE INDEX", slit->getLiveIndexMemoryUsage());
+    memTelemetry.account("HINT", slit->getHINTMemoryUsage());
+    latTelemetry.print();
+    if ((latencyFile != NULL) && (!latTelemetry.dump(latencyFile)))
+        cerr << endl << "Error - cannot write latencies to '" << latencyFile << "'" << endl << endl;
+    memTelemetry.print();
+
+    delete slit;
+
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "getopt.h"
+#include "def_global.h"
+#include "./containers/stream.h"
+
+
+
+void usage()
+{
+    cerr << endl;
+    cerr << "PROJECT" << endl;
+    cerr << "       LIT: Lightning-fast In-memory Temporal Indexing" << endl << endl;
+    cerr << "USAGE" << endl;
+    cerr << "       ./convert_stream.exec [OPTIONS] [STREAMFILE] [BINARYFILE]" << endl << endl;
+    cerr << "DESCRIPTION" << endl;
+    cerr << "       Converts a text update/query stream (.mix) into the fixed-width binary stream format," << endl;
+    cerr << "       which all query executables memory-map instead of parsing." << endl << endl;
+    cerr << "       -? or -h" << endl;
+    cerr << "              display this help message and exit" << endl << endl;
+    cerr << "EXAMPLE" << endl;
+    cerr << "       ./convert_stream.exec streams/BOOKS.mix streams/BOOKS.bmix" << endl << endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    Timer tim;
+    char c;
+    size_t numEntries = 0;
+    double convertTime = 0;
+
+
+    while ((c = getopt(argc, argv, "?h")) != -1)
+    {
+        switch (c)
+        {
+            case '?':
+            case 'h':
+                usage();
+                return 0;
+
+            default:
+                cerr << endl << "Error - unknown option '" << c << "'" << endl << endl;
+                usage();
+                return 1;
+        }
+    }
+
+
+    if (argc-optind != 2)
+    {
+        usage();
+        return 1;
+    }
+
+
+    tim.start();
+    if (!Stream::convert(argv[optind], argv[optind+1], numEntries))
+    {
+        cerr << endl << "Error - cannot convert '" << argv[optind] << "' into '" << argv[optind+1] << "'" << endl << endl;
+        return 1;
+    }
+    convertTime = tim.stop();
+
+
+    // Report
+    cout << endl;
+    cout << "Stream conversion" << endl;
+    cout << "====================" << endl;
+    cout << "Input (text)                       : " << argv[optind] << endl;
+    cout << "Output (binary)                    : " << argv[optind+1] << endl;
+    cout << "Num of operations                  : " << numEntries << endl;
+    cout << "Entry size [bytes]                 : " << sizeof(StreamEntry) << endl;
+    printf( "Conversion time              [secs]: %f\n\n", convertTime);
+
+
+    return 0;
+}
@@ -1,8 +1,11 @@
 #include "getopt.h"
 #include "def_global.h"
 #include "./containers/relation.h"
-#include "./indices/hint_m.h"
-#include "./indices/live_index.cpp"
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "replay.h"
+#include "replay_methods.h"
+#include "./indices/live_index_concurrent.h"
 
 //#define ACTIVATE_PROGRESS_BAR
 
@@ -38,8 +41,24 @@ void usage()
     cerr << "              set the capacity constraint number for the LIVE INDEX" << endl; 
     cerr << "       -d" << endl;
     cerr << "              set the duration constraint number for the LIVE INDEX" << endl;      
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -t threads" << endl;
+    cerr << "              set the number of threads per query; with more than 1, the LIVE INDEX and HINT are probed concurrently; by default 1" << endl;
+    cerr << "       -p threshold" << endl;
+    cerr << "              with more than 1 thread, scan HINT in parallel when a query is estimated to return at least threshold records; by default " << HINT_PARALLEL_THRESHOLD << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              dump the latency percentiles per operation to file; JSON if it ends with .json, CSV otherwise" << endl;
+    cerr << "       -s interval" << endl;
+    cerr << "              set the memory sampling interval in milliseconds; by default " << MEMORY_SAMPLING_INTERVAL << endl;
     cerr << "       -r runs" << endl;
-    cerr << "              set the number of runs per query; by default 1" << endl << endl;
+    cerr << "              set the number of runs per query; by default 1" << endl;
+    cerr << "       -a window" << endl;
+    cerr << "              retune the capacity of a MAP, ENHANCEDHASHMAP, COLUMNAR or ORDERED LIVE INDEX every window updates, starting from -c; e.g., " << TUNER_WINDOW_SIZE << endl;
+    cerr << "       -k horizon" << endl;
+    cerr << "              retain only the dead records of the last horizon seconds in HINT, evicting older partitions; queries are answered over the retained domain" << endl;
+    cerr << "       -f directory" << endl;
+    cerr << "              with -k, seal the partitions past the horizon into segment files in directory, read back through mmap, instead of evicting them; queries still cover the whole domain" << endl << endl;
     cerr << "EXAMPLE" << endl;
     cerr << "       ./query_pureLIT.exec -e 86400 -b ENHANCEDHASHMAP -c 10000 streams/BOOKS.mix" << endl << endl;
 }
@@ -48,29 +67,30 @@ void usage()
 int main(int argc, char **argv)
 {
     Timer tim;
-    Record r;
     HINT_M_Dynamic *idxR;
     LiveIndex *lidxR;
-    size_t totalResult = 0, queryresult = 0, numQueries = 0, numUpdates = 0;
-    double b_starttime = 0, b_endtime = 0, i_endtime = 0, b_querytime = 0, i_querytime = 0, avgQueryTime = 0;
-    double totalIndexTime = 0, totalBufferStartTime = 0, totalBufferEndTime = 0, totalIndexEndTime = 0, totalQueryTime_b = 0, totalQueryTime_i = 0, totalBufferMergingTime = 0;
-    Timestamp first, second, startEndpoint;
+    double totalIndexTime = 0;
     RunSettings settings;
-    char c, operation;
-    double third, fourth;
-    double vm = 0, rss = 0, vmMax = 0, rssMax = 0;
-    string strQuery = "", strPredicate = "", strOptimizations = "";
+    char c;
+    unsigned int samplingInterval = MEMORY_SAMPLING_INTERVAL;
+    const char *latencyFile = NULL;
+    string strWorkload = "";
+    int numThreads = 1;
+    size_t parallelThreshold = HINT_PARALLEL_THRESHOLD;
+    ThreadPool *pool = NULL;
     Timestamp leafPartitionExtent = 0;
     string typeBuffer;
     size_t maxCapacity = -1;
     Timestamp maxDuration = -1;
-    unsigned int mergeParameter = 0;
-    size_t maxNumBuffers = 0;
+    size_t tunerWindow = 0;
+    LiveIndexTuner *tuner = NULL;
+    Timestamp horizon = 0;
+    const char *coldDirectory = NULL;
 
     
     settings.init();
     settings.method = "pureLIT";
-    while ((c = getopt(argc, argv, "?hq:e:c:d:b:r:")) != -1)
+    while ((c = getopt(argc, argv, "?hq:e:c:d:b:w:t:p:o:s:r:a:k:f:")) != -1)
     {
         switch (c)
         {
@@ -96,10 +116,43 @@ int main(int argc, char **argv)
                 maxDuration = atoi(optarg);
                 break;
                                 
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+
+            case 't':
+                numThreads = atoi(optarg);
+                break;
+
+            case 'p':
+                parallelThreshold = atol(optarg);
+                break;
+
+            case 'o':
+                latencyFile = optarg;
+                break;
+
+            case 's':
+                samplingInterval = atoi(optarg);
+                break;
+
+                                
             case 'r':
                 settings.numRuns = atoi(optarg);
                 break;
 
+            case 'a':
+                tunerWindow = atol(optarg);
+                break;
+
+            case 'k':
+                horizon = atoi(optarg);
+                break;
+
+            case 'f':
+                coldDirectory = optarg;
+                break;
+
             default:
                 cerr << endl << "Error - unknown option '" << c << "'" << endl << endl;
                 usage();
@@ -120,12 +173,36 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    if ((horizon < 0) || ((coldDirectory != NULL) && (horizon == 0)))
+    {
+        usage();
+        return 1;
+    }
+
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
+
+    if (numThreads <= 0)
+    {
+        usage();
+        return 1;
+    }
+    if (numThreads > 1)
+        pool = new ThreadPool(numThreads-1);
+
 
     
     
     tim.start();
     idxR = new HINT_M_Dynamic(leafPartitionExtent);
     totalIndexTime = tim.stop();
+    if (pool != NULL)
+        idxR->setParallelism(pool, parallelThreshold);
+    if (coldDirectory != NULL)
+        idxR->setColdStorage(coldDirectory);
     
 
     
@@ -137,6 +214,12 @@ int main(int argc, char **argv)
             lidxR = new LiveIndexCapacityConstraintedVector(maxCapacity);
         else if (typeBuffer == "ENHANCEDHASHMAP")
             lidxR = new LiveIndexCapacityConstraintedICDE16(maxCapacity);
+        else if (typeBuffer == "COLUMNAR")
+            lidxR = new LiveIndexCapacityConstraintedColumnar(maxCapacity);
+        else if (typeBuffer == "ORDERED")
+            lidxR = new LiveIndexCapacityConstraintedOrdered(maxCapacity);
+        else if (typeBuffer == "CONCURRENT")
+            lidxR = new LiveIndexConcurrent(maxCapacity);
         else
         {
                 usage();
@@ -151,6 +234,10 @@ int main(int argc, char **argv)
             lidxR = new LiveIndexDurationConstraintedVector(maxDuration);
         else if (typeBuffer == "ENHANCEDHASHMAP")
             lidxR = new LiveIndexDurationConstraintedICDE16(maxDuration);
+        else if (typeBuffer == "COLUMNAR")
+            lidxR = new LiveIndexDurationConstraintedColumnar(maxDuration);
+        else if (typeBuffer == "ORDERED")
+            lidxR = new LiveIndexDurationConstraintedOrdered(maxDuration);
         else
         {
             usage();
@@ -163,97 +250,45 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    // Self-tuning applies to the capacity-constrained LIVE INDEX, on the buffers that can be coalesced
+    if (tunerWindow > 0)
+    {
+        if ((maxCapacity == -1) || ((typeBuffer != "MAP") && (typeBuffer != "ENHANCEDHASHMAP") && (typeBuffer != "COLUMNAR") && (typeBuffer != "ORDERED")))
+        {
+            usage();
+            return 1;
+        }
+        tuner = new LiveIndexTuner(tunerWindow);
+        lidxR->setTuner(tuner);
+    }
+
     
     
 
     // Load stream
     settings.queryFile = argv[optind];
-    ifstream fQ(settings.queryFile);
-    if (!fQ)
+    Stream fQ(settings.queryFile);
+    if (!fQ.isOpen())
     {
         usage();
         return 1;
     }
 
 
-    // Read stream
-    size_t sumQ = 0;
-    size_t count = 0;
-
-
-    while (fQ >> operation >> first >> second >> third >> fourth)
-    {
-        switch (operation)
-        {
-            case 'S':
-                tim.start();
-                lidxR->insert(first, second);
-                b_starttime = tim.stop();
-                totalBufferStartTime += b_starttime;
-                
-                numUpdates++;
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'E':
-                tim.start();
-                startEndpoint = lidxR->remove(first);
-                b_endtime = tim.stop();
-                totalBufferEndTime += b_endtime;
-                
-                tim.start();
-                idxR->insert(Record(first, startEndpoint, second));
-                i_endtime = tim.stop();
-                totalIndexEndTime += i_endtime;
-
-                numUpdates++;
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'Q':
-                numQueries++;
-                sumQ += second-first;
-
-                double sumT = 0;
-                for (auto r = 0; r < settings.numRuns; r++)
-                {
-
-                    tim.start();
-                    queryresult = lidxR->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-                    b_querytime = tim.stop();
-
-                    tim.start();
-                    if (first <= idxR->gend){
-#ifdef WORKLOAD_COUNT
-                        queryresult += idxR->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#else
-                        queryresult ^= idxR->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#endif
-                    }
-                    i_querytime = tim.stop();
-
-                    totalQueryTime_b += b_querytime;
-                    totalQueryTime_i += i_querytime;
-
-                }
-                totalResult += queryresult;
-                avgQueryTime += sumT/settings.numRuns;
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-        }     
-        maxNumBuffers = max(maxNumBuffers, lidxR->getNumBuffers());
-
-    }
+    LatencyTelemetry latTelemetry;
+    ReplayStats stats;
+    stats.latencyS   = latTelemetry.add("S (buffer)");
+    stats.latencyE_b = latTelemetry.add("E (buffer)");
+    stats.latencyE_i = latTelemetry.add("E (index)");
+    stats.latencyQ_b = latTelemetry.add("Q (buffer)");
+    stats.latencyQ_i = latTelemetry.add("Q (index)");
+    stats.latencyQ   = (pool != NULL)? latTelemetry.add("Q (total)"): NULL;
+    MemoryTelemetry memTelemetry(samplingInterval);
+    PureLITReplay method(lidxR, idxR, horizon);
+    memTelemetry.start();
+    replayStream(fQ, method, pool, settings.numRuns, settings.typeWorkload, stats);
     fQ.close();
+    memTelemetry.stop();
     
     
     // Report
@@ -265,30 +300,62 @@ int main(int argc, char **argv)
     cout << "Buffer info" << endl;
     cout << "Type                               : " << typeBuffer << endl;
     if (maxCapacity != -1)
-        cout << "Buffer capacity                    : " << maxCapacity << endl << endl;
+    {
+        cout << "Buffer capacity                    : " << maxCapacity << endl;
+        if (tuner != NULL)
+            cout << "Buffer capacity (final)            : " << lidxR->getCapacity() << endl;
+        cout << endl;
+    }
     else
         cout << "Buffer duration                    : " << maxDuration << endl << endl;
     cout << "Index info" << endl;
+    if (horizon > 0)
+    {
+        cout << "Retention horizon [secs]           : " << horizon << endl;
+        if (coldDirectory != NULL)
+        {
+            cout << "Cold storage directory             : " << coldDirectory << endl;
+            cout << "In-memory domain start             : " << idxR->hotStart << endl << endl;
+        }
+        else
+            cout << "Retained domain start              : " << idxR->gstart << endl << endl;
+    }
     cout << "Updates report" << endl;
-    cout << "Num of updates                     : " << numUpdates << endl;
-    cout << "Num of buffers  (max)              : " << maxNumBuffers << endl;
-    printf( "Total updating time (buffer) [secs]: %f\n", (totalBufferStartTime+totalBufferEndTime));
-    printf( "Total updating time (index)  [secs]: %f\n\n", totalIndexEndTime);
+    cout << "Num of updates                     : " << stats.numUpdates << endl;
+    cout << "Num of buffers  (max)              : " << stats.maxNumBuffers << endl;
+    printf( "Total updating time (buffer) [secs]: %f\n", stats.totalBufferUpdateTime);
+    printf( "Total updating time (index)  [secs]: %f\n\n", stats.totalIndexUpdateTime);
     cout << "Queries report" << endl;
-    cout << "Num of queries                     : " << numQueries << endl;
+    cout << "Num of queries                     : " << stats.numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [";
-#ifdef WORKLOAD_COUNT
-    cout << "COUNT]               : ";
-#else
-    cout << "XOR]                 : ";
-#endif
-    cout << totalResult << endl;
-    printf( "Total querying time (buffer) [secs]: %f\n", totalQueryTime_b/settings.numRuns);
-    printf( "Total querying time (index)  [secs]: %f\n\n", totalQueryTime_i/settings.numRuns);
+    printf( "%-35s: %zu\n", ("Total result [" + getWorkloadName(settings.typeWorkload) + "]").c_str(), stats.totalResult);
+    printf( "Total querying time (buffer) [secs]: %f\n", stats.totalQueryTime_b/settings.numRuns);
+    printf( "Total querying time (index)  [secs]: %f\n", stats.totalQueryTime_i/settings.numRuns);
+    if (pool != NULL)
+    {
+        cout << "Num of threads per query           : " << numThreads << endl;
+        printf( "Total querying time (total)  [secs]: %f\n", stats.totalQueryTime/settings.numRuns);
+    }
+    cout << endl;
+    if (tuner != NULL)
+    {
+        tuner->print();
+        cout << endl;
+    }
+
 
+    memTelemetry.account("LIVE INDEX", lidxR->getMemoryUsage());
+    memTelemetry.account("HINT", idxR->getMemoryUsage());
+    if (coldDirectory != NULL)
+        memTelemetry.account("HINT (segment files)", idxR->getSegmentSize());
+    latTelemetry.print();
+    if ((latencyFile != NULL) && (!latTelemetry.dump(latencyFile)))
+        cerr << endl << "Error - cannot write latencies to '" << latencyFile << "'" << endl << endl;
+    memTelemetry.print();
 
+    delete pool;
     delete lidxR;
+    delete tuner;
     delete idxR;
     
     
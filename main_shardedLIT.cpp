@@ -0,0 +1,331 @@
+#include "getopt.h"
+#include "def_global.h"
+#include "./containers/relation.h"
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "replay.h"
+#include "replay_methods.h"
+#include "./indices/sharded_lit.h"
+#include "./indices/live_index_concurrent.h"
+
+
+
+// The updates are only issued to the shard queues, timed as buffer updates; queries first let the shards catch up,
+// so that their time does not include pending updates, and the shards answer them as the index alone
+class ShardedLITReplay
+{
+public:
+    ShardedLIT *slit;
+    size_t numBuffers;
+    double totalSyncTime;
+
+    ShardedLITReplay(ShardedLIT *slit)
+    {
+        this->slit = slit;
+        this->numBuffers = 0;
+        this->totalSyncTime = 0;
+    };
+    inline void insertStart(const StreamEntry &e)
+    {
+        this->slit->insert(e.first, e.second);
+    };
+    inline Timestamp removeStart(const StreamEntry &e)
+    {
+        this->slit->remove(e.first, e.second);
+
+        return 0;
+    };
+    inline void insertEnd(const StreamEntry &e, Timestamp start)
+    {
+    };
+    inline void prepareQuery()
+    {
+        Timer tim;
+
+        tim.start();
+        this->slit->sync();
+        this->totalSyncTime += tim.stop();
+        this->numBuffers = this->slit->getNumBuffers();
+    };
+    template <class S> inline void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+    };
+    template <class S> inline void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        this->slit->execute_pureTimeTravel(Q, sink);
+    };
+    // As of the last query; the shards are not read while their writers run
+    inline size_t getNumBuffers()
+    {
+        return this->numBuffers;
+    };
+};
+
+
+LiveIndex* createLiveIndex(const string &typeBuffer, size_t maxCapacity, Timestamp maxDuration)
+{
+    if (maxCapacity != -1)
+    {
+        if (typeBuffer == "MAP")
+            return new LiveIndexCapacityConstraintedMap(maxCapacity);
+        else if (typeBuffer == "VECTOR")
+            return new LiveIndexCapacityConstraintedVector(maxCapacity);
+        else if (typeBuffer == "ENHANCEDHASHMAP")
+            return new LiveIndexCapacityConstraintedICDE16(maxCapacity);
+        else if (typeBuffer == "COLUMNAR")
+            return new LiveIndexCapacityConstraintedColumnar(maxCapacity);
+        else if (typeBuffer == "ORDERED")
+            return new LiveIndexCapacityConstraintedOrdered(maxCapacity);
+        else if (typeBuffer == "CONCURRENT")
+            return new LiveIndexConcurrent(maxCapacity);
+    }
+    else if (maxDuration != -1)
+    {
+        if (typeBuffer == "MAP")
+            return new LiveIndexDurationConstraintedMap(maxDuration);
+        else if (typeBuffer == "VECTOR")
+            return new LiveIndexDurationConstraintedVector(maxDuration);
+        else if (typeBuffer == "ENHANCEDHASHMAP")
+            return new LiveIndexDurationConstraintedICDE16(maxDuration);
+        else if (typeBuffer == "COLUMNAR")
+            return new LiveIndexDurationConstraintedColumnar(maxDuration);
+        else if (typeBuffer == "ORDERED")
+            return new LiveIndexDurationConstraintedOrdered(maxDuration);
+    }
+
+    return NULL;
+}
+
+
+void usage()
+{
+    cerr << endl;
+    cerr << "PROJECT" << endl;
+    cerr << "       LIT: Lightning-fast In-memory Temporal Indexing" << endl << endl;
+    cerr << "USAGE" << endl;
+    cerr << "       ./query_shardedLIT.exec [OPTIONS] [STREAMFILE]" << endl << endl;
+    cerr << "DESCRIPTION" << endl;
+    cerr << "       -? or -h" << endl;
+    cerr << "              display this help message and exit" << endl;
+    cerr << "       -e" << endl;
+    cerr << "              set the leaf partition extent; it is set in seconds" << endl;
+    cerr << "       -b" << endl;
+    cerr << "              set the type of data structure for the LIVE INDEX: MAP, ENHANCEDHASHMAP, COLUMNAR, ORDERED or CONCURRENT (capacity constraint only)" << endl;
+    cerr << "       -c" << endl;
+    cerr << "              set the capacity constraint number for the LIVE INDEX" << endl;
+    cerr << "       -d" << endl;
+    cerr << "              set the duration constraint number for the LIVE INDEX" << endl;
+    cerr << "       -n shards" << endl;
+    cerr << "              set the number of shards, each with its own LIVE INDEX, HINT and writer thread; by default 2" << endl;
+    cerr << "       -q capacity" << endl;
+    cerr << "              set the capacity of the update queue per shard; by default " << SHARD_QUEUE_CAPACITY << endl;
+    cerr << "       -t threads" << endl;
+    cerr << "              set the number of threads per query; with more than 1, the shards are probed concurrently; by default 1" << endl;
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              dump the latency percentiles per operation to file; JSON if it ends with .json, CSV otherwise" << endl;
+    cerr << "       -s interval" << endl;
+    cerr << "              set the memory sampling interval in milliseconds; by default " << MEMORY_SAMPLING_INTERVAL << endl;
+    cerr << "       -r runs" << endl;
+    cerr << "              set the number of runs per query; by default 1" << endl << endl;
+    cerr << "EXAMPLE" << endl;
+    cerr << "       ./query_shardedLIT.exec -e 86400 -b ENHANCEDHASHMAP -c 10000 -n 4 streams/BOOKS.mix" << endl << endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    Timer tim, timTotal;
+    ShardedLIT *slit;
+    vector<LiveIndex*> lidxs;
+    vector<HINT_M_Dynamic*> idxs;
+    ThreadPool *pool = NULL;
+    double totalTime = 0;
+    RunSettings settings;
+    char c;
+    unsigned int samplingInterval = MEMORY_SAMPLING_INTERVAL;
+    const char *latencyFile = NULL;
+    string strWorkload = "";
+    Timestamp leafPartitionExtent = 0;
+    string typeBuffer;
+    size_t maxCapacity = -1;
+    Timestamp maxDuration = -1;
+    int numShards = 2, numThreads = 1;
+    long queueCapacity = SHARD_QUEUE_CAPACITY;
+
+
+    settings.init();
+    settings.method = "shardedLIT";
+    while ((c = getopt(argc, argv, "?he:c:d:b:n:q:t:w:o:s:r:")) != -1)
+    {
+        switch (c)
+        {
+            case '?':
+            case 'h':
+                usage();
+                return 0;
+
+            case 'e':
+                leafPartitionExtent = atoi(optarg);
+                break;
+
+            case 'b':
+                typeBuffer = toUpperCase((char*)optarg);
+                break;
+
+            case 'c':
+                maxCapacity = atoi(optarg);
+                break;
+
+            case 'd':
+                maxDuration = atoi(optarg);
+                break;
+
+            case 'n':
+                numShards = atoi(optarg);
+                break;
+
+            case 'q':
+                queueCapacity = atol(optarg);
+                break;
+
+            case 't':
+                numThreads = atoi(optarg);
+                break;
+
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+
+            case 'o':
+                latencyFile = optarg;
+                break;
+
+            case 's':
+                samplingInterval = atoi(optarg);
+                break;
+
+            case 'r':
+                settings.numRuns = atoi(optarg);
+                break;
+
+            default:
+                cerr << endl << "Error - unknown option '" << c << "'" << endl << endl;
+                usage();
+                return 1;
+        }
+    }
+
+
+    if (argc-optind != 1)
+    {
+        usage();
+        return 1;
+    }
+
+    if ((leafPartitionExtent <= 0) || (numShards <= 0) || (numThreads <= 0) || (queueCapacity <= 0))
+    {
+        usage();
+        return 1;
+    }
+
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
+
+
+    // VECTOR buffers address their slots by id, i.e., they need the dense ids that hash sharding breaks
+    if (typeBuffer == "VECTOR")
+    {
+        cerr << endl << "Error - VECTOR buffers are not supported with sharding; use MAP, ENHANCEDHASHMAP, COLUMNAR, ORDERED or CONCURRENT" << endl << endl;
+        return 1;
+    }
+
+    for (auto i = 0; i < numShards; i++)
+    {
+        LiveIndex *lidx = createLiveIndex(typeBuffer, maxCapacity, maxDuration);
+
+        if (lidx == NULL)
+        {
+            usage();
+            return 1;
+        }
+        lidxs.push_back(lidx);
+        idxs.push_back(new HINT_M_Dynamic(leafPartitionExtent));
+    }
+    if (numThreads > 1)
+        pool = new ThreadPool(numThreads-1);
+
+
+    // Load stream
+    settings.queryFile = argv[optind];
+    Stream fQ(settings.queryFile);
+    if (!fQ.isOpen())
+    {
+        usage();
+        return 1;
+    }
+
+
+    LatencyTelemetry latTelemetry;
+    ReplayStats stats;
+    stats.latencyS   = latTelemetry.add("S (issue)");
+    stats.latencyE_b = latTelemetry.add("E (issue)");
+    stats.latencyQ_i = latTelemetry.add("Q");
+    MemoryTelemetry memTelemetry(samplingInterval);
+    memTelemetry.start();
+    slit = new ShardedLIT(lidxs, idxs, queueCapacity, pool);
+    ShardedLITReplay method(slit);
+    timTotal.start();
+    replayStream(fQ, method, NULL, settings.numRuns, settings.typeWorkload, stats);
+    method.prepareQuery();
+    totalTime = timTotal.stop();
+    fQ.close();
+    memTelemetry.stop();
+    stats.maxNumBuffers = max(stats.maxNumBuffers, method.getNumBuffers());
+
+
+    // Report
+    cout << endl;
+    cout << "shardedLIT" << endl;
+    cout << "====================" << endl;
+    cout << endl;
+    cout << "Buffer info" << endl;
+    cout << "Type                               : " << typeBuffer << endl;
+    if (maxCapacity != -1)
+        cout << "Buffer capacity                    : " << maxCapacity << endl << endl;
+    else
+        cout << "Buffer duration                    : " << maxDuration << endl << endl;
+    cout << "Sharding info" << endl;
+    cout << "Num of shards                      : " << numShards << endl;
+    cout << "Queue capacity per shard           : " << queueCapacity << endl;
+    cout << "Num of threads per query           : " << numThreads << endl << endl;
+    cout << "Updates report" << endl;
+    cout << "Num of updates                     : " << stats.numUpdates << endl;
+    cout << "Num of buffers  (max)              : " << stats.maxNumBuffers << endl;
+    printf( "Total issuing time           [secs]: %f\n", stats.totalBufferUpdateTime);
+    printf( "Total waiting time (shards)  [secs]: %f\n\n", method.totalSyncTime);
+    cout << "Queries report" << endl;
+    cout << "Num of queries                     : " << stats.numQueries << endl;
+    cout << "Num of runs per query              : " << settings.numRuns << endl;
+    printf( "%-35s: %zu\n", ("Total result [" + getWorkloadName(settings.typeWorkload) + "]").c_str(), stats.totalResult);
+    printf( "Total querying time          [secs]: %f\n", stats.totalQueryTime_i/settings.numRuns);
+    printf( "Total time (stream)          [secs]: %f\n\n", totalTime);
+
+
+    memTelemetry.account("LIVE INDEX", slit->getLiveIndexMemoryUsage());
+    memTelemetry.account("HINT", slit->getHINTMemoryUsage());
+    latTelemetry.print();
+    if ((latencyFile != NULL) && (!latTelemetry.dump(latencyFile)))
+        cerr << endl << "Error - cannot write latencies to '" << latencyFile << "'" << endl << endl;
+    memTelemetry.print();
+
+    delete slit;
+    delete pool;
+
+
+    return 0;
+}
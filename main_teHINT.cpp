@@ -1,7 +1,10 @@
 #include "getopt.h"
 #include "def_global.h"
 #include "./containers/relation.h"
-#include "./indices/hint_m.h"
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "replay.h"
+#include "replay_methods.h"
 
 void usage()
 {
@@ -15,6 +18,12 @@ void usage()
     cerr << "              display this help message and exit" << endl;
     cerr << "       -e" << endl;
     cerr << "              set the leaf partition extent; it is set in seconds" << endl;     
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              dump the latency percentiles per operation to file; JSON if it ends with .json, CSV otherwise" << endl;
+    cerr << "       -s interval" << endl;
+    cerr << "              set the memory sampling interval in milliseconds; by default " << MEMORY_SAMPLING_INTERVAL << endl;
     cerr << "       -r runs" << endl;
     cerr << "              set the number of runs per query; by default 1" << endl << endl;
     cerr << "EXAMPLE" << endl;
@@ -25,29 +34,20 @@ void usage()
 int main(int argc, char **argv)
 {
     Timer tim;
-    Record r;
     HINT_M_Dynamic_Naive *idxR;
-    size_t totalResult = 0, queryresult = 0, numQueries = 0, numUpdates = 0, numExpansions = 0;
-    double b_starttime = 0, b_endtime = 0, i_endtime = 0, b_querytime = 0, i_querytime = 0, avgQueryTime = 0, expand_time = 0;
-    double totalIndexTime = 0, totalInsertTmpTime = 0, totalRemoveTmpTime = 0, totalIndexEndTime = 0, totalQueryTime_b = 0, totalQueryTime_i = 0, totalBufferMergingTime = 0, totalExpandTime = 0;
-    Timestamp first, second, startEndpoint;
+    double totalIndexTime = 0;
     RunSettings settings;
-    char c, operation;
-    double third, fourth;
-    double vm = 0, rss = 0, vmMax = 0, rssMax = 0;
-    string strQuery = "", strPredicate = "", strOptimizations = "";
+    char c;
+    unsigned int samplingInterval = MEMORY_SAMPLING_INTERVAL;
+    const char *latencyFile = NULL;
+    string strWorkload = "";
     Timestamp leafPartitionExtent = 0;
-    string typeBuffer;
-    size_t maxCapacity = -1;
-    Timestamp maxDuration = -1;
-    unsigned int mergeParameter = 0;
-    size_t maxNumBuffers = 0;
 
     
     // Parse command line input
     settings.init();
     settings.method = "teHINT";
-    while ((c = getopt(argc, argv, "?hq:e:c:d:b:m:r:")) != -1)
+    while ((c = getopt(argc, argv, "?hq:e:c:d:b:m:w:o:s:r:")) != -1)
     {
         switch (c)
         {
@@ -59,6 +59,19 @@ int main(int argc, char **argv)
             case 'e':
                 leafPartitionExtent = atoi(optarg);
                 break;                
+
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+
+            case 'o':
+                latencyFile = optarg;
+                break;
+
+            case 's':
+                samplingInterval = atoi(optarg);
+                break;
+
             case 'r':
                 settings.numRuns = atoi(optarg);
                 break;
@@ -84,6 +97,12 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
+
 
     
     
@@ -94,97 +113,25 @@ int main(int argc, char **argv)
     
 
     settings.queryFile = argv[optind];
-    ifstream fQ(settings.queryFile);
-    if (!fQ)
+    Stream fQ(settings.queryFile);
+    if (!fQ.isOpen())
     {
         usage();
         return 1;
     }
 
-    size_t sumQ = 0;
-    size_t count = 0;
-    if (settings.verbose)
-        cout << "Operation\tInput1\tInput2\tBuffer_time\tIndex_time\tPredicate\tResult" << endl;
-
-    while (fQ >> operation >> first >> second >> third >> fourth)
-    {
-        switch (operation)
-        {
-
-            case 'S':
-                tim.start();
-                idxR->insertTmp(first, second);
-                b_starttime = tim.stop();
-                totalInsertTmpTime += b_starttime;
-                
-                numUpdates++;
-                if (settings.verbose)
-                {
-                    cout << "S\t" << first << "\t" << second;
-                    printf("\t%f\t0", b_starttime);
-                    cout << "\t-\t-" << endl;
-                }
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'E':
-                tim.start();
-                startEndpoint = idxR->removeTmp(first);
-                b_endtime = tim.stop();
-                totalRemoveTmpTime += b_endtime;
-                tim.start();
-                idxR->insert(Record(first, startEndpoint, second));
-                i_endtime = tim.stop();
-                totalIndexEndTime += i_endtime;
-
-                numUpdates++;
-                if (settings.verbose)
-                {
-                    cout << "E\t" << first << "\t" << second;
-                    printf("\t%f\t%f", b_endtime, i_endtime);
-                    cout << "\t-\t-" << endl;
-                }
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-
-            case 'Q':
-                numQueries++;
-                sumQ += second-first;
-
-                double sumT = 0;
-                for (auto r = 0; r < settings.numRuns; r++)
-                {
-
-                    tim.start();
-                    queryresult = idxR->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-                    i_querytime = tim.stop();
-
-                    totalQueryTime_b += b_querytime;
-                    totalQueryTime_i += i_querytime;
-
-                    if (settings.verbose)
-                    {
-                        cout << "Q\t" << first << "\t" << second;
-                        printf("\t%f\t%f", b_querytime, i_querytime);
-                        cout << "\t" << strPredicate << "\t" << queryresult << endl;
-                    }
-                }
-                totalResult += queryresult;
-                avgQueryTime += sumT/settings.numRuns;
-                
-                process_mem_usage(vm, rss);
-                vmMax = max(vm, vmMax);
-                rssMax = max(rss, rssMax);
-                break;
-        }
-    }
+    LatencyTelemetry latTelemetry;
+    ReplayStats stats;
+    stats.latencyS   = latTelemetry.add("S (tmp)");
+    stats.latencyE_b = latTelemetry.add("E (tmp)");
+    stats.latencyE_i = latTelemetry.add("E (index)");
+    stats.latencyQ_i = latTelemetry.add("Q (index)");
+    MemoryTelemetry memTelemetry(samplingInterval);
+    TeHINTReplay method(idxR);
+    memTelemetry.start();
+    replayStream(fQ, method, NULL, settings.numRuns, settings.typeWorkload, stats);
     fQ.close();
+    memTelemetry.stop();
     
 
     
@@ -195,21 +142,21 @@ int main(int argc, char **argv)
     cout << endl;
     cout << "Index info" << endl;
     cout << "Updates report" << endl;
-    cout << "Num of updates                     : " << numUpdates << endl;
-    printf( "Total updating time          [secs]: %f\n", (totalInsertTmpTime+totalRemoveTmpTime));
+    cout << "Num of updates                     : " << stats.numUpdates << endl;
+    printf( "Total updating time          [secs]: %f\n", stats.totalBufferUpdateTime);
     cout << "Queries report" << endl;
-    cout << "Num of queries                     : " << numQueries << endl;
+    cout << "Num of queries                     : " << stats.numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [";
-#ifdef WORKLOAD_COUNT
-    cout << "COUNT]               : ";
-#else
-    cout << "XOR]                 : ";
-#endif
-    cout << totalResult << endl;
-    printf( "Total querying time (index)  [secs]: %f\n\n", totalQueryTime_i/settings.numRuns);
+    printf( "%-35s: %zu\n", ("Total result [" + getWorkloadName(settings.typeWorkload) + "]").c_str(), stats.totalResult);
+    printf( "Total querying time (index)  [secs]: %f\n\n", stats.totalQueryTime_i/settings.numRuns);
+
 
 
+    memTelemetry.account("teHINT", idxR->getMemoryUsage());
+    latTelemetry.print();
+    if ((latencyFile != NULL) && (!latTelemetry.dump(latencyFile)))
+        cerr << endl << "Error - cannot write latencies to '" << latencyFile << "'" << endl << endl;
+    memTelemetry.print();
 
     // delete lidxR;
     delete idxR;
@@ -1,7 +1,10 @@
 #include "getopt.h"
 #include "def_global.h"
 #include "./containers/relation.h"
-#include "./indices/timelineindex.h"
+#include "./containers/stream.h"
+#include "telemetry.h"
+#include "replay.h"
+#include "replay_methods.h"
 
 
 void usage()
@@ -16,6 +19,12 @@ void usage()
     cerr << "              display this help message and exit" << endl;
     cerr << "       -c" << endl;
     cerr << "              set the checkpoint frequency" << endl;      
+    cerr << "       -w workload" << endl;
+    cerr << "              set what queries report: COUNT, XOR or IDS (the number of ids); by default set by WORKLOAD_COUNT" << endl;
+    cerr << "       -o file" << endl;
+    cerr << "              dump the latency percentiles per operation to file; JSON if it ends with .json, CSV otherwise" << endl;
+    cerr << "       -s interval" << endl;
+    cerr << "              set the memory sampling interval in milliseconds; by default " << MEMORY_SAMPLING_INTERVAL << endl;
     cerr << "       -r runs" << endl;
     cerr << "              set the number of runs per query; by default 1" << endl << endl;
     cerr << "EXAMPLE" << endl;
@@ -26,25 +35,19 @@ void usage()
 int main(int argc, char **argv)
 {
     Timer tim;
-    Record r;
-    TimelineIndex *idxR;;
-
-    size_t totalResult = 0, queryresult = 0, numQueries = 0, numUpdates = 0, numInserts = 0;
-    double starttime = 0, endtime = 0, querytime = 0, avgQueryTime = 0;
-    double totalIndexTime = 0, totalIndexEndTime = 0, totalQueryTime = 0, totalUpdateTime = 0;
-    Timestamp first, second, startEndpoint;
-    double third, fourth;
+    TimelineIndex *idxR;
+    double totalIndexTime = 0;
     unsigned int checkpointFrequency = 0;
     RunSettings settings;
-    char c, operation;
-    double vm = 0, rss = 0, vmMax = 0, rssMax = 0;
-    string strQuery = "", strPredicate = "", strOptimizations = "";
-    Timestamp leafPartitionExtent = 0;
+    char c;
+    unsigned int samplingInterval = MEMORY_SAMPLING_INTERVAL;
+    const char *latencyFile = NULL;
+    string strQuery = "", strWorkload = "";
 
     
     settings.init();
     settings.method = "timeline-index";
-    while ((c = getopt(argc, argv, "?hq:c:r:")) != -1)
+    while ((c = getopt(argc, argv, "?hq:c:w:o:s:r:")) != -1)
     {
         switch (c)
         {
@@ -56,6 +59,19 @@ int main(int argc, char **argv)
            case 'c':
                checkpointFrequency = atoi(optarg);
                break;
+
+            case 'w':
+                strWorkload = toUpperCase((char*)optarg);
+                break;
+                
+            case 'o':
+                latencyFile = optarg;
+                break;
+
+            case 's':
+                samplingInterval = atoi(optarg);
+                break;
+
                 
             case 'r':
                 settings.numRuns = atoi(optarg);
@@ -75,6 +91,12 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    if ((strWorkload != "") && (!checkWorkload(strWorkload, settings)))
+    {
+        usage();
+        return 1;
+    }
+
 
     
     
@@ -84,67 +106,42 @@ int main(int argc, char **argv)
     
 
     settings.queryFile = argv[optind];
-    ifstream fQ(settings.queryFile);
-    if (!fQ)
+    Stream fQ(settings.queryFile);
+    if (!fQ.isOpen())
     {
         usage();
         return 1;
     }
 
-    size_t sumQ = 0;
-    size_t count = 0;
-
-    while (fQ >> operation >> first >> second >> third >> fourth)
-    {
-        switch (operation)
-        {
-            case 'S':
-                numInserts++;
-                tim.start();
-                idxR->insert(first, second, 1);
-                starttime = tim.stop();
-                totalUpdateTime+=starttime;
-                break;
-
-            case 'E':
-                numUpdates++;
-
-                tim.start();
-                idxR->insert(first, second, 0);
-                endtime = tim.stop();
-                totalUpdateTime+=endtime;
-                break;
-
-            case 'Q':
-                numQueries++;
-                sumQ += second-first;
-
-                double sumT = 0;
-                for (auto r = 0; r < settings.numRuns; r++)
-                {
-                    tim.start();
-                    queryresult = idxR->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-                    querytime = tim.stop();
-                    totalQueryTime += querytime;
-                }
-                totalResult += queryresult;
-                avgQueryTime += sumT/settings.numRuns;
-                break;
-        }
-    }
+    LatencyTelemetry latTelemetry;
+    ReplayStats stats;
+    stats.latencyS   = latTelemetry.add("S");
+    stats.latencyE_b = latTelemetry.add("E");
+    stats.latencyQ_i = latTelemetry.add("Q");
+    MemoryTelemetry memTelemetry(samplingInterval);
+    TimelineIndexReplay method(idxR);
+    memTelemetry.start();
+    replayStream(fQ, method, NULL, settings.numRuns, settings.typeWorkload, stats);
     fQ.close();
+    memTelemetry.stop();
     cout << endl;
     cout << "Timeline index" << endl;
     cout << "==============" << endl;
-    cout << "Num of intervals          : " << numUpdates << endl;
+    cout << "Num of intervals          : " << stats.numUpdates-stats.numInserts << endl;
     cout << "Num of checkpoints        : " << idxR->VersionMap.size() << endl;
     cout << endl;
-    printf("Updating time             : %f secs\n", totalUpdateTime);
+    printf("Updating time             : %f secs\n", stats.totalBufferUpdateTime);
     cout << "Query type                : " << strQuery << endl;
     cout << "Num of runs per query     : " << settings.numRuns << endl;
-    cout << "Num of queries            : " << numQueries << endl;
-    cout << "Total result [XOR]        : " << totalResult << endl;
-    printf( "Total querying time [secs]: %f\n", totalQueryTime/settings.numRuns);
+    cout << "Num of queries            : " << stats.numQueries << endl;
+    printf( "%-26s: %zu\n", ("Total result [" + getWorkloadName(settings.typeWorkload) + "]").c_str(), stats.totalResult);
+    printf( "Total querying time [secs]: %f\n", stats.totalQueryTime_i/settings.numRuns);
+
+    memTelemetry.account("Timeline index", idxR->getMemoryUsage());
+    latTelemetry.print();
+    if ((latencyFile != NULL) && (!latTelemetry.dump(latencyFile)))
+        cerr << endl << "Error - cannot write latencies to '" << latencyFile << "'" << endl << endl;
+    memTelemetry.print();
 
     delete idxR;
     
@@ -0,0 +1,213 @@
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include "def_global.h"
+#include "./containers/stream.h"
+#include "./containers/thread_pool.h"
+#include "telemetry.h"
+
+
+
+// Totals of a replay; the histograms are owned by the caller and may be NULL, e.g., for an operation a method does not split
+struct ReplayStats
+{
+    size_t numUpdates, numInserts, numQueries, totalResult, maxNumBuffers;     // Updates are both S and E, inserts only S
+    double totalBufferUpdateTime, totalIndexUpdateTime, totalQueryTime_b, totalQueryTime_i, totalQueryTime;
+    LatencyHistogram *latencyS, *latencyE_b, *latencyE_i, *latencyQ_b, *latencyQ_i, *latencyQ;
+
+    ReplayStats()
+    {
+        this->numUpdates = this->numInserts = this->numQueries = this->totalResult = this->maxNumBuffers = 0;
+        this->totalBufferUpdateTime = this->totalIndexUpdateTime = this->totalQueryTime_b = this->totalQueryTime_i = this->totalQueryTime = 0;
+        this->latencyS = this->latencyE_b = this->latencyE_i = this->latencyQ_b = this->latencyQ_i = this->latencyQ = NULL;
+    };
+};
+
+
+// Operations loaded in memory by Stream::load(), replayed like a Stream, e.g., once per configuration
+class LoadedStream
+{
+private:
+    const vector<StreamEntry> &entries;
+    size_t pos;
+
+public:
+    LoadedStream(const vector<StreamEntry> &entries) : entries(entries)
+    {
+        this->pos = 0;
+    };
+    inline bool next(char &operation, Timestamp &first, Timestamp &second, double &third, double &fourth)
+    {
+        if (this->pos == this->entries.size())
+            return false;
+
+        const StreamEntry &e = this->entries[this->pos++];
+
+        operation = e.operation;
+        first     = e.first;
+        second    = e.second;
+        third     = e.third;
+        fourth    = e.fourth;
+
+        return true;
+    };
+    inline void rewind()
+    {
+        this->pos = 0;
+    };
+};
+
+
+inline void recordLatency(LatencyHistogram *latency, double secs)
+{
+    if (latency != NULL)
+        latency->record(secs);
+}
+
+
+// Runs Q on the buffer and on the index of the method, collecting the results of both in the same sink. With a pool,
+// the index is probed on a worker into sinkIdx while the calling thread probes the buffer; sinkIdx is then merged.
+template <class M, class S>
+void replayQuery(M &method, ThreadPool *pool, RangeQuery Q, const StreamEntry &e, S &sink, S &sinkIdx, double &b_querytime, double &i_querytime)
+{
+    Timer tim;
+
+
+    if (pool == NULL)
+    {
+        tim.start();
+        method.queryBuffer(Q, e, sink);
+        b_querytime = tim.stop();
+
+        tim.start();
+        method.queryIndex(Q, e, sink);
+        i_querytime = tim.stop();
+
+        return;
+    }
+
+    future<void> done = pool->submit([&method, Q, &e, &sinkIdx, &i_querytime]
+    {
+        Timer timIdx;
+
+        timIdx.start();
+        method.queryIndex(Q, e, sinkIdx);
+        i_querytime = timIdx.stop();
+    });
+
+    tim.start();
+    method.queryBuffer(Q, e, sink);
+    b_querytime = tim.stop();
+
+    done.wait();
+    sink.merge(sinkIdx);
+}
+
+
+// Replays the stream F, i.e., a Stream or a LoadedStream, on a method M, which splits the records between a buffer (the live ones) and an index (the dead ones):
+//   void      insertStart(const StreamEntry &e)                    S on the buffer
+//   Timestamp removeStart(const StreamEntry &e)                    E on the buffer; returns the start of the record
+//   void      insertEnd(const StreamEntry &e, Timestamp start)     E on the index
+//   void      prepareQuery()                                       before every query, not timed
+//   template <class S> void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+//   template <class S> void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+//   size_t    getNumBuffers()
+// Every run of a query clears the sinks first; the result of the last run is added to the total.
+template <class F, class M, class S>
+void replayStream(F &fQ, M &method, ThreadPool *pool, unsigned int numRuns, S &sink, S &sinkIdx, ReplayStats &stats)
+{
+    Timer tim, timQ;
+    StreamEntry e;
+    Timestamp startEndpoint;
+    double b_time, i_time, querytime;
+
+
+    while (fQ.next(e.operation, e.first, e.second, e.third, e.fourth))
+    {
+        switch (e.operation)
+        {
+            case 'S':
+                tim.start();
+                method.insertStart(e);
+                b_time = tim.stop();
+                recordLatency(stats.latencyS, b_time);
+                stats.totalBufferUpdateTime += b_time;
+
+                stats.numUpdates++;
+                stats.numInserts++;
+                break;
+
+            case 'E':
+                tim.start();
+                startEndpoint = method.removeStart(e);
+                b_time = tim.stop();
+                recordLatency(stats.latencyE_b, b_time);
+                stats.totalBufferUpdateTime += b_time;
+
+                tim.start();
+                method.insertEnd(e, startEndpoint);
+                i_time = tim.stop();
+                recordLatency(stats.latencyE_i, i_time);
+                stats.totalIndexUpdateTime += i_time;
+
+                stats.numUpdates++;
+                break;
+
+            case 'Q':
+                stats.numQueries++;
+                method.prepareQuery();
+
+                for (auto r = 0; r < numRuns; r++)
+                {
+                    sink.clear();
+                    sinkIdx.clear();
+
+                    timQ.start();
+                    replayQuery(method, pool, RangeQuery(stats.numQueries, e.first, e.second), e, sink, sinkIdx, b_time, i_time);
+                    querytime = timQ.stop();
+                    recordLatency(stats.latencyQ_b, b_time);
+                    recordLatency(stats.latencyQ_i, i_time);
+                    recordLatency(stats.latencyQ, querytime);
+
+                    stats.totalQueryTime_b += b_time;
+                    stats.totalQueryTime_i += i_time;
+                    stats.totalQueryTime += querytime;
+                }
+                stats.totalResult += sink.getResult();
+                break;
+        }
+        stats.maxNumBuffers = max(stats.maxNumBuffers, method.getNumBuffers());
+    }
+}
+
+
+// Same, with the sinks of the workload chosen at runtime (WORKLOAD_MODE_COUNT, WORKLOAD_MODE_XOR or WORKLOAD_MODE_IDS)
+template <class F, class M>
+void replayStream(F &fQ, M &method, ThreadPool *pool, unsigned int numRuns, unsigned int typeWorkload, ReplayStats &stats)
+{
+    vector<RecordId> ids, idsIdx;   // Output of the IDS workload; reused across queries
+
+
+    switch (typeWorkload)
+    {
+        case WORKLOAD_MODE_COUNT:
+        {
+            CountSink sink, sinkIdx;
+            replayStream(fQ, method, pool, numRuns, sink, sinkIdx, stats);
+            break;
+        }
+        case WORKLOAD_MODE_XOR:
+        {
+            XorSink sink, sinkIdx;
+            replayStream(fQ, method, pool, numRuns, sink, sinkIdx, stats);
+            break;
+        }
+        case WORKLOAD_MODE_IDS:
+        {
+            IdSink sink(ids), sinkIdx(idsIdx);
+            replayStream(fQ, method, pool, numRuns, sink, sinkIdx, stats);
+            break;
+        }
+    }
+}
+#endif // _REPLAY_H_
@@ -0,0 +1,328 @@
+#ifndef _REPLAY_METHODS_H_
+#define _REPLAY_METHODS_H_
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/geometries.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+#include "def_global.h"
+#include "./containers/relation.h"
+#include "./containers/stream.h"
+#include "./indices/hint_m.h"
+#include "./indices/timelineindex.h"
+#include "./indices/live_index.cpp"
+
+#define RTREE_PAGESIZE  16
+#define RTREE_ATYPE     float
+
+
+
+// The methods replayed by replayStream(), see replay.h; they do not own the structures they are given.
+
+// LIT: the LIVE INDEX holds the live records, HINT the dead ones
+class PureLITReplay
+{
+public:
+    LiveIndex *lidx;
+    HINT_M_Dynamic *idx;
+    Timestamp horizon;      // Retained by HINT, see HINT_M_Dynamic::expire(); 0 to retain all
+
+    PureLITReplay(LiveIndex *lidx, HINT_M_Dynamic *idx, Timestamp horizon)
+    {
+        this->lidx = lidx;
+        this->idx = idx;
+        this->horizon = horizon;
+    };
+    inline void insertStart(const StreamEntry &e)
+    {
+        this->lidx->insert(e.first, e.second);
+    };
+    inline Timestamp removeStart(const StreamEntry &e)
+    {
+        return this->lidx->remove(e.first);
+    };
+    inline void insertEnd(const StreamEntry &e, Timestamp start)
+    {
+        this->idx->insert(Record(e.first, start, e.second));
+        if (this->horizon > 0)
+            this->idx->expire(e.second-this->horizon);
+    };
+    inline void prepareQuery()
+    {
+    };
+    template <class S> inline void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        this->lidx->execute_pureTimeTravel(Q, sink);
+    };
+    template <class S> inline void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        if (Q.start <= this->idx->gend)
+            this->idx->execute_pureTimeTravel(Q, sink);
+    };
+    inline size_t getNumBuffers()
+    {
+        return this->lidx->getNumBuffers();
+    };
+};
+
+
+// LIT per segment of the secondary attribute; a query [third, fourth] on the attribute probes the segments it spans:
+// the first and the last check the attribute bound, the ones in between are covered fully.
+class ALITReplay
+{
+public:
+    vector<LiveIndex*> &lidxs;
+    vector<HINT_M_Dynamic_Second_Attr*> &idxs;
+    size_t segment;
+
+    ALITReplay(vector<LiveIndex*> &lidxs, vector<HINT_M_Dynamic_Second_Attr*> &idxs) : lidxs(lidxs), idxs(idxs)
+    {
+        this->segment = (MAX_ATTRIBUTE_VALUE+lidxs.size())/lidxs.size();
+    };
+    inline void insertStart(const StreamEntry &e)
+    {
+        this->lidxs[e.third/this->segment]->insert_secAttr(e.first, e.second, e.third);
+    };
+    inline Timestamp removeStart(const StreamEntry &e)
+    {
+        return this->lidxs[e.third/this->segment]->remove_secAttr(e.first);
+    };
+    inline void insertEnd(const StreamEntry &e, Timestamp start)
+    {
+        this->idxs[e.third/this->segment]->insert(Record(e.first, start, e.second, e.third));
+    };
+    inline void prepareQuery()
+    {
+    };
+    template <class S> inline void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        int indexStart = e.third/this->segment, indexEnd = e.fourth/this->segment;
+
+        if (indexStart == indexEnd)
+        {
+            this->lidxs[indexStart]->execute_rangeTimeTravel(Q, e.third, e.fourth, sink);
+            return;
+        }
+
+        this->lidxs[indexStart]->executeTimeTravel_greaterthan(Q, e.third, sink);
+        for (int i = indexStart+1; i < indexEnd; i++)
+            this->lidxs[i]->execute_pureTimeTravel(Q, sink);
+        this->lidxs[indexEnd]->executeTimeTravel_lowerthan(Q, e.fourth, sink);
+    };
+    // Same for HINT, skipping the segments that hold no interval ending after Q.start
+    template <class S> inline void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        int indexStart = e.third/this->segment, indexEnd = e.fourth/this->segment;
+
+        if (indexStart == indexEnd)
+        {
+            if (Q.start <= this->idxs[indexStart]->gend)
+                this->idxs[indexStart]->execute_rangeTimeTravel(Q, e.third, e.fourth, sink);
+            return;
+        }
+
+        if (Q.start <= this->idxs[indexStart]->gend)
+            this->idxs[indexStart]->executeTimeTravel_greaterthan(Q, e.third, sink);
+        for (int i = indexStart+1; i < indexEnd; i++)
+        {
+            if (Q.start <= this->idxs[i]->gend)
+                this->idxs[i]->execute_pureTimeTravel(Q, sink);
+        }
+        if (Q.start <= this->idxs[indexEnd]->gend)
+            this->idxs[indexEnd]->executeTimeTravel_lowerthan(Q, e.fourth, sink);
+    };
+    inline size_t getNumBuffers()
+    {
+        return this->lidxs[0]->getNumBuffers();
+    };
+};
+
+
+// teHINT: the live records are kept in temporary HINT partitions, so the index answers the queries alone
+class TeHINTReplay
+{
+public:
+    HINT_M_Dynamic_Naive *idx;
+
+    TeHINTReplay(HINT_M_Dynamic_Naive *idx)
+    {
+        this->idx = idx;
+    };
+    inline void insertStart(const StreamEntry &e)
+    {
+        this->idx->insertTmp(e.first, e.second);
+    };
+    inline Timestamp removeStart(const StreamEntry &e)
+    {
+        return this->idx->removeTmp(e.first);
+    };
+    inline void insertEnd(const StreamEntry &e, Timestamp start)
+    {
+        this->idx->insert(Record(e.first, start, e.second));
+    };
+    inline void prepareQuery()
+    {
+    };
+    template <class S> inline void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+    };
+    template <class S> inline void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        this->idx->execute_pureTimeTravel(Q, sink);
+    };
+    inline size_t getNumBuffers()
+    {
+        return 0;
+    };
+};
+
+
+// Timeline index: both endpoints are events of the index; there is no buffer
+class TimelineIndexReplay
+{
+public:
+    TimelineIndex *idx;
+
+    TimelineIndexReplay(TimelineIndex *idx)
+    {
+        this->idx = idx;
+    };
+    inline void insertStart(const StreamEntry &e)
+    {
+        this->idx->insert(e.first, e.second, 1);
+    };
+    inline Timestamp removeStart(const StreamEntry &e)
+    {
+        this->idx->insert(e.first, e.second, 0);
+
+        return 0;
+    };
+    inline void insertEnd(const StreamEntry &e, Timestamp start)
+    {
+    };
+    inline void prepareQuery()
+    {
+    };
+    template <class S> inline void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+    };
+    template <class S> inline void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        this->idx->execute_pureTimeTravel(Q, sink);
+    };
+    inline size_t getNumBuffers()
+    {
+        return 0;
+    };
+};
+
+
+// LIT with an R-tree instead of HINT: a dead record is the point (start, end), and a query the window
+// [gstart, Q.start] x [Q.end, gend] over the domain indexed so far
+class RTree2DReplay
+{
+public:
+    typedef bg::model::point<Timestamp, 2, bg::cs::cartesian> Point;
+
+    LiveIndex *lidx;
+    bgi::rtree<pair<Point, RecordId>, bgi::linear<RTREE_PAGESIZE> > rtree;
+    Timestamp rgstart, rgend;
+
+    RTree2DReplay(LiveIndex *lidx)
+    {
+        this->lidx = lidx;
+        this->rgstart = numeric_limits<Timestamp>::max();
+        this->rgend   = numeric_limits<Timestamp>::min();
+    };
+    inline void insertStart(const StreamEntry &e)
+    {
+        this->lidx->insert(e.first, e.second);
+    };
+    inline Timestamp removeStart(const StreamEntry &e)
+    {
+        return this->lidx->remove(e.first);
+    };
+    inline void insertEnd(const StreamEntry &e, Timestamp start)
+    {
+        this->rtree.insert(make_pair(Point(start, e.second), e.first));
+        this->rgstart = min(this->rgstart, start);
+        this->rgend   = max(this->rgend, e.second);
+    };
+    inline void prepareQuery()
+    {
+    };
+    template <class S> inline void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        this->lidx->execute_pureTimeTravel(Q, sink);
+    };
+    template <class S> inline void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        if (Q.start > this->rgend)
+            return;
+
+        bg::model::box<Point> qwindow(Point(this->rgstart, Q.start), Point(Q.end, this->rgend));
+        for (auto it = this->rtree.qbegin(bgi::intersects(qwindow)); it != this->rtree.qend(); ++it)
+            sink.add(it->second);
+    };
+    inline size_t getNumBuffers()
+    {
+        return this->lidx->getNumBuffers();
+    };
+};
+
+
+// Same, with the secondary attribute as the third dimension, i.e., the box [gstart, Q.start] x [Q.end, gend] x [third, fourth]
+class RTree3DReplay
+{
+public:
+    typedef bg::model::point<RTREE_ATYPE, 3, bg::cs::cartesian> Point;
+
+    LiveIndex *lidx;
+    bgi::rtree<pair<Point, RecordId>, bgi::linear<RTREE_PAGESIZE> > rtree;
+    Timestamp rgstart, rgend;
+
+    RTree3DReplay(LiveIndex *lidx)
+    {
+        this->lidx = lidx;
+        this->rgstart = numeric_limits<Timestamp>::max();
+        this->rgend   = numeric_limits<Timestamp>::min();
+    };
+    inline void insertStart(const StreamEntry &e)
+    {
+        this->lidx->insert_secAttr(e.first, e.second, e.third);
+    };
+    inline Timestamp removeStart(const StreamEntry &e)
+    {
+        return this->lidx->remove_secAttr(e.first);
+    };
+    inline void insertEnd(const StreamEntry &e, Timestamp start)
+    {
+        this->rtree.insert(make_pair(Point(start, e.second, e.third), e.first));
+        this->rgstart = min(this->rgstart, start);
+        this->rgend   = max(this->rgend, e.second);
+    };
+    inline void prepareQuery()
+    {
+    };
+    template <class S> inline void queryBuffer(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        this->lidx->execute_rangeTimeTravel(Q, e.third, e.fourth, sink);
+    };
+    template <class S> inline void queryIndex(RangeQuery Q, const StreamEntry &e, S &sink)
+    {
+        if (Q.start > this->rgend)
+            return;
+
+        bg::model::box<Point> qbox(Point(this->rgstart, Q.start, e.third), Point(Q.end, this->rgend, e.fourth));
+        for (auto it = this->rtree.qbegin(bgi::intersects(qbox)); it != this->rtree.qend(); ++it)
+            sink.add(it->second);
+    };
+    inline size_t getNumBuffers()
+    {
+        return this->lidx->getNumBuffers();
+    };
+};
+#endif // _REPLAY_METHODS_H_
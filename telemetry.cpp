@@ -0,0 +1,301 @@
+#include "telemetry.h"
+
+
+
+MemoryTelemetry::MemoryTelemetry(unsigned int samplingInterval)
+{
+    this->samplingInterval = max(samplingInterval, 1u);
+    this->running    = false;
+    this->numSamples = 0;
+    this->vmPeak     = 0;
+    this->rssPeak    = 0;
+}
+
+
+void MemoryTelemetry::run()
+{
+    unique_lock<mutex> guard(this->lock);
+
+    while (this->running)
+    {
+        guard.unlock();
+        this->sample();
+        guard.lock();
+        this->wakeup.wait_for(guard, chrono::milliseconds(this->samplingInterval), [this] { return !this->running; });
+    }
+}
+
+
+void MemoryTelemetry::start()
+{
+    if (this->running)
+        return;
+
+    this->running = true;
+    this->sampler = thread(&MemoryTelemetry::run, this);
+}
+
+
+// Reads /proc/self/stat once; called from the sampler thread, and by stop() to capture the final state.
+void MemoryTelemetry::sample()
+{
+    double vm = 0, rss = 0;
+
+    process_mem_usage(vm, rss);
+
+    lock_guard<mutex> guard(this->lock);
+    this->vmPeak  = max(vm, this->vmPeak);
+    this->rssPeak = max(rss, this->rssPeak);
+    this->numSamples++;
+}
+
+
+void MemoryTelemetry::stop()
+{
+    {
+        lock_guard<mutex> guard(this->lock);
+        if (!this->running)
+            return;
+        this->running = false;
+    }
+    this->wakeup.notify_all();
+    this->sampler.join();
+
+    this->sample();
+}
+
+
+// Records the footprint of a structure; repeated calls keep the largest value seen.
+void MemoryTelemetry::account(const string &structure, size_t bytes)
+{
+    lock_guard<mutex> guard(this->lock);
+
+    for (auto &s : this->structures)
+    {
+        if (s.first == structure)
+        {
+            s.second = max(s.second, bytes);
+            return;
+        }
+    }
+    this->structures.emplace_back(structure, bytes);
+}
+
+
+double MemoryTelemetry::getVmPeak()
+{
+    lock_guard<mutex> guard(this->lock);
+    return this->vmPeak;
+}
+
+
+double MemoryTelemetry::getRssPeak()
+{
+    lock_guard<mutex> guard(this->lock);
+    return this->rssPeak;
+}
+
+
+size_t MemoryTelemetry::getNumSamples()
+{
+    lock_guard<mutex> guard(this->lock);
+    return this->numSamples;
+}
+
+
+void MemoryTelemetry::print()
+{
+    lock_guard<mutex> guard(this->lock);
+
+    cout << "Memory report" << endl;
+    cout << "Sampling interval              [ms]: " << this->samplingInterval << endl;
+    cout << "Num of samples                     : " << this->numSamples << endl;
+    printf( "Peak virtual memory            [KB]: %.0f\n", this->vmPeak);
+    printf( "Peak resident set size         [KB]: %.0f\n", this->rssPeak);
+    for (auto &s : this->structures)
+        printf( "%-29s  [MB]: %f\n", s.first.c_str(), s.second/(1024.0*1024.0));
+    cout << endl;
+}
+
+
+MemoryTelemetry::~MemoryTelemetry()
+{
+    this->stop();
+}
+
+
+
+LatencyHistogram::LatencyHistogram()
+{
+    this->counts.resize(LATENCY_NUM_BUCKETS, 0);
+    this->reset();
+}
+
+
+// Values below 2^LATENCY_SUBBUCKET_BITS get a bucket each; larger ones keep their top LATENCY_SUBBUCKET_BITS+1 bits.
+inline size_t LatencyHistogram::getBucket(uint64_t value)
+{
+    if (value < LATENCY_NUM_SUBBUCKETS)
+        return value;
+
+    int shift = (63-__builtin_clzll(value)) - LATENCY_SUBBUCKET_BITS;
+
+    return (shift+1)*LATENCY_NUM_SUBBUCKETS + ((value >> shift) - LATENCY_NUM_SUBBUCKETS);
+}
+
+
+uint64_t LatencyHistogram::getBucketHighestValue(size_t bucket)
+{
+    if (bucket < LATENCY_NUM_SUBBUCKETS)
+        return bucket;
+
+    int shift = bucket/LATENCY_NUM_SUBBUCKETS - 1;
+    uint64_t top = bucket%LATENCY_NUM_SUBBUCKETS + LATENCY_NUM_SUBBUCKETS;
+
+    return ((top+1) << shift) - 1;
+}
+
+
+void LatencyHistogram::record(double secs)
+{
+    uint64_t value = (secs > 0)? (uint64_t)(secs*1e9): 0;
+
+    this->counts[getBucket(value)]++;
+    this->numValues++;
+    this->sumValues += value;
+    if (value < this->minValue)
+        this->minValue = value;
+    if (value > this->maxValue)
+        this->maxValue = value;
+}
+
+
+void LatencyHistogram::reset()
+{
+    fill(this->counts.begin(), this->counts.end(), 0);
+    this->numValues = 0;
+    this->sumValues = 0;
+    this->minValue  = numeric_limits<uint64_t>::max();
+    this->maxValue  = 0;
+}
+
+
+uint64_t LatencyHistogram::getCount()
+{
+    return this->numValues;
+}
+
+
+double LatencyHistogram::getMin()
+{
+    return (this->numValues > 0)? this->minValue/1e9: 0;
+}
+
+
+double LatencyHistogram::getMax()
+{
+    return this->maxValue/1e9;
+}
+
+
+double LatencyHistogram::getMean()
+{
+    return (this->numValues > 0)? this->sumValues/this->numValues/1e9: 0;
+}
+
+
+// Returns the highest value equivalent to the p-th percentile (0 < p <= 100), in seconds.
+double LatencyHistogram::getPercentile(double p)
+{
+    uint64_t rank, seen = 0;
+
+    if (this->numValues == 0)
+        return 0;
+
+    rank = max((uint64_t)ceil(p/100*this->numValues), (uint64_t)1);
+    for (size_t b = 0; b < LATENCY_NUM_BUCKETS; b++)
+    {
+        seen += this->counts[b];
+        if (seen >= rank)
+            return min(getBucketHighestValue(b), this->maxValue)/1e9;
+    }
+
+    return this->maxValue/1e9;
+}
+
+
+
+LatencyTelemetry::LatencyTelemetry()
+{
+}
+
+
+LatencyHistogram* LatencyTelemetry::add(const string &operation)
+{
+    LatencyHistogram *h = new LatencyHistogram();
+
+    this->histograms.emplace_back(operation, h);
+
+    return h;
+}
+
+
+void LatencyTelemetry::print()
+{
+    cout << "Latency report                 [us]:      count        p50        p90        p99       p999        max" << endl;
+    for (auto &h : this->histograms)
+    {
+        if (h.second->getCount() == 0)
+            continue;
+        printf( "%-35s: %10llu %10.2f %10.2f %10.2f %10.2f %10.2f\n", h.first.c_str(), (unsigned long long)h.second->getCount(), h.second->getPercentile(50)*1e6, h.second->getPercentile(90)*1e6, h.second->getPercentile(99)*1e6, h.second->getPercentile(99.9)*1e6, h.second->getMax()*1e6);
+    }
+    cout << endl;
+}
+
+
+bool LatencyTelemetry::dumpCSV(ofstream &fOut)
+{
+    fOut << "operation,count,min_us,mean_us,p50_us,p90_us,p99_us,p999_us,max_us" << endl;
+    for (auto &h : this->histograms)
+        fOut << h.first << "," << h.second->getCount() << "," << h.second->getMin()*1e6 << "," << h.second->getMean()*1e6 << "," << h.second->getPercentile(50)*1e6 << "," << h.second->getPercentile(90)*1e6 << "," << h.second->getPercentile(99)*1e6 << "," << h.second->getPercentile(99.9)*1e6 << "," << h.second->getMax()*1e6 << endl;
+
+    return (bool)fOut;
+}
+
+
+bool LatencyTelemetry::dumpJSON(ofstream &fOut)
+{
+    fOut << "{" << endl;
+    for (size_t i = 0; i < this->histograms.size(); i++)
+    {
+        auto &h = this->histograms[i];
+
+        fOut << "  \"" << h.first << "\": {\"count\": " << h.second->getCount() << ", \"min_us\": " << h.second->getMin()*1e6 << ", \"mean_us\": " << h.second->getMean()*1e6 << ", \"p50_us\": " << h.second->getPercentile(50)*1e6 << ", \"p90_us\": " << h.second->getPercentile(90)*1e6 << ", \"p99_us\": " << h.second->getPercentile(99)*1e6 << ", \"p999_us\": " << h.second->getPercentile(99.9)*1e6 << ", \"max_us\": " << h.second->getMax()*1e6 << "}" << ((i+1 < this->histograms.size())? ",": "") << endl;
+    }
+    fOut << "}" << endl;
+
+    return (bool)fOut;
+}
+
+
+// Writes the percentiles of all operations; JSON if the filename ends with ".json", CSV otherwise.
+bool LatencyTelemetry::dump(const char *filename)
+{
+    string name(filename);
+    ofstream fOut(filename);
+
+    if (!fOut)
+        return false;
+
+    if ((name.size() >= 5) && (name.compare(name.size()-5, 5, ".json") == 0))
+        return this->dumpJSON(fOut);
+    else
+        return this->dumpCSV(fOut);
+}
+
+
+LatencyTelemetry::~LatencyTelemetry()
+{
+    for (auto &h : this->histograms)
+        delete h.second;
+}
@@ -0,0 +1,92 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "def_global.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#define MEMORY_SAMPLING_INTERVAL 10     // in milliseconds
+
+// Latency histograms: values are bucketed by their most significant bit, and each power of two is split
+// into 2^LATENCY_SUBBUCKET_BITS linear sub-buckets, i.e., a relative error below 2^-LATENCY_SUBBUCKET_BITS
+#define LATENCY_SUBBUCKET_BITS 5
+#define LATENCY_NUM_SUBBUCKETS (1 << LATENCY_SUBBUCKET_BITS)
+#define LATENCY_NUM_BUCKETS    ((64-LATENCY_SUBBUCKET_BITS+1)*LATENCY_NUM_SUBBUCKETS)
+
+
+
+// Tracks the peak memory of the process from a background sampler thread, off the measured update/query path,
+// and collects the bytes reported by the individual structures.
+class MemoryTelemetry
+{
+private:
+    unsigned int samplingInterval;
+    thread sampler;
+    mutex lock;
+    condition_variable wakeup;
+    bool running;
+    size_t numSamples;
+    double vmPeak, rssPeak;
+    vector<pair<string, size_t> > structures;
+
+    void run();
+
+public:
+    MemoryTelemetry(unsigned int samplingInterval);
+    void start();
+    void sample();
+    void stop();
+    void account(const string &structure, size_t bytes);
+    double getVmPeak();
+    double getRssPeak();
+    size_t getNumSamples();
+    void print();
+    ~MemoryTelemetry();
+};
+
+
+
+// Log-bucketed (HDR-style) histogram of operation latencies in nanoseconds; recording is a couple of shifts and an increment.
+class LatencyHistogram
+{
+private:
+    vector<uint64_t> counts;
+    uint64_t numValues;
+    uint64_t minValue, maxValue;
+    double sumValues;
+
+    static size_t getBucket(uint64_t value);
+    static uint64_t getBucketHighestValue(size_t bucket);
+
+public:
+    LatencyHistogram();
+    void record(double secs);
+    void reset();
+    uint64_t getCount();
+    double getMin();
+    double getMax();
+    double getMean();
+    double getPercentile(double p);
+};
+
+
+
+// Named histograms, one per operation type of a driver (e.g., S, E, Q on the buffer and the index); reported as percentiles.
+class LatencyTelemetry
+{
+private:
+    vector<pair<string, LatencyHistogram*> > histograms;
+
+    bool dumpCSV(ofstream &fOut);
+    bool dumpJSON(ofstream &fOut);
+
+public:
+    LatencyTelemetry();
+    LatencyHistogram* add(const string &operation);
+    void print();
+    bool dump(const char *filename);
+    ~LatencyTelemetry();
+};
+#endif // _TELEMETRY_H_
@@ -107,6 +107,37 @@ bool checkAttributeConstraint(string strSecondAttributeConstraint, RunSettings &
     return false;
 }
 
+bool checkWorkload(string strWorkload, RunSettings &settings)
+{
+    if (strWorkload == "COUNT")
+    {
+        settings.typeWorkload = WORKLOAD_MODE_COUNT;
+        return true;
+    }
+    else if (strWorkload == "XOR")
+    {
+        settings.typeWorkload = WORKLOAD_MODE_XOR;
+        return true;
+    }
+    else if (strWorkload == "IDS")
+    {
+        settings.typeWorkload = WORKLOAD_MODE_IDS;
+        return true;
+    }
+
+    return false;
+}
+
+string getWorkloadName(unsigned int typeWorkload)
+{
+    if (typeWorkload == WORKLOAD_MODE_COUNT)
+        return "COUNT";
+    else if (typeWorkload == WORKLOAD_MODE_XOR)
+        return "XOR";
+    else
+        return "IDS";
+}
+
 bool checkOptimizations(string strOptimizations, RunSettings &settings)
 {
     if (strOptimizations == "")